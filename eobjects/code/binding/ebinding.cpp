@@ -18,6 +18,14 @@
 */
 #include "eobjects/eobjects.h"
 
+/* Binding property names.
+ */
+os_char
+    ebindp_window[] = "window",
+    ebindp_rtt[] = "rtt",
+    ebindp_inflight[] = "inflight",
+    ebindp_suppressed[] = "suppressed";
+
 
 /**
 ****************************************************************************************************
@@ -42,6 +50,8 @@ eBinding::eBinding(
     m_ackcount = 0;
     m_objpathsz = m_bindpathsz = 0;
     m_objpath = m_bindpath = OS_NULL;
+    m_suppressed = 0;
+    initwindow();
 }
 
 
@@ -218,6 +228,86 @@ failed:
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Add flow control monitoring properties to property set.
+
+  The eBinding::addflowproperties function adds flow control window, round trip time, number
+  of forwards waiting for acknowledge and suppressed changes counter to property set of
+  a binding class. These are read only. Process mutex must be locked when calling this 
+  function.
+
+  @param   cls Class identifier.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eBinding::addflowproperties(
+    os_int cls)
+{
+    eVariable *p;
+
+    p = addpropertyl(cls, EBINDP_WINDOW, ebindp_window,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "window", EBIND_MAX_ACK_COUNT);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+    p = addpropertyd(cls, EBINDP_RTT, ebindp_rtt,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "round trip time", 0.0, 3);
+    p->setpropertys(EVARP_UNIT, "ms");
+    p->setpropertys(EVARP_ATTR, "rdonly");
+    p = addpropertyl(cls, EBINDP_INFLIGHT, ebindp_inflight,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "in flight", 0);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+    p = addpropertyl(cls, EBINDP_SUPPRESSED, ebindp_suppressed,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "suppressed changes", 0);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value of simple property (override).
+
+  The simpleproperty() function stores current value of flow control monitoring property 
+  into variable x.
+
+  @param   propertynr Property number to get.
+  @param   x Variable into which to store the property value.
+  @return  If property with property number was stored in x, the function returns 
+           ESTATUS_SUCCESS (0). Nonzero return value indicates that the property was not stored.
+
+****************************************************************************************************
+*/
+eStatus eBinding::simpleproperty(
+    os_int propertynr, 
+    eVariable *x)
+{
+    switch (propertynr)
+    {
+        case EBINDP_WINDOW:
+            x->setl(m_window);
+            break;
+
+        case EBINDP_RTT:
+            x->setd(0.001 * m_rtt);
+            break;
+
+        case EBINDP_INFLIGHT:
+            x->setl(m_ackcount);
+            break;
+
+        case EBINDP_SUPPRESSED:
+            x->setl(m_suppressed);
+            break;
+
+        default:
+            return eObject::simpleproperty(propertynr, x);
+    }
+    return ESTATUS_SUCCESS;
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -286,6 +376,7 @@ void eBinding::srvbind_base(
     /* Set binding state ok. 
      */
     m_state = E_BINDING_OK;
+    initwindow();
 }
 
 
@@ -319,6 +410,7 @@ void eBinding::cbindok_base(
     /* Set binding state ok. 
      */
     m_state = E_BINDING_OK;
+    initwindow();
 
     /* If server is master, then do not send changes before this moment.
      */
@@ -373,11 +465,117 @@ void eBinding::sendack_base(
 void eBinding::ack_base(
     eEnvelope *envelope)
 {
+    os_timer now;
+    os_boolean limited;
+
+    /* If a change is waiting for space in window, window limits throughput.
+     */
+    limited = (os_boolean)((m_bflags & EBIND_CHANGED) && m_ackcount >= m_window);
     m_ackcount--;
+
+    /* Acknowledges arrive in order. If this acknowledges the timed forward, adjust window.
+     */
+    if (m_rtt_wait && --m_rtt_wait == 0)
+    {
+        os_get_timer(&now);
+        adjustwindow((os_int)(now - m_rtt_timer), limited);
+    }
+
     forward();
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Mark property value has not been changed after forwarding it.
+
+  The forwarddone function clears changed bit and increments number of forwards waiting for
+  acknowledge. If no forward is being timed, this one is: The round trip time is measured 
+  when m_ackcount acknowledges have arrived.
+  
+  @return None.
+
+****************************************************************************************************
+*/
+void eBinding::forwarddone()
+{
+    m_bflags &= ~EBIND_CHANGED;
+    m_ackcount++;
+
+    if (m_rtt_wait == 0 && (m_bflags & EBIND_INTERTHREAD))
+    {
+        os_get_timer(&m_rtt_timer);
+        m_rtt_wait = m_ackcount;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set initial flow control window.
+
+  The initwindow function sets flow control window to EBIND_MAX_ACK_COUNT, or to 1 if
+  EBIND_CONFLATE flag is set, and clears round trip measurement. Called when binding is 
+  established.
+  
+  @return None.
+
+****************************************************************************************************
+*/
+void eBinding::initwindow()
+{
+    m_window = (m_bflags & EBIND_CONFLATE) ? 1 : EBIND_MAX_ACK_COUNT;
+    m_ssthresh = EBIND_MAX_WINDOW;
+    m_rtt_wait = 0;
+    m_rtt = m_rtt_min = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Adjust flow control window.
+
+  The adjustwindow function updates smoothed and minimum round trip time with new sample.
+  If the round trip time is well above minimum, messages are queuing and window is halved.
+  Otherwise, if window was limiting forwarding, window is grown: Doubled below slow start
+  threshold and incremented by one above it. With EBIND_CONFLATE window stays at 1.
+  
+  @param  rtt Measured round trip time in microseconds.
+  @param  limited OS_TRUE if a change was waiting for space in window.
+  @return None.
+
+****************************************************************************************************
+*/
+void eBinding::adjustwindow(
+    os_int rtt,
+    os_boolean limited)
+{
+    if (rtt < 0) rtt = 0;
+    if (m_rtt == 0) m_rtt = rtt;
+    else m_rtt += (rtt - m_rtt) / 8;
+    if (m_rtt_min == 0 || rtt < m_rtt_min) m_rtt_min = rtt;
+
+    if (m_bflags & EBIND_CONFLATE) return;
+
+    if (rtt > 2 * m_rtt_min + EBIND_RTT_SLACK_US)
+    {
+        m_ssthresh = m_window / 2;
+        if (m_ssthresh < 2) m_ssthresh = 2;
+        m_window = m_window / 2;
+        if (m_window < 1) m_window = 1;
+    }
+    else if (limited)
+    {
+        if (m_window < m_ssthresh) m_window *= 2;
+        else m_window++;
+        if (m_window > EBIND_MAX_WINDOW) m_window = EBIND_MAX_WINDOW;
+    }
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -491,4 +689,5 @@ void eBinding::disconnect(
     m_state = E_BINDING_UNUSED;
     m_bflags &= ~(EBIND_CHANGED|EBIND_INTERTHREAD);
     m_ackcount = 0;
+    m_rtt_wait = 0;
 }
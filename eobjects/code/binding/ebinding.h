@@ -26,13 +26,19 @@
 #define EBIND_CLIENTINIT 8
 #define EBIND_NOFLOWCLT 16
 #define EBIND_METADATA 32
+#define EBIND_DEADBAND_REL 64
+#define EBIND_CONFLATE 128
 #define EBIND_TEMPORARY 256
+#define EBIND_SENT_TIME 512     /* do not give as argument */
 #define EBIND_CLIENT 1024       /* do not give as argument */
 #define EBIND_CHANGED 2048      /* do not give as argument */
 #define EBIND_INTERTHREAD 4096  /* do not give as argument */
+#define EBIND_TIMER_SET 8192    /* do not give as argument */
+#define EBIND_SENT_NUMBER 16384 /* do not give as argument */
 
 #define EBIND_TYPE_MASK 7
-#define EBIND_SER_MASK (EBIND_TYPE_MASK|EBIND_CLIENTINIT|EBIND_NOFLOWCLT|EBIND_METADATA|EBIND_ATTR)
+#define EBIND_SER_MASK (EBIND_TYPE_MASK|EBIND_CLIENTINIT|EBIND_NOFLOWCLT|EBIND_METADATA|EBIND_ATTR \
+    |EBIND_DEADBAND_REL|EBIND_CONFLATE)
 
 /* Binding states.
  */
@@ -46,10 +52,32 @@
 #define E_BINDPRM_PROPERTYNAME 2
 #define E_BINDPRM_VALUE 3
 #define E_BINDPRM_ATTRLIST 4
+#define E_BINDPRM_MIN_INTERVAL 5
+#define E_BINDPRM_DEADBAND 6
 
-/* Maximum number of forwards befoew waiting for acknowledge.
+/* Flow control window: Number of forwards before waiting for acknowledge. The window starts
+   from EBIND_MAX_ACK_COUNT and is adjusted by measured acknowledge round trip time between 
+   1 and EBIND_MAX_WINDOW. Round trip time above twice the minimum plus EBIND_RTT_SLACK_US 
+   microseconds is taken as sign of queuing and the window is halved.
  */
 #define EBIND_MAX_ACK_COUNT 3
+#define EBIND_MAX_WINDOW 64
+#define EBIND_RTT_SLACK_US 2000
+
+/* Enumeration of binding properties (flow control monitoring).
+ */
+#define EBINDP_WINDOW 2
+#define EBINDP_RTT 4
+#define EBINDP_INFLIGHT 6
+#define EBINDP_SUPPRESSED 8
+
+/* Binding property names.
+ */
+extern os_char
+    ebindp_window[],
+    ebindp_rtt[],
+    ebindp_inflight[],
+    ebindp_suppressed[];
 
 
 /**
@@ -132,6 +160,17 @@ public:
         eStream *stream, 
         os_int flags);
 
+    /* Add flow control monitoring properties to property set of binding class.
+     */
+    static void addflowproperties(
+        os_int cls);
+
+    /* Get value of simple property.
+     */
+    virtual eStatus simpleproperty(
+        os_int propertynr, 
+        eVariable *x);
+
     /*@}*/
 
 
@@ -174,11 +213,7 @@ protected:
 
     /* Mark property value, has not been changed after forwarding it.
      */
-    inline void forwarddone() 
-    {
-        m_bflags &= ~EBIND_CHANGED;
-        m_ackcount++;
-    }
+    void forwarddone();
 
     /* Check if property value should be fowrarded now?
      */
@@ -186,7 +221,7 @@ protected:
     {
         return (m_bflags & EBIND_CHANGED) && 
                 m_state == E_BINDING_OK &&
-                (m_ackcount < EBIND_MAX_ACK_COUNT || 
+                (m_ackcount < m_window || 
                  (m_bflags & EBIND_NOFLOWCLT) || 
                  (m_bflags & EBIND_INTERTHREAD) == 0);
     }
@@ -207,6 +242,16 @@ protected:
     void ack_base(
         eEnvelope *envelope);
 
+    /* Set initial flow control window.
+     */
+    void initwindow();
+
+    /* Adjust flow control window by round trip time.
+     */
+    void adjustwindow(
+        os_int rtt,
+        os_boolean limited);
+
     /* Save object path.
      */
     void set_objpath(
@@ -265,6 +310,30 @@ protected:
      */
     os_char m_state;
 
+    /** Flow control window, maximum number of unacknowledged forwards, and slow start
+        threshold: Below it the window doubles per round trip, above it grows by one.
+     */
+    os_char m_window;
+    os_char m_ssthresh;
+
+    /** Number of acknowledges to wait until the timed forward is acknowledged, 0 if no
+        forward is being timed.
+     */
+    os_char m_rtt_wait;
+
+    /** Smoothed and minimum acknowledge round trip time in microseconds, 0 if not measured.
+     */
+    os_int m_rtt;
+    os_int m_rtt_min;
+
+    /** Time when timed forward was sent.
+     */
+    os_timer m_rtt_timer;
+
+    /** Number of changes merged into a later value or dropped by deadband.
+     */
+    os_int m_suppressed;
+
     /*@}*/
 };
 
@@ -0,0 +1,227 @@
+/**
+
+  @file    ebindingmux.cpp
+  @brief   Multiplexing property binding updates.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    12.1.2016
+
+  Values forwarded by inter thread property bindings are collected per peer and sent as one
+  envelope per peer when thread has processed it's queued messages. See ebindingmux.h.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used, 
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept 
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Constructor.
+
+  Mark the multiplexer empty.
+
+  @param   thread Thread owning the multiplexer.
+  @return  None.
+
+****************************************************************************************************
+*/
+eBindingMux::eBindingMux(
+    eThread *thread)
+{
+    m_thread = thread;
+    m_nro_groups = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Destructor.
+
+  Release values which have not been sent.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+eBindingMux::~eBindingMux()
+{
+    eBindingMuxGroup
+        *g;
+
+    os_int
+        i;
+
+    for (i = 0; i < m_nro_groups; i++)
+    {
+        g = m_group + i;
+        delete g->content;
+        os_free(g->path, g->pathsz);
+    }
+    m_nro_groups = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add forwarded value.
+
+  The eBindingMux::add() function adds value forwarded by a binding to group of the peer.
+  Bind path must end with object index of the peer binding, "@12_3". Path before it (route
+  trough connections, empty within process) and peer thread select the group.
+
+  @param   binding Binding forwarding the value.
+  @param   bindpath Path to peer binding.
+  @param   x Value to forward.
+  @param   delete_x If OS_TRUE, x is adopted. Otherwise x is copied.
+  @return  OS_TRUE if value was added. OS_FALSE if binding needs to send it by itself, 
+           x is not modified in this case.
+
+****************************************************************************************************
+*/
+os_boolean eBindingMux::add(
+    eObject *binding,
+    const os_char *bindpath,
+    eVariable *x,
+    os_boolean delete_x)
+{
+    eBindingMuxGroup
+        *g;
+
+    eVariable
+        *v;
+
+    eHandle
+        *handle;
+
+    eRoot
+        *peer;
+
+    const os_char
+        *p,
+        *q;
+
+    os_char
+        buf[E_OIXSTR_BUF_SZ];
+
+    e_oix
+        oix;
+
+    os_int
+        ucnt,
+        prefixsz,
+        i,
+        j;
+
+    /* Find object index of peer binding at end of path.
+     */
+    q = OS_NULL;
+    for (p = bindpath; *p != '\0'; p++)
+    {
+        if (*p == '@' && (p == bindpath || p[-1] == '/')) q = p;
+        else if (*p == '/') q = OS_NULL;
+    }
+    if (q == OS_NULL) return OS_FALSE;
+    prefixsz = (os_int)(q - bindpath);
+
+    /* Within process, group by peer thread.
+     */
+    peer = OS_NULL;
+    if (prefixsz == 0)
+    {
+        os_strncpy(buf, q, sizeof(buf));
+        if (binding->oixparse(buf, &oix, &ucnt) == 0) return OS_FALSE;
+        handle = eget_handle_check(oix);
+        if (handle == OS_NULL) return OS_FALSE;
+        peer = handle->root();
+    }
+
+    /* Find group, or start new one.
+     */
+    g = OS_NULL;
+    for (i = 0; i < m_nro_groups; i++)
+    {
+        if (m_group[i].prefixsz != prefixsz || m_group[i].peer != peer) continue;
+        for (j = 0; j < prefixsz; j++)
+        {
+            if (m_group[i].path[j] != bindpath[j]) break;
+        }
+        if (j == prefixsz)
+        {
+            g = m_group + i;
+            break;
+        }
+    }
+
+    if (g == OS_NULL)
+    {
+        if (m_nro_groups >= EBINDINGMUX_MAX_GROUPS) return OS_FALSE;
+        g = m_group + m_nro_groups++;
+        g->pathsz = os_strlen(bindpath);
+        g->path = os_malloc(g->pathsz, OS_NULL);
+        os_memcpy(g->path, bindpath, g->pathsz);
+        g->prefixsz = prefixsz;
+        g->peer = peer;
+        g->content = new eContainer(m_thread, EOID_ITEM, 
+            EOBJ_IS_ATTACHMENT|EOBJ_NOT_CLONABLE|EOBJ_NOT_SERIALIZABLE);
+    }
+
+    /* Append target oix, source oix and value.
+     */
+    v = new eVariable(g->content);
+    v->sets(q);
+    binding->oixstr(buf, sizeof(buf));
+    v = new eVariable(g->content);
+    v->sets(buf);
+    if (delete_x)
+    {
+        g->content->adopt(x, EOID_ITEM, EOBJ_NO_MAP);
+    }
+    else
+    {
+        x->clone(g->content, EOID_ITEM, EOBJ_NO_MAP);
+    }
+
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Send collected values.
+
+  The eBindingMux::flush() function sends one ECMD_FWRD_MUX envelope per peer. The envelope
+  is addressed to the first binding of the group, which distributes values to others. Source
+  path is path to this thread, so acknowledge comes back to thread. Values are sent as 
+  context, so if the first binding is gone, ECMD_NO_TARGET reply brings them back to the 
+  thread and these are resent one by one, see ePropertyBinding::resend_mux().
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eBindingMux::flush()
+{
+    eBindingMuxGroup
+        *g;
+
+    os_int
+        i;
+
+    for (i = 0; i < m_nro_groups; i++)
+    {
+        g = m_group + i;
+        m_thread->message(ECMD_FWRD_MUX, g->path, OS_NULL, OS_NULL, EMSG_DEL_CONTEXT, 
+            g->content);
+        os_free(g->path, g->pathsz);
+    }
+    m_nro_groups = 0;
+}
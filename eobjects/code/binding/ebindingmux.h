@@ -0,0 +1,114 @@
+/**
+
+  @file    ebindingmux.h
+  @brief   Multiplexing property binding updates.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    12.1.2016
+
+  The eBindingMux collects values forwarded by inter thread property bindings of one thread 
+  during a round of message processing, and sends values going to the same peer as one 
+  ECMD_FWRD_MUX envelope when the thread has processed it's queued messages. The receiving
+  end sets values of all bindings within it's thread and replies with one ECMD_ACK_MUX.
+  Flow control, minimum interval and deadband are still decided by each binding, only 
+  transport is shared.
+
+  Context of ECMD_FWRD_MUX envelope is eContainer holding three eVariables per value: Target
+  binding oix string (like "@12_3"), source binding oix string and the value. Context is 
+  used, so that values come back with ECMD_NO_TARGET reply if the binding the envelope is 
+  addressed to is gone, and the thread can resend them one by one. Content of ECMD_ACK_MUX 
+  is eContainer holding source binding oix strings.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used, 
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept 
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EBINDINGMUX_INCLUDED
+#define EBINDINGMUX_INCLUDED
+
+class eThread;
+
+/** Maximum number of peers per round. Values to further peers are sent by binding itself.
+ */
+#define EBINDINGMUX_MAX_GROUPS 16
+
+/** Values going to one peer.
+ */
+typedef struct eBindingMuxGroup
+{
+    /** Path to first binding in group, the ECMD_FWRD_MUX envelope is sent to it. Allocated 
+        size in bytes.
+     */
+    os_char *path;
+    os_memsz pathsz;
+
+    /** Length of path prefix before "@oix" of the binding. Same for all bindings in group.
+     */
+    os_int prefixsz;
+
+    /** Root of peer bindings' thread when prefix is empty (same process), OS_NULL otherwise.
+        This is only a hint for grouping, the receiver checks each binding.
+     */
+    eRoot *peer;
+
+    /** Triplets of target oix, source oix and value.
+     */
+    eContainer *content;
+}
+eBindingMuxGroup;
+
+
+/**
+****************************************************************************************************
+
+  @brief Binding multiplexer class.
+
+  One eBindingMux is created for an eThread when one of it's property bindings forwards a
+  value to another thread. Used only by the thread owning it.
+
+****************************************************************************************************
+*/
+class eBindingMux
+{
+public:
+    /* Constructor.
+	 */
+	eBindingMux(
+		eThread *thread);
+
+	/* Destructor, releases values not sent.
+ 	 */
+	~eBindingMux();
+
+    /* Add forwarded value.
+     */
+    os_boolean add(
+        eObject *binding,
+        const os_char *bindpath,
+        eVariable *x,
+        os_boolean delete_x);
+
+    /* Send collected values.
+     */
+    void flush();
+
+private:
+    /* Disable copy constructor and assignment operator.
+     */
+    eBindingMux(eBindingMux const&);
+    eBindingMux& operator=(eBindingMux const&);
+
+    /* Thread owning the multiplexer.
+     */
+    eThread *m_thread;
+
+    /* Groups by peer.
+     */
+    eBindingMuxGroup m_group[EBINDINGMUX_MAX_GROUPS];
+    os_int m_nro_groups;
+};
+
+#endif
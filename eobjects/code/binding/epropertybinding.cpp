@@ -38,6 +38,8 @@ ePropertyBinding::ePropertyBinding(
      */
     m_propertyname = OS_NULL;
     m_propertynamesz = 0;
+    m_min_interval = 0;
+    m_deadband = m_sentvalue = 0.0;
 }
 
 
@@ -53,6 +55,10 @@ ePropertyBinding::ePropertyBinding(
 */
 ePropertyBinding::~ePropertyBinding()
 {
+    if (m_bflags & EBIND_TIMER_SET)
+    {
+        timer(0);
+    }
     set_propertyname(OS_NULL);
 }
 
@@ -111,10 +117,12 @@ void ePropertyBinding::setupclass()
 {
     const os_int cls = ECLASSID_PROPERTY_BINDING;
 
-    /* Add the class to class list.
+    /* Add the class to class list and flow control properties to property set.
      */
     os_lock();
     eclasslist_add(cls, (eNewObjFunc)newobj, "ePropertyBinding");
+    addflowproperties(cls);
+    propertysetdone(cls);
     os_unlock();
 }
 
@@ -276,6 +284,10 @@ void ePropertyBinding::onmessage(
             case ECMD_FWRD:
                 update(envelope);
                 return;
+
+            case ECMD_FWRD_MUX:
+                update_mux(envelope);
+                return;
     
             case ECMD_ACK:
                 ack(envelope);
@@ -284,6 +296,11 @@ void ePropertyBinding::onmessage(
             case ECMD_REBIND:
                 bind2(OS_NULL);
                 return;
+
+            case ECMD_TIMER:
+                forward();
+                if ((m_bflags & EBIND_CHANGED) == 0) settimer(OS_FALSE);
+                return;
         }
     }
 
@@ -319,6 +336,16 @@ void ePropertyBinding::onmessage(
           - EBIND_METADATA: If meta data, like text, unit, attributes, etc exists, it is 
             also transferred from remote object to local object.
           - EBIND_ATTR: Bind also attributes (subproperties like "x.min").
+          - EBIND_DEADBAND_REL: Deadband is relative to last value sent, for example 0.01
+            for 1%. Without this flag deadband is absolute.
+          - EBIND_CONFLATE: Last value wins. Only one forwarded value may wait for 
+            acknowledge, changes meanwhile are merged and latest value is sent once
+            acknowledge arrives.
+  @param  min_interval_ms Minimum time between forwarded values in milliseconds, 0 for no
+          limit. Change within the interval is held back and sent when the interval has
+          passed (40 ms timer precision).
+  @param  deadband Numeric value change smaller than deadband is not forwarded. 0.0 to
+          forward every change.
   @return None.
 
 ****************************************************************************************************
@@ -327,13 +354,17 @@ void ePropertyBinding::bind(
     os_int localpropertynr,
     const os_char *remotepath,
     const os_char *remoteproperty,
-    os_int bflags)
+    os_int bflags,
+    os_int min_interval_ms,
+    os_double deadband)
 {
     /* Save bind parameters and flags.
      */
     set_propertyname(remoteproperty);
     m_localpropertynr = localpropertynr;
     m_bflags = bflags | EBIND_CLIENT;
+    m_min_interval = min_interval_ms;
+    m_deadband = deadband;
 
     bind2(remotepath);
 }
@@ -351,6 +382,9 @@ void ePropertyBinding::bind2(
     parameters = new eSet(this);
     parameters->setl(E_BINDPRM_FLAGS, m_bflags & EBIND_SER_MASK);
     parameters->sets(E_BINDPRM_PROPERTYNAME, m_propertyname);
+    if (m_min_interval) parameters->setl(E_BINDPRM_MIN_INTERVAL, m_min_interval);
+    if (m_deadband > 0.0) parameters->setd(E_BINDPRM_DEADBAND, m_deadband);
+    m_bflags &= ~(EBIND_SENT_NUMBER|EBIND_SENT_TIME);
 
     /* If this client is master, get property value.
      */
@@ -435,6 +469,8 @@ void ePropertyBinding::srvbind(
     /* Set flags. Set EBIND_INTERTHREAD if envelope has not been moved from thread to another.
      */
     m_bflags = (os_short)parameters->getl(E_BINDPRM_FLAGS);
+    m_min_interval = (os_int)parameters->getl(E_BINDPRM_MIN_INTERVAL);
+    m_deadband = parameters->getd(E_BINDPRM_DEADBAND);
     if (envelope->mflags() & EMSG_INTERTHREAD)
     {
         m_bflags |= EBIND_INTERTHREAD;
@@ -552,8 +588,10 @@ void ePropertyBinding::changed(
     if (propertynr != m_localpropertynr) return;
 
     /* Mark property value, etc changed. Forward immediately, if binding if flow
-       control does not block it.
+       control does not block it. If previous change has not been forwarded yet, it is
+       merged into this one.
      */
+    if (m_bflags & EBIND_CHANGED) m_suppressed++;
     setchanged();
     forward(x, delete_x);
 }
@@ -564,7 +602,11 @@ void ePropertyBinding::changed(
 
   @brief Forward property value trough binding.
 
-  The forward function sends value of a property if flow control allows. 
+  The forward function sends value of a property if flow control allows. If minimum interval
+  has not passed since last value was sent, the value remains marked changed and timer is 
+  set to send it later. Numeric value within deadband from last value sent is dropped.
+  Value held back by flow control is sent when acknowledge arrives, since ack() calls
+  forward() again.
   
   @param  x Variable containing value, if available.
   @param  delete_x Flag weather value should be deleted.
@@ -576,33 +618,69 @@ void ePropertyBinding::forward(
     eVariable *x,
     os_boolean delete_x)
 {
-    eVariable *tmp;
+    eThread *thread;
 
     if (forwardnow())
     {
+        /* If minimum interval has not passed, send later from timer.
+         */
+        if (m_min_interval && (m_bflags & EBIND_SENT_TIME) &&
+            !os_elapsed(&m_sendtimer, m_min_interval))
+        {
+            settimer(OS_TRUE);
+            goto getout;
+        }
 
         if (x == OS_NULL)
         {
-            tmp = new eVariable;
-            binding_getproperty(tmp);
+            x = new eVariable;
+            binding_getproperty(x);
+            delete_x = OS_TRUE;
+        }
 
-            message(ECMD_FWRD, m_bindpath, OS_NULL, tmp, 
-                EMSG_DEL_CONTENT /* EMSG_NO_ERROR_MSGS */);
+        /* Change within deadband is not forwarded.
+         */
+        if (indeadband(x))
+        {
+            m_bflags &= ~EBIND_CHANGED;
+            m_suppressed++;
+            goto getout;
+        }
+
+        /* Remember numeric value and time sent.
+         */
+        if (x->type() == OS_LONG || x->type() == OS_DOUBLE)
+        {
+            m_sentvalue = x->getd();
+            m_bflags |= EBIND_SENT_NUMBER;
         }
         else
         {
-            /* Send data as ECMD_FWRD message.
-             */
+            m_bflags &= ~EBIND_SENT_NUMBER;
+        }
+        if (m_min_interval) 
+        {
+            os_get_timer(&m_sendtimer);
+            m_bflags |= EBIND_SENT_TIME;
+        }
+
+        /* Send data as ECMD_FWRD message. Between threads let thread's binding 
+           multiplexer send it together with other values to the same peer.
+         */
+        thread = (m_bflags & EBIND_INTERTHREAD) ? eObject::thread() : OS_NULL;
+        if (thread == OS_NULL || !thread->bindingmux()->add(this, m_bindpath, x, delete_x))
+        {
             message(ECMD_FWRD, m_bindpath, OS_NULL, x, 
                 delete_x ? EMSG_DEL_CONTENT : EMSG_DEFAULT  /* EMSG_NO_ERROR_MSGS */);
-            x = OS_NULL;
         }
+        x = OS_NULL;
 
         /* Clear changed bit and increment acknowledge count.
          */
         forwarddone();
     }
 
+getout:
     if (delete_x && x) 
     {
         delete x;
@@ -610,6 +688,71 @@ void ePropertyBinding::forward(
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Check if value is within deadband.
+
+  The indeadband function checks if numeric value differs from last value sent less than
+  deadband. Relative deadband is scaled by last value sent.
+  
+  @param  x Value to check.
+  @return OS_TRUE if value is within deadband and should not be forwarded.
+
+****************************************************************************************************
+*/
+os_boolean ePropertyBinding::indeadband(
+    eVariable *x)
+{
+    os_double d, limit;
+
+    if (m_deadband <= 0.0 || (m_bflags & EBIND_SENT_NUMBER) == 0) return OS_FALSE;
+    if (x->type() != OS_LONG && x->type() != OS_DOUBLE) return OS_FALSE;
+
+    d = x->getd() - m_sentvalue;
+    if (d < 0.0) d = -d;
+
+    limit = m_deadband;
+    if (m_bflags & EBIND_DEADBAND_REL) 
+    {
+        limit *= (m_sentvalue >= 0.0 ? m_sentvalue : -m_sentvalue);
+    }
+
+    return (os_boolean)(d < limit);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Enable or disable timer.
+
+  The settimer function enables timer to send value held back by minimum interval, or
+  disables it when there is nothing to send. Timer is enabled only once.
+  
+  @param  enable OS_TRUE to enable timer, OS_FALSE to disable it.
+  @return None.
+
+****************************************************************************************************
+*/
+void ePropertyBinding::settimer(
+    os_boolean enable)
+{
+    if (enable)
+    {
+        if (m_bflags & EBIND_TIMER_SET) return;
+        timer(m_min_interval);
+        m_bflags |= EBIND_TIMER_SET;
+    }
+    else
+    {
+        if ((m_bflags & EBIND_TIMER_SET) == 0) return;
+        timer(0);
+        m_bflags &= ~EBIND_TIMER_SET;
+    }
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -676,6 +819,181 @@ void ePropertyBinding::ack(
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Multiplexed updates received.
+
+  The update_mux function sets values received in ECMD_FWRD_MUX envelope context to bound 
+  properties.
+  Envelope is addressed to one binding, and values for other bindings within the same thread
+  are set here. Value for binding which is not in this thread is forwarded to it as 
+  ECMD_FWRD message, and that binding acknowledges it by itself. Values for bindings within 
+  this thread are acknowledged with one ECMD_ACK_MUX to the sending thread.
+  
+  @param  envelope Message envelope, see ebindingmux.h for content.
+  @return None.
+
+****************************************************************************************************
+*/
+void ePropertyBinding::update_mux(
+    eEnvelope *envelope)
+{
+    eContainer *content, *acks;
+    eVariable *target, *source, *x, *v;
+    ePropertyBinding *b;
+
+    content = eContainer::cast(envelope->context());
+    if (content == OS_NULL) return;
+    acks = OS_NULL;
+
+    for (target = content->firstv(); target; target = x->nextv())
+    {
+        source = target->nextv();
+        if (source == OS_NULL) break;
+        x = source->nextv();
+        if (x == OS_NULL) break;
+
+        b = findbinding(this, target);
+        if (b == OS_NULL)
+        {
+            message(ECMD_FWRD, target->gets(), OS_NULL, x, EMSG_DEFAULT);
+            continue;
+        }
+
+        b->binding_setproperty(x);
+
+        /* Same as sendack() does for one binding.
+         */
+        if (b->m_bflags & EBIND_INTERTHREAD)
+        {
+            if (acks == OS_NULL) acks = new eContainer(this);
+            v = new eVariable(acks);
+            v->setv(source);
+
+            if ((b->m_bflags & EBIND_CLIENT) == 0 && b->m_ackcount)
+            {
+                b->setchanged();
+            }
+        }
+    }
+
+    if (acks)
+    {
+        message(ECMD_ACK_MUX, envelope->source(), OS_NULL, acks, EMSG_DEL_CONTENT);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Multiplexed acknowledge received.
+
+  The ack_mux function is called by thread which sent ECMD_FWRD_MUX envelope, when it
+  receives ECMD_ACK_MUX. It acknowledges each binding listed.
+  
+  @param  thread Thread receiving the acknowledge.
+  @param  envelope Message envelope, content is list of binding oix strings.
+  @return None.
+
+****************************************************************************************************
+*/
+void ePropertyBinding::ack_mux(
+    eThread *thread,
+    eEnvelope *envelope)
+{
+    eContainer *content;
+    eVariable *v;
+    ePropertyBinding *b;
+
+    content = eContainer::cast(envelope->content());
+    if (content == OS_NULL) return;
+
+    for (v = content->firstv(); v; v = v->nextv())
+    {
+        b = findbinding(thread, v);
+        if (b) b->ack(envelope);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Multiplexed updates were not delivered.
+
+  The resend_mux function is called by thread which sent ECMD_FWRD_MUX envelope, when it
+  receives ECMD_NO_TARGET reply because the binding the envelope was addressed to is gone.
+  The reply returns the values as context. Each value is resent by it's source binding as
+  ECMD_FWRD message, so other bindings in the group get their values and acknowledges, and
+  binding which is gone is replied with ECMD_NO_TARGET by itself.
+  
+  @param  thread Thread receiving the reply.
+  @param  envelope Message envelope, context is content of ECMD_FWRD_MUX, see ebindingmux.h.
+  @return None.
+
+****************************************************************************************************
+*/
+void ePropertyBinding::resend_mux(
+    eThread *thread,
+    eEnvelope *envelope)
+{
+    eContainer *content;
+    eVariable *target, *source, *x;
+    ePropertyBinding *b;
+
+    content = eContainer::cast(envelope->context());
+    if (content == OS_NULL) return;
+
+    for (target = content->firstv(); target; target = x->nextv())
+    {
+        source = target->nextv();
+        if (source == OS_NULL) break;
+        x = source->nextv();
+        if (x == OS_NULL) break;
+
+        b = findbinding(thread, source);
+        if (b == OS_NULL) continue;
+        if (b->m_bindpath) b->message(ECMD_FWRD, b->m_bindpath, OS_NULL, x, EMSG_DEFAULT);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find property binding by oix string.
+
+  The findbinding function finds property binding within the same thread as obj.
+  
+  @param  obj Any object in thread's tree.
+  @param  oixstr Variable holding oix string like "@12_3".
+  @return Pointer to binding, OS_NULL if there is no property binding with the oix and 
+          use count within the thread.
+
+****************************************************************************************************
+*/
+ePropertyBinding *ePropertyBinding::findbinding(
+    eObject *obj,
+    eVariable *oixstr)
+{
+    eHandle *handle;
+    eObject *o;
+    e_oix oix;
+    os_int ucnt;
+
+    if (obj->oixparse(oixstr->gets(), &oix, &ucnt) == 0) return OS_NULL;
+    handle = eget_handle_check(oix);
+    if (handle == OS_NULL) return OS_NULL;
+    if (handle->root() != obj->handle()->root() || handle->ucnt() != ucnt) return OS_NULL;
+
+    o = handle->object();
+    if (o == OS_NULL || o->classid() != ECLASSID_PROPERTY_BINDING) return OS_NULL;
+    return (ePropertyBinding*)o;
+}
+
+
 /**
 ****************************************************************************************************
 
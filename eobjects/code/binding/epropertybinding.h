@@ -127,7 +127,9 @@ public:
         os_int localpropertynr,
         const os_char *remotepath,
         const os_char *remoteproperty,
-        os_int bflags);
+        os_int bflags,
+        os_int min_interval_ms = 0,
+        os_double deadband = 0.0);
 
     void bind2(
         const os_char *remotepath);
@@ -145,6 +147,18 @@ public:
         eVariable *x,
         os_boolean delete_x);
 
+    /* Multiplexed acknowledge received by thread.
+     */
+    static void ack_mux(
+        eThread *thread,
+        eEnvelope *envelope);
+
+    /* Multiplexed updates were not delivered, resend values one by one.
+     */
+    static void resend_mux(
+        eThread *thread,
+        eEnvelope *envelope);
+
 protected:
 
     /* Finish the client end of binding.
@@ -160,11 +174,32 @@ protected:
         os_boolean delete_x = OS_FALSE);
 
 
+    /* Check if value is within deadband from last value sent.
+     */
+    os_boolean indeadband(
+        eVariable *x);
+
+    /* Enable or disable timer for sending value held back by minimum interval.
+     */
+    void settimer(
+        os_boolean enable);
+
     /* Update to property value has been received.
      */
     void update(
         eEnvelope *envelope);
 
+    /* Multiplexed updates have been received.
+     */
+    void update_mux(
+        eEnvelope *envelope);
+
+    /* Find property binding within thread's tree by oix string.
+     */
+    static ePropertyBinding *findbinding(
+        eObject *obj,
+        eVariable *oixstr);
+
     void sendack(
         eEnvelope *envelope);
 
@@ -219,6 +254,23 @@ protected:
      */
     os_int m_localpropertynr;
 
+    /** Minimum interval between forwarded values in milliseconds, 0 if not limited.
+     */
+    os_int m_min_interval;
+
+    /** Deadband: Change smaller than this is not forwarded. Absolute value, or relative
+        to last value sent if EBIND_DEADBAND_REL flag is set. 0.0 if no deadband.
+     */
+    os_double m_deadband;
+
+    /** Last numeric value sent, valid if EBIND_SENT_NUMBER flag is set.
+     */
+    os_double m_sentvalue;
+
+    /** Time when last value was forwarded, valid if EBIND_SENT_TIME flag is set.
+     */
+    os_timer m_sendtimer;
+
     
     /*@}*/
 
@@ -104,7 +104,7 @@ eObject *eBuffer::clone(
 {
     eBuffer *clonedobj;
 
-    clonedobj = new eBuffer(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eBuffer(parent, id == EOID_CHILD ? oid() : id, flags());
 
     clonedobj->allocate(m_allocated);
     if (m_ptr) os_memcpy(clonedobj->m_ptr, m_ptr, m_allocated);
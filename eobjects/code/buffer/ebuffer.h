@@ -87,7 +87,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
 	{
-        return new eBuffer(parent, id, flags);
+        return new (parent) eBuffer(parent, id, flags);
 	}
 
     /* Write set content to stream.
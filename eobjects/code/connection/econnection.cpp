@@ -116,6 +116,7 @@ void eConnection::setupclass()
     p = addpropertyl(cls, ECONNP_ISOPEN, econnp_isopen,
         EPRO_NOONPRCH, "is open", OS_FALSE);
     p->setpropertys(EVARP_ATTR, "rdonly;chkbox");
+    eThread::addqueueproperties(cls);
     os_unlock();
 }
 
@@ -408,7 +409,7 @@ void eConnection::run()
 
                 /* If message queue for incoming messages is empty, flush writes.
                  */
-                if (m_message_queue->first() == OS_NULL && m_new_writes)
+                if (mailbox_empty() && m_new_writes)
                 {
                     if (m_stream->writechar(E_STREAM_FLUSH))
                     {
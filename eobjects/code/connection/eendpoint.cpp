@@ -96,6 +96,7 @@ void eEndPoint::setupclass()
     p = addpropertyl(cls, EENDPP_ISOPEN, eendpp_isopen, 
         EPRO_NOONPRCH, "is open", OS_FALSE);
     p->setpropertys(EVARP_ATTR, "rdonly;chkbox");
+    eThread::addqueueproperties(cls);
     os_unlock();
 }
 
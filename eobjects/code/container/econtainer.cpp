@@ -75,7 +75,7 @@ eObject *eContainer::clone(
     os_int aflags)
 {
     eObject *clonedobj;
-    clonedobj = new eContainer(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eContainer(parent, id == EOID_CHILD ? oid() : id, flags());
     clonegeneric(clonedobj, aflags|EOBJ_CLONE_ALL_CHILDREN);
     return clonedobj;
 }
@@ -66,6 +66,13 @@ public:
         return ECLASSID_CONTAINER;
     }
 
+    /* Container has nothing to release in destructor. Derived classes may.
+     */
+    virtual os_boolean trivialdestructor()
+    {
+        return (os_boolean)(classid() == ECLASSID_CONTAINER);
+    }
+
     /* Static function to add class to propertysets and class list.
      */
     static void setupclass();
@@ -77,7 +84,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eContainer(parent, id, flags);
+        return new (parent) eContainer(parent, id, flags);
     }
 
     /* Get next child container identified by oid.
@@ -0,0 +1,194 @@
+/**
+
+  @file    eatomic.h
+  @brief   Atomic operations for lock free data structures.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Minimal set of atomic operations used by eobjects library to implement lock free message
+  queues, etc. GCC/Clang builtins are used on Linux and interlocked intrinsics on Windows.
+  If operating system has no multithreading support, plain memory access is used.
+  Loads and read-modify-write operations are sequentially consistent, stores are release.
+  On Windows loads and stores are done with interlocked intrinsics, which are full barriers,
+  so ordering is at least as strong as with GCC builtins.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EATOMIC_INCLUDED
+#define EATOMIC_INCLUDED
+
+#if OSAL_MULTITHREAD_SUPPORT
+#if OSAL_WINDOWS
+#include <intrin.h>
+#endif
+#endif
+
+/* Load pointer value.
+ */
+inline void *eatomic_load_ptr(
+    void *volatile *p)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    return *p;
+#elif OSAL_WINDOWS
+    return _InterlockedCompareExchangePointer(p, OS_NULL, OS_NULL);
+#else
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Store pointer value, release ordering.
+ */
+inline void eatomic_store_ptr(
+    void *volatile *p,
+    void *x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    *p = x;
+#elif OSAL_WINDOWS
+    _InterlockedExchangePointer(p, x);
+#else
+    __atomic_store_n(p, x, __ATOMIC_RELEASE);
+#endif
+}
+
+/* Set new pointer value and return old one.
+ */
+inline void *eatomic_exchange_ptr(
+    void *volatile *p,
+    void *x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    void *old = *p;
+    *p = x;
+    return old;
+#elif OSAL_WINDOWS
+    return _InterlockedExchangePointer(p, x);
+#else
+    return __atomic_exchange_n(p, x, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Set pointer to x if it's current value is expected. Returns OS_TRUE if succesfull.
+ */
+inline os_boolean eatomic_cas_ptr(
+    void *volatile *p,
+    void *expected,
+    void *x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    if (*p != expected) return OS_FALSE;
+    *p = x;
+    return OS_TRUE;
+#elif OSAL_WINDOWS
+    return (os_boolean)(_InterlockedCompareExchangePointer(p, x, expected) == expected);
+#else
+    return (os_boolean)__atomic_compare_exchange_n(p, &expected, x, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Load integer value.
+ */
+inline os_int eatomic_load_int(
+    volatile os_int *p)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    return *p;
+#elif OSAL_WINDOWS
+    return _InterlockedCompareExchange((volatile long*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Store integer value, release ordering.
+ */
+inline void eatomic_store_int(
+    volatile os_int *p,
+    os_int x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    *p = x;
+#elif OSAL_WINDOWS
+    _InterlockedExchange((volatile long*)p, x);
+#else
+    __atomic_store_n(p, x, __ATOMIC_RELEASE);
+#endif
+}
+
+/* Add x to integer and return the new value.
+ */
+inline os_int eatomic_add_int(
+    volatile os_int *p,
+    os_int x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    return (*p += x);
+#elif OSAL_WINDOWS
+    return _InterlockedExchangeAdd((volatile long*)p, x) + x;
+#else
+    return __atomic_add_fetch(p, x, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Set integer to x if it's current value is expected. Returns OS_TRUE if succesfull.
+ */
+inline os_boolean eatomic_cas_int(
+    volatile os_int *p,
+    os_int expected,
+    os_int x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    if (*p != expected) return OS_FALSE;
+    *p = x;
+    return OS_TRUE;
+#elif OSAL_WINDOWS
+    return (os_boolean)(_InterlockedCompareExchange((volatile long*)p, x, expected) == expected);
+#else
+    return (os_boolean)__atomic_compare_exchange_n(p, &expected, x, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Load 64 bit integer value.
+ */
+inline os_long eatomic_load_long(
+    volatile os_long *p)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    return *p;
+#elif OSAL_WINDOWS
+    return _InterlockedCompareExchange64((volatile __int64*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Set 64 bit integer to x if it's current value is expected. Returns OS_TRUE if succesfull.
+ */
+inline os_boolean eatomic_cas_long(
+    volatile os_long *p,
+    os_long expected,
+    os_long x)
+{
+#if OSAL_MULTITHREAD_SUPPORT == 0
+    if (*p != expected) return OS_FALSE;
+    *p = x;
+    return OS_TRUE;
+#elif OSAL_WINDOWS
+    return (os_boolean)(_InterlockedCompareExchange64((volatile __int64*)p, x, expected)
+        == expected);
+#else
+    return (os_boolean)__atomic_compare_exchange_n(p, &expected, x, false,
+        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif
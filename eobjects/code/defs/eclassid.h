@@ -57,6 +57,8 @@
 #define ECLASSID_TABLE 33
 #define ECLASSID_WHERE 34
 #define ECLASSID_BINDING 35
+#define ECLASSID_REQUEST 36
+#define ECLASSID_ARENA 37
 
 
 #define ECLASSID_SOCKET 50
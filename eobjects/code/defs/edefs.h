@@ -67,6 +67,27 @@ typedef os_int e_oid;
 #endif
 #endif
 
+/** Allocate memory for objects (eObject new and delete operators) from thread local slab 
+    allocator, see eslab.h. If zero, global new and delete are used, or os_malloc() if 
+    EOVERLOAD_NEW_AND_DELETE is set. Slab memory is not returned to operating system, so
+    the allocator is off by default. Define E_SLAB_ALLOCATOR 1 in build to enable it.
+ */
+#ifndef E_SLAB_ALLOCATOR
+#define E_SLAB_ALLOCATOR 0
+#endif
+
+/** Allocate handle tables from 2MB huge pages (Linux only). Address space for all handle 
+    tables is reserved at once with mmap(), but memory is committed only when a table is
+    allocated. This reduces TLB misses when there are millions of objects. 
+ */
+#ifndef E_HUGEPAGE_HANDLE_TABLES
+#define E_HUGEPAGE_HANDLE_TABLES 0
+#endif
+#if OSAL_LINUX == 0
+#undef E_HUGEPAGE_HANDLE_TABLES
+#define E_HUGEPAGE_HANDLE_TABLES 0
+#endif
+
 /*@}*/
 
 #endif
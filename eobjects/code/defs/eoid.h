@@ -61,6 +61,10 @@
  */
 #define EOID_PPTR_TARGET -12
 
+/** Attachment: Memory arena of object subtree, see eObject::beginarena().
+ */
+#define EOID_ARENA -13
+
 /** Content, used for envelopes, etc.
  */
 #define EOID_CONTENT -30
@@ -69,10 +73,19 @@
  */
 #define EOID_CONTEXT -31
 
+/** Root of detached object tree holding content and context shared by multiple envelopes.
+ */
+#define EOID_SHARED_CONTENT -32
+
 /** Object's stored properties eContainer.
  */
 #define EOID_PROPERTIES -33
 
+/** Root of detached object tree holding content and context of an envelope passed between
+    threads.
+ */
+#define EOID_PAYLOAD -34
+
 /* Object's bindings container.
  */
 #define EOID_BINDINGS -35
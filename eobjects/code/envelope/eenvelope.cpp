@@ -27,37 +27,69 @@ os_char
     eenvp_content[] = "content",
     eenvp_context[] = "context";
 
+/* Forward referred static functions.
+ */
+static void eenvelope_release_shared(
+    eEnvelopeShared *shared);
+
 
-/* Place name in front of the path.
+/* Place name in front of the path. Path is stored in inline buffer within eEnvelopePath
+   structure as long as it fits. If root is given, path buffers are allocated from and
+   released to root's path buffer pool.
  */
 void eenvelope_prepend_name(
     eEnvelopePath *path,
-    const os_char *name)
+    const os_char *name,
+    eRoot *root)
 {
     os_char *newstr, *p;
-    os_memsz sz;
+    os_memsz sz, request;
     os_int name_sz, newpos;
     os_boolean hasoldpath;
 
     name_sz = (os_int)os_strlen(name);
+
+    /* If no path yet, start using inline buffer.
+     */
+    if (path->str == OS_NULL)
+    {
+        path->str = path->buf;
+        path->str_alloc = EENVELOPE_PATH_INLINE_SZ;
+        path->str_pos = EENVELOPE_PATH_INLINE_SZ;
+    }
     hasoldpath = (os_boolean)(path->str_pos + 1 < path->str_alloc);
 
     /* If name doesn't fit, we need to allocate more space.
      */
     if (name_sz > path->str_pos)
     {
-	    newstr = os_malloc(path->str_alloc + name_sz - path->str_pos + 14, &sz);
+        request = path->str_alloc + name_sz - path->str_pos + 14;
+        if (root)
+        {
+            newstr = root->pathbuf_alloc(request, &sz);
+        }
+        else
+        {
+	        newstr = os_malloc(request, &sz);
+        }
         newpos = (os_int)(sz - (path->str_alloc - path->str_pos) - name_sz);
         p = newstr + newpos;
         os_memcpy(p, name, name_sz);
-        if (path->str)
+        if (hasoldpath)
         {
-            if (hasoldpath)
+            p[name_sz - 1] = '/';
+            os_memcpy(p + name_sz, path->str + path->str_pos, path->str_alloc - path->str_pos);
+        }
+        if (path->str != path->buf)
+        {
+            if (root)
             {
-                p[name_sz - 1] = '/';
-                os_memcpy(p + name_sz, path->str + path->str_pos, path->str_alloc - path->str_pos);
+                root->pathbuf_free(path->str, path->str_alloc);
+            }
+            else
+            {
+                os_free(path->str, path->str_alloc);
             }
-            os_free(path->str, path->str_alloc);
         }
         path->str = newstr;
         path->str_alloc = (os_short)sz;
@@ -77,16 +109,25 @@ void eenvelope_prepend_name(
 
 
 
-/* Clear the path and release memory allocated for it.
+/* Clear the path and release memory allocated for it. If root is given, path buffer is
+   released to root's path buffer pool.
  */
 void eenvelope_clear_path(
-    eEnvelopePath *path)
+    eEnvelopePath *path,
+    eRoot *root)
 {
-    if (path->str) 
+    if (path->str && path->str != path->buf) 
     {
-        os_free(path->str, path->str_alloc);
-        path->str = OS_NULL;
+        if (root)
+        {
+            root->pathbuf_free(path->str, path->str_alloc);
+        }
+        else
+        {
+            os_free(path->str, path->str_alloc);
+        }
     }
+    path->str = OS_NULL;
     path->str_alloc = 0;
     path->str_pos = 0;
 }
@@ -114,6 +155,9 @@ eEnvelope::eEnvelope(
      */
     m_command = 0;
     m_mflags = 0;
+    m_mailbox_next = OS_NULL;
+    m_shared = OS_NULL;
+    m_payload = OS_NULL;
 
     /* m_target_pos = m_source_end = m_source_alloc = 0;
     m_target = m_source = OS_NULL; */
@@ -138,12 +182,17 @@ eEnvelope::~eEnvelope()
 {
     if (m_target.str)
     {
-        eenvelope_clear_path(&m_target);
+        eenvelope_clear_path(&m_target, pathroot());
     }
     if (m_source.str)
     {
-        eenvelope_clear_path(&m_source);
+        eenvelope_clear_path(&m_source, pathroot());
     }
+    if (m_shared)
+    {
+        eenvelope_release_shared(m_shared);
+    }
+    delete m_payload;
 }
 
 
@@ -168,6 +217,7 @@ eObject *eEnvelope::clone(
     os_int aflags)
 {
     eEnvelope *clonedobj;
+    eObject *obj;
 
     /* Clone must have parent object.
      */
@@ -182,6 +232,25 @@ eObject *eEnvelope::clone(
     clonedobj->settarget(target());
     clonedobj->prependsource(source());
 
+    /* Shared content and context are not copied, the clone refers to the same.
+     */
+    if (m_shared)
+    {
+        eatomic_add_int(&m_shared->refcnt, 1);
+        clonedobj->m_shared = m_shared;
+    }
+
+    /* Detached payload is copied as clone's own children, payload tree is created only
+       when the clone is queued to another thread.
+     */
+    else if (m_payload)
+    {
+        obj = content();
+        if (obj) obj->clone(clonedobj, EOID_CONTENT, EOBJ_NO_MAP);
+        obj = context();
+        if (obj) obj->clone(clonedobj, EOID_CONTEXT, EOBJ_NO_MAP);
+    }
+
     /* Copy all clonable children.
      */
     clonegeneric(clonedobj, aflags|EOBJ_CLONE_ALL_CHILDREN);
@@ -255,39 +324,41 @@ void eEnvelope::onpropertychange(
             break;
 
         case EENVP_TARGET:
-            eenvelope_clear_path(&m_target);
-            eenvelope_prepend_name(&m_target, x->gets());
+            eenvelope_clear_path(&m_target, pathroot());
+            eenvelope_prepend_name(&m_target, x->gets(), pathroot());
             break;
 
         case EENVP_SOURCE:
-            eenvelope_clear_path(&m_source);
-            eenvelope_prepend_name(&m_source, x->gets());
+            eenvelope_clear_path(&m_source, pathroot());
+            eenvelope_prepend_name(&m_source, x->gets(), pathroot());
             break;
 
         case EENVP_CONTENT:
+            unshare_content();
             delete content();
             obj = x->geto();
             if (obj)
             {
-                obj->clone(this, EOID_CONTENT);
+                obj->clone(contentholder(), EOID_CONTENT);
             }
             else
             {
-                var = new eVariable(this, EOID_CONTENT);
+                var = new eVariable(contentholder(), EOID_CONTENT);
                 var->setv(x);
             }
             break;
 
         case EENVP_CONTEXT:
+            unshare_content();
             delete context();
             obj = x->geto();
             if (obj)
             {
-                obj->clone(this, EOID_CONTEXT);
+                obj->clone(contentholder(), EOID_CONTEXT);
             }
             else
             {
-                var = new eVariable(this, EOID_CONTEXT);
+                var = new eVariable(contentholder(), EOID_CONTEXT);
                 var->setv(x);
             }
             break;
@@ -528,7 +599,15 @@ eStatus eEnvelope::reader(
     if (stream->getl(&l)) goto failed;
     if (l > 0)
     {
-	    m_target.str = os_malloc(l + 1 + 14, &sz);
+        if (l + 1 <= EENVELOPE_PATH_INLINE_SZ)
+        {
+            m_target.str = m_target.buf;
+            sz = EENVELOPE_PATH_INLINE_SZ;
+        }
+        else
+        {
+            m_target.str = os_malloc(l + 1 + 14, &sz);
+        }
         m_target.str_alloc = (os_short)sz;
         m_target.str_pos = (os_short)(sz - l - 1);
         stream->read(m_target.str + m_target.str_pos, l, &sz);
@@ -543,7 +622,15 @@ eStatus eEnvelope::reader(
         if (stream->getl(&l)) goto failed;
         if (l > 0)
         {
-	        m_source.str = os_malloc(l + 1 + 14, &sz);
+            if (l + 1 <= EENVELOPE_PATH_INLINE_SZ)
+            {
+                m_source.str = m_source.buf;
+                sz = EENVELOPE_PATH_INLINE_SZ;
+            }
+            else
+            {
+                m_source.str = os_malloc(l + 1 + 14, &sz);
+            }
             m_source.str_alloc = (os_short)sz;
             m_source.str_pos = (os_short)(sz - l - 1);
             stream->read(m_source.str + m_source.str_pos, l, &sz);
@@ -627,18 +714,22 @@ void eEnvelope::setcontent(
 
     /* Delete old content, if any.
      */
+    unshare_content();
     c = content();
     if (c) delete c;
 
+    /* Shared objects belong to other envelopes also and arena objects may be released 
+       before the envelope, these are always copied.
+     */
     if (o)
     {
-        if (flags & EMSG_DEL_CONTENT)
+        if ((flags & EMSG_DEL_CONTENT) && canadopt(o))
         {
-            adopt(o, EOID_CONTENT, EOBJ_NO_MAP);
+            contentholder()->adopt(o, EOID_CONTENT, EOBJ_NO_MAP);
         }
         else
         {
-            o->clone(this, EOID_CONTENT, EOBJ_NO_MAP);
+            o->clone(contentholder(), EOID_CONTENT, EOBJ_NO_MAP);
         }
     }
 }
@@ -665,18 +756,22 @@ void eEnvelope::setcontext(
 
     /* Delete old context, if any.
      */
+    unshare_content();
     c = context();
     if (c) delete c;
 
+    /* Shared objects belong to other envelopes also and arena objects may be released 
+       before the envelope, these are always copied.
+     */
     if (o)
     {
-        if (flags & EMSG_DEL_CONTEXT)
+        if ((flags & EMSG_DEL_CONTEXT) && canadopt(o))
         {
-            adopt(o, EOID_CONTEXT, EOBJ_NO_MAP);
+            contentholder()->adopt(o, EOID_CONTEXT, EOBJ_NO_MAP);
         }
         else
         {
-            o->clone(this, EOID_CONTEXT, EOBJ_NO_MAP);
+            o->clone(contentholder(), EOID_CONTEXT, EOBJ_NO_MAP);
         }
     }
 }
@@ -735,3 +830,216 @@ void eEnvelope::prependsourceoix(
     o->oixstr(buf, sizeof(buf));
     prependsource(buf);
 }
+
+
+/**
+****************************************************************************************************
+
+  @brief Share content and context.
+
+  The eEnvelope::share_content() function moves envelope's content and context to a detached
+  object tree, which is shared by this envelope and all it's clones. This is used when the
+  same message is sent to multiple threads: Only the envelope is copied for each recipient
+  thread and all recipients refer to the same content and context. Recipients must not modify
+  shared content or context.
+
+  Only content which is immutable when read is shared, see freeze_content(). Otherwise the 
+  content and context stay with the envelope and are copied for each recipient.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eEnvelope::share_content()
+{
+    eEnvelopeShared
+        *shared;
+
+    eObject
+        *ctnt,
+        *ctxt;
+
+    if (m_shared) return;
+
+    ctnt = content();
+    ctxt = context();
+    if (ctnt == OS_NULL && ctxt == OS_NULL) return;
+    if (!freeze_content(ctnt) || !freeze_content(ctxt)) return;
+
+    shared = (eEnvelopeShared*)os_malloc(sizeof(eEnvelopeShared), OS_NULL);
+    shared->refcnt = 1;
+    shared->holder = new eContainer(OS_NULL, EOID_SHARED_CONTENT);
+    shared->content = ctnt;
+    shared->context = ctxt;
+    if (ctnt) shared->holder->adopt(ctnt, EOID_CONTENT, EOBJ_NO_MAP);
+    if (ctxt) shared->holder->adopt(ctxt, EOID_CONTEXT, EOBJ_NO_MAP);
+    m_shared = shared;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Prepare object tree to be shared by multiple threads.
+
+  The eEnvelope::freeze_content() function checks that reading the object tree does not 
+  modify it. Containers are not modified by reading. Variables cache string conversion of
+  a number on gets() call, so string conversion is done here, before the tree is shared.
+  Other classes, like sets and matrices, may create temporary objects or cache when read, 
+  and tree holding these is not shared.
+
+  @param   o Root of object tree, OS_NULL if none.
+  @return  OS_TRUE if the object tree can be shared.
+
+****************************************************************************************************
+*/
+os_boolean eEnvelope::freeze_content(
+    eObject *o)
+{
+    eObject
+        *child;
+
+    if (o == OS_NULL) return OS_TRUE;
+
+    switch (o->classid())
+    {
+        case ECLASSID_CONTAINER:
+            break;
+
+        case ECLASSID_VARIABLE:
+        case ECLASSID_NAME:
+            ((eVariable*)o)->gets();
+            break;
+
+        default:
+            return OS_FALSE;
+    }
+
+    for (child = o->first(EOID_ALL); child; child = child->next(EOID_ALL))
+    {
+        if (!freeze_content(child)) return OS_FALSE;
+    }
+
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Move content and context to detached payload tree.
+
+  The eEnvelope::detach_payload() function moves envelope's content and context to a detached
+  object tree owned by this envelope. This is called by sender before the envelope is passed
+  to another thread: When the receiving thread adopts the envelope, only the envelope itself
+  moves and content and context, which can be large, are not walked trough to set root
+  pointers. Names within content and context are never mapped while in envelope (content
+  is set with EOBJ_NO_MAP), so nothing else needs to be done for them.
+
+  Payload is detached only if content or context has child objects, moving a single object
+  is as cheap as creating the payload tree. The calling thread must own the envelope.
+  Content and context are kept as envelope's children until then, so messages within a
+  thread never create the payload tree. See eThread::detach_envelope().
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eEnvelope::detach_payload()
+{
+    eObject
+        *ctnt,
+        *ctxt;
+
+    if (m_shared || m_payload) return;
+
+    ctnt = first(EOID_CONTENT);
+    ctxt = first(EOID_CONTEXT);
+    if ((ctnt == OS_NULL || ctnt->childcount(EOID_ALL) == 0) &&
+        (ctxt == OS_NULL || ctxt->childcount(EOID_ALL) == 0)) return;
+
+    payload();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get detached payload tree.
+
+  The eEnvelope::payload() function returns envelope's detached payload tree. If it doesn't
+  exist, it is created and content and context, which are envelope's children so far, are 
+  moved into it. Payload tree is not visible to other threads, no need to synchronize.
+
+  @return  Pointer to payload container.
+
+****************************************************************************************************
+*/
+eContainer *eEnvelope::payload()
+{
+    eObject
+        *ctnt,
+        *ctxt;
+
+    if (m_payload) return m_payload;
+
+    ctnt = first(EOID_CONTENT);
+    ctxt = first(EOID_CONTEXT);
+    m_payload = new eContainer(OS_NULL, EOID_PAYLOAD);
+    if (ctnt) m_payload->adopt(ctnt, EOID_CONTENT, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+    if (ctxt) m_payload->adopt(ctxt, EOID_CONTEXT, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+    return m_payload;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Make private copy of shared content and context.
+
+  The eEnvelope::unshare_content() function copies shared content and context as children of
+  this envelope and releases the shared ones. This is needed before content or context can
+  be modified.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eEnvelope::unshare_content()
+{
+    eEnvelopeShared
+        *shared;
+
+    shared = m_shared;
+    if (shared == OS_NULL) return;
+    m_shared = OS_NULL;
+
+    if (shared->content) shared->content->clone(contentholder(), EOID_CONTENT, EOBJ_NO_MAP);
+    if (shared->context) shared->context->clone(contentholder(), EOID_CONTEXT, EOBJ_NO_MAP);
+    eenvelope_release_shared(shared);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release reference to shared content and context.
+
+  The eenvelope_release_shared() function decrements reference count of shared content and
+  context. The last envelope referring to it deletes the shared object tree. This may happen
+  in any thread.
+
+  @param   shared Pointer to shared content and context structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void eenvelope_release_shared(
+    eEnvelopeShared *shared)
+{
+    if (eatomic_add_int(&shared->refcnt, -1) == 0)
+    {
+        delete shared->holder;
+        os_free(shared, sizeof(eEnvelopeShared));
+    }
+}
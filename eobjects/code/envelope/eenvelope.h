@@ -50,6 +50,8 @@
 #define ECMD_REBIND -24
 #define ECMD_FWRD -25
 #define ECMD_ACK -26
+#define ECMD_FWRD_MUX -27
+#define ECMD_ACK_MUX -28
 
 /* Thread control, exit thread.
  */
@@ -81,26 +83,56 @@ extern os_char
     eenvp_content[],
     eenvp_context[];
 
-/* Source and target string presentations
+/* Size of inline buffer for source and target paths. Paths which fit in this are not
+   allocated from heap.
+ */
+#define EENVELOPE_PATH_INLINE_SZ 48
+
+/* Source and target string presentations. The str points either to inline buffer buf or
+   to heap memory, if path grows too long for the inline buffer.
  */
 typedef struct 
 {
     os_char *str;
     os_short str_pos;
     os_short str_alloc;
+    os_char buf[EENVELOPE_PATH_INLINE_SZ];
 }
 eEnvelopePath;
 
+/* Content and context shared by envelopes multicast to multiple threads with
+   EMSG_SHARED_CONTENT flag. Shared objects are read only, and only containers and variables
+   are shared, see eEnvelope::freeze_content().
+ */
+typedef struct eEnvelopeShared
+{
+    /** Number of envelopes referring to this structure.
+     */
+    volatile os_int refcnt;
+
+    /** Root of detached object tree holding shared content and context.
+     */
+    eContainer *holder;
+
+    /** Shared content and context, OS_NULL if none.
+     */
+    eObject *content;
+    eObject *context;
+}
+eEnvelopeShared;
+
 /* Place name in front of the path.
  */
 void eenvelope_prepend_name(
     eEnvelopePath *path,
-    const os_char *name);
+    const os_char *name,
+    eRoot *root = OS_NULL);
 
 /* Clear the path and release memory allocated for it.
  */
 void eenvelope_clear_path(
-    eEnvelopePath *path);
+    eEnvelopePath *path,
+    eRoot *root = OS_NULL);
 
 
 /**
@@ -116,6 +148,9 @@ void eenvelope_clear_path(
 */
 class eEnvelope : public eObject
 {
+    friend class eThread;
+    friend class eMessageBatch;
+
     /**
     ************************************************************************************************
 
@@ -197,6 +232,62 @@ public:
         eStream *stream, 
         os_int flags);
 
+    /*@}*/
+
+    /** 
+    ************************************************************************************************
+
+      @name Memory allocation
+
+      Envelope memory can be recycled trough thread's envelope pool, see eRoot::envelope_alloc()
+      and eRoot::envelope_recycle(). Placement new is used to construct an envelope in memory
+      taken from the pool.
+
+    ************************************************************************************************
+    */
+    /*@{*/
+
+#if EOVERLOAD_NEW_AND_DELETE || E_SLAB_ALLOCATOR
+    inline void* operator new(
+        size_t size)
+    {
+        return eObject::operator new(size);
+    }
+
+    inline void operator delete(
+        void *buf)
+    {
+        eObject::operator delete(buf);
+    }
+#else
+    inline void* operator new(
+        size_t size)
+    {
+        return ::operator new(size);
+    }
+
+    inline void operator delete(
+        void *buf)
+    {
+        ::operator delete(buf);
+    }
+#endif
+
+    /* Placement new, construct envelope in memory from envelope pool.
+     */
+    inline void* operator new(
+        size_t size,
+        void *buf)
+    {
+        return buf;
+    }
+
+    inline void operator delete(
+        void *buf,
+        void *pool_buf)
+    {
+    }
+
     /*@}*/
 
 	/** 
@@ -261,7 +352,7 @@ public:
         const os_char *target)
     {
         osal_debug_assert(m_target.str == OS_NULL);
-        eenvelope_prepend_name(&m_target, target);
+        eenvelope_prepend_name(&m_target, target, pathroot());
     }
 
     void settarget(
@@ -300,7 +391,7 @@ public:
     inline void prependtarget(
         const os_char *name)
     {
-        eenvelope_prepend_name(&m_target, name);
+        eenvelope_prepend_name(&m_target, name, pathroot());
     }
 
 //    os_boolean nexttargetis(char *name);
@@ -313,7 +404,7 @@ public:
     inline void prependsource(
         const os_char *name)
     {
-        eenvelope_prepend_name(&m_source, name);
+        eenvelope_prepend_name(&m_source, name, pathroot());
     }
 
     /* void appendsource(
@@ -349,17 +440,82 @@ public:
 
     inline eObject *content() 
     {
-        return first(EOID_CONTENT);
+        if (m_shared) return m_shared->content;
+        return contentholder()->first(EOID_CONTENT);
     }
 
     inline eObject *context() 
     {
-        return first(EOID_CONTEXT);
+        if (m_shared) return m_shared->context;
+        return contentholder()->first(EOID_CONTEXT);
     }
 
+    /* Move content and context to shared read only object tree, so that clones of the
+       envelope refer to the same content and context.
+     */
+    void share_content();
+
+    /* Move content and context to envelope's own detached object tree, so that moving the
+       envelope to another thread doesn't need to process content and context.
+     */
+    void detach_payload();
+
     /*@}*/
 
 private:
+    /* Get detached payload tree, create it if needed.
+     */
+    eContainer *payload();
+
+    /** Get root whose path buffer pool to use. Pool is not used while object tree
+        is being deleted, since root may have been deleted already.
+     */
+    inline eRoot *pathroot()
+    {
+        if (mm_handle == OS_NULL) return OS_NULL;
+        if (mm_handle->flags() & EOBJ_FAST_DELETE) return OS_NULL;
+        return mm_handle->root();
+    }
+
+    /* Make private copy of shared content and context.
+     */
+    void unshare_content();
+
+    /* Prepare object tree to be shared, OS_FALSE if it can not be shared.
+     */
+    static os_boolean freeze_content(
+        eObject *o);
+
+    /** Get parent object of content and context: Detached payload tree, if any, or this
+        envelope.
+     */
+    inline eObject *contentholder()
+    {
+        return m_payload ? (eObject*)m_payload : (eObject*)this;
+    }
+
+    /** Check if object is shared content or context of an envelope.
+     */
+    inline static os_boolean isshared(
+        eObject *o)
+    {
+        eObject *p;
+        p = o->parent();
+        return (os_boolean)(p != OS_NULL && p->oid() == EOID_SHARED_CONTENT);
+    }
+
+    /** Check if object can be adopted as content or context. Shared objects and objects
+        allocated from memory arena, which may be released before the envelope, are copied.
+     */
+    inline static os_boolean canadopt(
+        eObject *o)
+    {
+#if E_SLAB_ALLOCATOR
+        if (eslab_isarena(o)) return OS_FALSE;
+#endif
+        return (os_boolean)!isshared(o);
+    }
+
     /** Command.
      */
     os_int m_command;
@@ -372,6 +528,19 @@ private:
     eEnvelopePath m_target;
 
     eEnvelopePath m_source;
+
+    /* Shared content and context, OS_NULL if content and context are envelope's children.
+     */
+    eEnvelopeShared *m_shared;
+
+    /* Detached object tree holding content and context, OS_NULL if content and context are
+       envelope's children. See detach_payload().
+     */
+    eContainer *m_payload;
+
+    /* Next envelope in thread's mailbox, used only while envelope is queued.
+     */
+    eEnvelope *m_mailbox_next;
 };
 
 #endif
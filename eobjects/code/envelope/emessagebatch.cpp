@@ -0,0 +1,406 @@
+/**
+
+  @file    emessagebatch.cpp
+  @brief   Sending many messages at once.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The eMessageBatch collects messages and sends them all with one process mutex lock.
+  Messages are grouped by destination thread and lane, and each group is moved to thread's
+  mailbox with one atomic operation, so the thread is triggered at most once per group.
+  Messages which cannot be resolved in batch (within sender's thread, names mapped to multiple
+  threads, full queues, errors) are sent one by one by eObject::message() once process mutex
+  has been released.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Constructor.
+
+  Mark the batch empty.
+
+  @param   sender Object sending the messages.
+  @return  None.
+
+****************************************************************************************************
+*/
+eMessageBatch::eMessageBatch(
+    eObject *sender)
+{
+    m_sender = sender;
+    m_first = m_last = OS_NULL;
+    m_nro_groups = 0;
+    m_nro_full = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Destructor.
+
+  Send messages not yet sent.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+eMessageBatch::~eMessageBatch()
+{
+    flush();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add message to batch.
+
+  The eMessageBatch::message() function creates an envelope like eObject::message() would,
+  but only adds it to the batch. Arguments are the same as for eObject::message().
+
+  @param   command Command, like ECMD_SETPROPERTY.
+  @param   target Path to target object.
+  @param   source Source path, OS_NULL if none.
+  @param   content Message content, OS_NULL if none.
+  @param   mflags Message flags, like EMSG_DEL_CONTENT.
+  @param   context Message context, OS_NULL if none.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eMessageBatch::message(
+    os_int command, 
+    const os_char *target,
+    const os_char *source,
+    eObject *content,
+    os_int mflags,
+    eObject *context)
+{
+    eEnvelope *envelope;
+
+    envelope = m_sender->newenvelope(command, target, source, content, mflags, context);
+    envelope->addmflags(EMSG_NO_RESOLVE);
+
+    /* Add oix to source path when needed.
+     */
+    if ((envelope->mflags() & (EMSG_NO_REPLIES|EMSG_NO_NEW_SOURCE_OIX)) == 0)
+    {
+        envelope->prependsourceoix(m_sender);
+        envelope->addmflags(EMSG_NO_NEW_SOURCE_OIX);
+    }
+
+    envelope->m_mailbox_next = OS_NULL;
+    if (m_last) m_last->m_mailbox_next = envelope;
+    else m_first = envelope;
+    m_last = envelope;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Send all messages in batch.
+
+  The eMessageBatch::flush() function locks process mutex once, resolves destination thread
+  of each envelope and pushes envelopes grouped by thread and lane to mailboxes. Envelopes
+  which could not be resolved are sent by eObject::message() after the mutex has been
+  released, these may be delivered after the batched ones. Once a message to a thread has
+  not been batched because the thread's queue was full, the following messages to the same
+  thread are not batched either, so messages to each target are delivered in order.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eMessageBatch::flush()
+{
+    eEnvelope
+        *envelope,
+        *next,
+        *fallback,
+        *fallback_last;
+
+    os_int
+        i;
+
+    if (m_first == OS_NULL) return;
+
+    envelope = m_first;
+    m_first = m_last = OS_NULL;
+    fallback = fallback_last = OS_NULL;
+    m_nro_full = 0;
+
+    os_lock();
+    while (envelope)
+    {
+        next = envelope->m_mailbox_next;
+        envelope->m_mailbox_next = OS_NULL;
+
+        if (!resolve(envelope))
+        {
+            if (fallback_last) fallback_last->m_mailbox_next = envelope;
+            else fallback = envelope;
+            fallback_last = envelope;
+        }
+
+        envelope = next;
+    }
+
+    for (i = 0; i < m_nro_groups; i++)
+    {
+        pushgroup(m_group + i);
+    }
+    m_nro_groups = 0;
+    os_unlock();
+
+    /* Send envelopes which could not be batched one by one.
+     */
+    while (fallback)
+    {
+        next = fallback->m_mailbox_next;
+        fallback->m_mailbox_next = OS_NULL;
+        m_sender->message(fallback);
+        fallback = next;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Resolve destination thread of an envelope.
+
+  The eMessageBatch::resolve() function finds the thread for target path starting with
+  object index "@11_2" or name in process name space "//name", modifies the target path
+  like eObject::message() would, and adds the envelope to the thread's group.
+  Process mutex must be locked.
+
+  @param   envelope Envelope to resolve.
+  @return  OS_TRUE if envelope was added to a group. OS_FALSE if it needs to be sent
+           by eObject::message(), target path is not modified in this case.
+
+****************************************************************************************************
+*/
+os_boolean eMessageBatch::resolve(
+    eEnvelope *envelope)
+{
+    eHandle *handle;
+    eThread *thread;
+    eNsIndexResult res;
+    eNsIndexGuard guard;
+    os_char buf[E_OIXSTR_BUF_SZ], *target, *oname, *p;
+    os_memsz sz;
+    os_uint hash;
+    e_oix oix;
+    os_int ucnt;
+    os_short count;
+    os_boolean is_thread;
+
+    target = envelope->target();
+
+    /* Object index.
+     */
+    if (*target == '@')
+    {
+        count = m_sender->oixparse(target, &oix, &ucnt);
+        if (count == 0) return OS_FALSE;
+
+        handle = eget_handle(oix);
+        if (ucnt != handle->m_ucnt || handle->m_root == OS_NULL) return OS_FALSE;
+        if (m_sender->mm_handle == OS_NULL ||
+            handle->m_root == m_sender->mm_handle->m_root) return OS_FALSE;
+
+        thread = eThread::cast(handle->m_root->parent());
+        if (thread == OS_NULL) return OS_FALSE;
+        if (queuefull(thread, envelope)) return OS_FALSE;
+
+        if (thread == handle->m_object) envelope->move_target_over_objname(count);
+        addtogroup(thread, envelope);
+        return OS_TRUE;
+    }
+
+    /* Name in process name space, mapped to objects in one thread.
+     */
+    if (target[0] == '/' && target[1] == '/')
+    {
+        oname = target + 2;
+        for (p = oname; *p != '/' && *p != '\0'; p++);
+        sz = p - oname;
+        if (sz == 0) return OS_FALSE;
+
+        hash = ensindex_hash(oname, sz);
+        if (!ensindex_lookup(oname, sz, hash, &res, &guard) ||
+            res.multiple_threads || res.thread == OS_NULL)
+        {
+            ensindex_release(&guard);
+            return OS_FALSE;
+        }
+        os_strncpy(buf, res.oixstr, sizeof(buf));
+        thread = res.thread;
+        is_thread = res.is_thread;
+        ensindex_release(&guard);
+
+        /* Process mutex is locked, so the name cannot be detached and the thread
+           cannot be deleted.
+         */
+        if (queuefull(thread, envelope)) return OS_FALSE;
+
+        envelope->move_target_pos(2);
+        if (!is_thread) 
+        {
+            if (*oname != '@')
+            {
+                envelope->move_target_over_objname((os_short)sz);
+                envelope->prependtarget(buf);
+            }
+        }
+        else
+        {
+            envelope->move_target_over_objname((os_short)sz);
+        }
+        addtogroup(thread, envelope);
+        return OS_TRUE;
+    }
+
+    return OS_FALSE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if envelope must be sent one by one because of full queue.
+
+  The eMessageBatch::queuefull() function checks if normal lane of destination thread is at
+  high water mark. Thread whose queue has been found full is remembered until end of flush,
+  so later normal lane messages to it are not batched ahead of the ones sent one by one.
+  Process mutex must be locked.
+
+  @param   thread Destination thread.
+  @param   envelope Envelope to send.
+  @return  OS_TRUE if envelope needs to be sent by eObject::message().
+
+****************************************************************************************************
+*/
+os_boolean eMessageBatch::queuefull(
+    eThread *thread,
+    eEnvelope *envelope)
+{
+    os_int
+        i;
+
+    if (eThread::envelopelane(envelope) != ETHREAD_LANE_NORMAL) return OS_FALSE;
+
+    for (i = 0; i < m_nro_full; i++)
+    {
+        if (m_full[i] == thread) return OS_TRUE;
+    }
+
+    /* Can not remember more threads, send rest of normal lane messages one by one.
+     */
+    if (m_nro_full >= EMESSAGEBATCH_MAX_FULL) return OS_TRUE;
+
+    if (!thread->queuefull()) return OS_FALSE;
+    m_full[m_nro_full++] = thread;
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add envelope to group of thread's lane.
+
+  The eMessageBatch::addtogroup() function detaches envelope from sender's tree and adds it
+  to group of the destination thread and lane. If there is no free group left, all groups
+  are pushed to mailboxes first. Order of envelopes to same thread is preserved.
+
+  @param   thread Destination thread.
+  @param   envelope Envelope to add.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eMessageBatch::addtogroup(
+    eThread *thread,
+    eEnvelope *envelope)
+{
+    eMessageBatchGroup
+        *g;
+
+    os_int
+        lane,
+        i;
+
+    lane = eThread::envelopelane(envelope);
+
+    g = OS_NULL;
+    for (i = 0; i < m_nro_groups; i++)
+    {
+        if (m_group[i].thread == thread && m_group[i].lane == lane)
+        {
+            g = m_group + i;
+            break;
+        }
+    }
+
+    if (g == OS_NULL)
+    {
+        if (m_nro_groups >= EMESSAGEBATCH_MAX_GROUPS)
+        {
+            for (i = 0; i < m_nro_groups; i++)
+            {
+                pushgroup(m_group + i);
+            }
+            m_nro_groups = 0;
+        }
+
+        g = m_group + m_nro_groups++;
+        g->thread = thread;
+        g->lane = lane;
+        g->first = g->last = OS_NULL;
+        g->count = 0;
+    }
+
+    thread->detach_envelope(envelope);
+    envelope->m_mailbox_next = g->last;
+    g->last = envelope;
+    if (g->first == OS_NULL) g->first = envelope;
+    g->count++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Push a group to it's thread's mailbox.
+
+  The eMessageBatch::pushgroup() function moves all envelopes of the group to thread's mailbox
+  lane with one atomic operation.
+
+  @param   g Pointer to group.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eMessageBatch::pushgroup(
+    eMessageBatchGroup *g)
+{
+    if (g->count == 0) return;
+
+    g->thread->mailbox_push(g->first, g->last, g->lane, g->count);
+    g->thread->queuestats(g->count);
+    g->count = 0;
+}
@@ -0,0 +1,135 @@
+/**
+
+  @file    emessagebatch.h
+  @brief   Sending many messages at once.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The eMessageBatch collects messages and sends them all with one process mutex lock.
+  Messages are grouped by destination thread and lane, and each group is moved to thread's
+  mailbox with one atomic operation, so the thread is triggered at most once per group.
+  Messages which cannot be resolved in batch (within sender's thread, names mapped to multiple
+  threads, full queues, errors) are sent one by one by eObject::message() once process mutex
+  has been released.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EMESSAGEBATCH_INCLUDED
+#define EMESSAGEBATCH_INCLUDED
+
+/** Maximum number of destination thread groups per flush. If there are more, the groups
+    are pushed to threads as they run out.
+ */
+#define EMESSAGEBATCH_MAX_GROUPS 16
+
+/** Maximum number of threads with full queue remembered per flush. If there are more, all
+    following normal lane messages are sent one by one.
+ */
+#define EMESSAGEBATCH_MAX_FULL 16
+
+/** Envelopes to one thread's mailbox lane, linked newest first trough m_mailbox_next.
+ */
+typedef struct eMessageBatchGroup
+{
+    eThread *thread;
+    eEnvelope *first;
+    eEnvelope *last;
+    os_int lane;
+    os_int count;
+}
+eMessageBatchGroup;
+
+
+/**
+****************************************************************************************************
+
+  @brief Message batch class.
+
+  Typically used as local variable: Call message() for each message to send, and messages
+  are sent when flush() is called or the batch goes out of scope. The batch must be used
+  only by thread owning the sender object.
+
+****************************************************************************************************
+*/
+class eMessageBatch
+{
+public:
+    /* Constructor.
+	 */
+	eMessageBatch(
+		eObject *sender);
+
+	/* Destructor, sends messages not yet sent.
+ 	 */
+	~eMessageBatch();
+
+    /* Add message to batch.
+     */
+    void message(
+        os_int command, 
+        const os_char *target,
+        const os_char *source = OS_NULL,
+        eObject *content = OS_NULL,
+        os_int mflags = EMSG_DEFAULT,
+        eObject *context = OS_NULL);
+
+    /* Send all messages in batch.
+     */
+    void flush();
+
+private:
+    /* Resolve destination thread of one envelope and add it to a group.
+     */
+    os_boolean resolve(
+        eEnvelope *envelope);
+
+    /* Check if envelope to thread must be sent one by one because of full queue.
+     */
+    os_boolean queuefull(
+        eThread *thread,
+        eEnvelope *envelope);
+
+    /* Add envelope to group of thread's lane.
+     */
+    void addtogroup(
+        eThread *thread,
+        eEnvelope *envelope);
+
+    /* Push a group to it's thread's mailbox.
+     */
+    void pushgroup(
+        eMessageBatchGroup *g);
+
+    /* Disable copy constructor and assignment operator.
+     */
+    eMessageBatch(eMessageBatch const&);
+    eMessageBatch& operator=(eMessageBatch const&);
+
+    /* Sending object.
+     */
+    eObject *m_sender;
+
+    /* Collected envelopes in order they were added, linked trough m_mailbox_next.
+     */
+    eEnvelope *m_first;
+    eEnvelope *m_last;
+
+    /* Destination groups while flushing.
+     */
+    eMessageBatchGroup m_group[EMESSAGEBATCH_MAX_GROUPS];
+    os_int m_nro_groups;
+
+    /* Threads to which normal lane messages are sent one by one while flushing, because
+       queue was full.
+     */
+    eThread *m_full[EMESSAGEBATCH_MAX_FULL];
+    os_int m_nro_full;
+};
+
+#endif
@@ -54,6 +54,14 @@ void eobjects_initialize(
      */
     ehandleroot_initialize();
 
+    /* Initialize process name space index.
+     */
+    ensindex_initialize();
+
+    /* Initialize atom table.
+     */
+    eatom_initialize();
+
     /* Initialize class list
      */
     eclasslist_initialize();
@@ -82,6 +90,10 @@ void eobjects_shutdown()
      */
     if (!eglobal->initialized) return;
 
+    /* Stop scheduler worker threads, if running.
+     */
+    escheduler_stop();
+
     /* Delete debugging console stream.
      */
     delete eglobal->console;
@@ -90,10 +102,24 @@ void eobjects_shutdown()
      */
     eclasslist_release();
 
+    /* Release process name space index.
+     */
+    ensindex_shutdown();
+
+    /* Release atom table.
+     */
+    eatom_shutdown();
+
     /* Delete handle tables.
      */
     ehandleroot_shutdown();
 
+#if E_SLAB_ALLOCATOR
+    /* Release memory blocks of slab allocator.
+     */
+    eslab_shutdown();
+#endif
+
     /* Mark eobjects library uninitialized.
      */
     eglobal->initialized = OS_FALSE;
@@ -53,6 +53,22 @@ typedef struct eGlobal
 
     eHandleRoot hroot;
 
+    /** Lock free index of process name space.
+     */
+    eNsIndex nsindex;
+
+    /** Interned strings, see eatom.h.
+     */
+    eAtomTable atoms;
+
+    /** Worker thread pool for scheduled threads.
+     */
+    eScheduler sched;
+
+    /** Thread local slab allocator caches.
+     */
+    eSlab slab;
+
     /** Root container for global objects.
      */
     eContainer *root;
@@ -69,6 +85,10 @@ typedef struct eGlobal
      */
     eContainer *propertysets;
 
+    /** Flat property tables built from property sets, see eproptable.h.
+     */
+    ePropertyTables proptables;
+
     /** Pointer to process thread handle.
      */
     eThreadHandle *processhandle;
@@ -138,12 +158,41 @@ inline eNameSpace *eglobal_process_ns()
     return eglobal->process_ns;
 }
 
-/* THIS MUST BE AS FAST FUNCTION AS POSSIBLE                NOT USED YET
+/* THIS MUST BE AS FAST FUNCTION AS POSSIBLE. Get handle pointer by valid object index.
  */
 inline eHandle *eget_handle(
     e_oix oix)
 {
-    return eglobal->hroot.m_table[oix >> EHANDLE_HANDLE_BITS]->m_handle + (oix & EHANDLE_TABLE_MAX);
+    return eglobal->hroot.m_table[oix >> EHANDLE_HANDLE_BITS]->m_handle + (oix & EHANDLE_HANDLE_MAX);
+}
+
+/* Get handle pointer by object index, which may not be valid (for example parsed from
+   oix string). Returns OS_NULL if handle table for the oix has not been allocated. Needs no
+   locking: Handle tables are never freed while the process runs and table pointer is
+   stored before number of tables is incremented.
+ */
+inline eHandle *eget_handle_check(
+    e_oix oix)
+{
+    os_uint t;
+
+    t = (os_uint)oix >> EHANDLE_HANDLE_BITS;
+    if (t >= (os_uint)eatomic_load_int((volatile os_int*)&eglobal->hroot.m_nrotables)) 
+    {
+        return OS_NULL;
+    }
+
+    return ((eHandleTable*)eatomic_load_ptr((void*volatile*)&eglobal->hroot.m_table[t]))
+        ->m_handle + (oix & EHANDLE_HANDLE_MAX);
+}
+
+/* Get generation of process name space index shard, to which names with the hash belong to.
+ */
+inline os_int ensindex_generation(
+    os_uint hash)
+{
+    return eatomic_load_int(
+        &eglobal->nsindex.shard[hash & (ENSINDEX_NRO_SHARDS - 1)].generation);
 }
 
 /* Nicer name for console stream as debug output
@@ -122,7 +122,7 @@ eObject *eMatrix::clone(
     eVariable *tmp;
     os_int row, column;
 
-    clonedobj = new eMatrix(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eMatrix(parent, id == EOID_CHILD ? oid() : id, flags());
     tmp = new eVariable(this);
 
     /* Slightly slow but simple clone. Optimize later if time.
@@ -98,7 +98,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eMatrix(parent, id, flags);
+        return new (parent) eMatrix(parent, id, flags);
     }
 
     /* Write matrix content to stream.
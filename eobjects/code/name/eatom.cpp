@@ -0,0 +1,418 @@
+/**
+
+  @file    eatom.cpp
+  @brief   Process wide table of interned strings.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Atom entries are stored in fixed size chunks, so pointer to an entry stays valid while the
+  table grows. Strings are found by open addressing hash slots. An entry is written before its
+  atom is stored into a slot, so readers which find the atom in a slot see complete entry.
+  When slots get half full, a new larger slot array is built and published. The old one is
+  kept until shutdown, since readers may still be probing it.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+/* Forward referred static functions.
+ */
+static eAtomEntry *eatom_entry(
+    eAtom atom);
+
+static eAtom eatom_lookup(
+    const os_char *str,
+    os_int len,
+    os_uint hash);
+
+static void eatom_newslots(
+    os_int nro_slots);
+
+
+/**
+****************************************************************************************************
+
+  @brief Initialize atom table.
+
+  The eatom_initialize function clears the atom table and interns name space identifiers, so
+  that these get atoms EATOM_PROCESS_NS, EATOM_THREAD_NS, EATOM_PARENT_NS and EATOM_THIS_NS.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eatom_initialize()
+{
+    os_memclear(&eglobal->atoms, sizeof(eAtomTable));
+    eglobal->atoms.nro_atoms = 1;
+
+    eatom_intern(E_PROCESS_NS);
+    eatom_intern(E_THREAD_NS);
+    eatom_intern(E_PARENT_NS);
+    eatom_intern(E_THIS_NS);
+
+    osal_debug_assert(eatom_find(E_THIS_NS) == EATOM_THIS_NS);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release memory allocated for atom table.
+
+  The eatom_shutdown function releases interned strings, entry chunks and hash slots. No
+  thread may be using atom table when this function is called.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eatom_shutdown()
+{
+    eAtomTable
+        *t;
+
+    eAtomSlots
+        *s,
+        *next_s;
+
+    eAtomEntry
+        *e;
+
+    os_int
+        atom,
+        i;
+
+    t = &eglobal->atoms;
+
+    for (atom = 1; atom < t->nro_atoms; atom++)
+    {
+        e = eatom_entry(atom);
+        os_free(e->str, e->len + 1);
+    }
+
+    for (i = 0; i < EATOM_MAX_CHUNKS; i++)
+    {
+        if (t->chunk[i]) os_free(t->chunk[i], EATOM_CHUNK_SZ * sizeof(eAtomEntry));
+    }
+
+    s = t->slots;
+    if (s) s->next = t->retired;
+    for (; s; s = next_s)
+    {
+        next_s = s->next;
+        os_free(s, s->alloc);
+    }
+
+    os_memclear(t, sizeof(eAtomTable));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get atom for a string, intern the string if needed.
+
+  The eatom_intern function returns atom for a string. If the string has not been interned
+  before, it is added to atom table with process mutex locked.
+
+  @param   str String to intern, does not need to be '\0' terminated if len is given.
+  @param   len String length in bytes, -1 if str is '\0' terminated.
+  @return  Atom, EATOM_NONE if atom table is full.
+
+****************************************************************************************************
+*/
+eAtom eatom_intern(
+    const os_char *str,
+    os_memsz len)
+{
+    eAtomTable
+        *t;
+
+    eAtomSlots
+        *s;
+
+    eAtomEntry
+        *e;
+
+    os_uint
+        hash;
+
+    os_int
+        atom,
+        c,
+        i;
+
+    if (len < 0) len = os_strlen(str) - 1;
+    hash = ensindex_hash(str, len);
+
+    atom = eatom_lookup(str, (os_int)len, hash);
+    if (atom) return atom;
+
+    os_lock();
+
+    /* Other thread may have added the atom before we got the lock.
+     */
+    atom = eatom_lookup(str, (os_int)len, hash);
+    if (atom) goto getout;
+
+    t = &eglobal->atoms;
+    atom = t->nro_atoms;
+    c = atom >> EATOM_CHUNK_BITS;
+    if (c >= EATOM_MAX_CHUNKS)
+    {
+        osal_debug_error("eatom_intern: atom table is full");
+        atom = EATOM_NONE;
+        goto getout;
+    }
+
+    /* Allocate new chunk of entries if needed.
+     */
+    if (t->chunk[c] == OS_NULL)
+    {
+        e = (eAtomEntry*)os_malloc(EATOM_CHUNK_SZ * sizeof(eAtomEntry), OS_NULL);
+        os_memclear(e, EATOM_CHUNK_SZ * sizeof(eAtomEntry));
+        eatomic_store_ptr((void*volatile*)&t->chunk[c], e);
+    }
+
+    /* Fill in the entry before it can be found.
+     */
+    e = t->chunk[c] + (atom & (EATOM_CHUNK_SZ - 1));
+    e->hash = hash;
+    e->len = (os_int)len;
+    e->str = (os_char*)os_malloc(len + 1, OS_NULL);
+    os_memcpy(e->str, str, len);
+    e->str[len] = '\0';
+    eatomic_store_int(&t->nro_atoms, atom + 1);
+
+    /* Keep slots at most half full. New slot array includes the new atom.
+     */
+    s = t->slots;
+    if (s == OS_NULL || 2 * atom > s->slot_mask)
+    {
+        eatom_newslots(s ? 2 * (s->slot_mask + 1) : EATOM_MIN_SLOTS);
+    }
+    else
+    {
+        i = (os_int)(hash & s->slot_mask);
+        while (s->slot[i]) i = (i + 1) & s->slot_mask;
+        eatomic_store_int(&s->slot[i], atom);
+    }
+
+getout:
+    os_unlock();
+    return atom;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get atom for a string without locking.
+
+  The eatom_find function looks up atom for a string. The string is not interned.
+
+  @param   str String to look for, does not need to be '\0' terminated if len is given.
+  @param   len String length in bytes, -1 if str is '\0' terminated.
+  @return  Atom, EATOM_NONE if the string has not been interned.
+
+****************************************************************************************************
+*/
+eAtom eatom_find(
+    const os_char *str,
+    os_memsz len)
+{
+    if (len < 0) len = os_strlen(str) - 1;
+    return eatom_lookup(str, (os_int)len, ensindex_hash(str, len));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get atom's string.
+
+  The eatom_str function returns interned string for an atom. The string stays valid until
+  shutdown.
+
+  @param   atom Atom.
+  @return  Pointer to '\0' terminated string, OS_NULL if atom is not valid.
+
+****************************************************************************************************
+*/
+const os_char *eatom_str(
+    eAtom atom)
+{
+    eAtomEntry *e;
+    e = eatom_entry(atom);
+    return e ? e->str : OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get atom's string hash.
+
+  The eatom_hash function returns hash of atom's string. This is the same value
+  ensindex_hash() calculates for the string, so hash tables keyed by string hash can be
+  searched by atom without hashing the string.
+
+  @param   atom Atom.
+  @return  Hash value, zero if atom is not valid.
+
+****************************************************************************************************
+*/
+os_uint eatom_hash(
+    eAtom atom)
+{
+    eAtomEntry *e;
+    e = eatom_entry(atom);
+    return e ? e->hash : 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get pointer to atom entry.
+
+  The eatom_entry function finds atom table entry by atom without locking.
+
+  @param   atom Atom.
+  @return  Pointer to the entry, OS_NULL if atom is not valid.
+
+****************************************************************************************************
+*/
+static eAtomEntry *eatom_entry(
+    eAtom atom)
+{
+    eAtomEntry
+        *chunk;
+
+    if (atom <= EATOM_NONE || atom >= eatomic_load_int(&eglobal->atoms.nro_atoms))
+    {
+        return OS_NULL;
+    }
+
+    chunk = (eAtomEntry*)eatomic_load_ptr(
+        (void*volatile*)&eglobal->atoms.chunk[atom >> EATOM_CHUNK_BITS]);
+    return chunk + (atom & (EATOM_CHUNK_SZ - 1));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Look up atom from hash slots.
+
+  The eatom_lookup function probes current hash slots for the string without locking.
+
+  @param   str String to look for.
+  @param   len String length in bytes.
+  @param   hash Hash of the string.
+  @return  Atom, EATOM_NONE if not found.
+
+****************************************************************************************************
+*/
+static eAtom eatom_lookup(
+    const os_char *str,
+    os_int len,
+    os_uint hash)
+{
+    eAtomSlots
+        *s;
+
+    eAtomEntry
+        *e;
+
+    os_int
+        atom,
+        i,
+        j;
+
+    s = (eAtomSlots*)eatomic_load_ptr((void*volatile*)&eglobal->atoms.slots);
+    if (s == OS_NULL) return EATOM_NONE;
+
+    i = (os_int)(hash & s->slot_mask);
+    while ((atom = eatomic_load_int(&s->slot[i])))
+    {
+        e = eatom_entry(atom);
+        if (e->hash == hash && e->len == len)
+        {
+            for (j = 0; j < len; j++)
+            {
+                if (e->str[j] != str[j]) break;
+            }
+            if (j == len) return atom;
+        }
+        i = (i + 1) & s->slot_mask;
+    }
+
+    return EATOM_NONE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Build new hash slots.
+
+  The eatom_newslots function allocates new hash slot array, places all atoms into it and
+  publishes it. Replaced slot array is moved to retired list. Process mutex must be locked
+  when calling this function.
+
+  @param   nro_slots Number of hash slots, power of two.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void eatom_newslots(
+    os_int nro_slots)
+{
+    eAtomTable
+        *t;
+
+    eAtomSlots
+        *s,
+        *old;
+
+    os_memsz
+        sz;
+
+    os_int
+        atom,
+        i;
+
+    t = &eglobal->atoms;
+
+    sz = sizeof(eAtomSlots) + nro_slots * sizeof(os_int);
+    s = (eAtomSlots*)os_malloc(sz, OS_NULL);
+    os_memclear(s, sz);
+    s->alloc = sz;
+    s->slot_mask = nro_slots - 1;
+    s->slot = (volatile os_int*)((os_char*)s + sizeof(eAtomSlots));
+
+    for (atom = 1; atom < t->nro_atoms; atom++)
+    {
+        i = (os_int)(eatom_entry(atom)->hash & s->slot_mask);
+        while (s->slot[i]) i = (i + 1) & s->slot_mask;
+        s->slot[i] = atom;
+    }
+
+    /* Publish slot array. Contents are written before the pointer.
+     */
+    old = t->slots;
+    if (old)
+    {
+        old->next = t->retired;
+        t->retired = old;
+    }
+    eatomic_store_ptr((void*volatile*)&t->slots, s);
+}
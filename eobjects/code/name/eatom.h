@@ -0,0 +1,170 @@
+/**
+
+  @file    eatom.h
+  @brief   Process wide table of interned strings.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Short strings from bounded sets, like name space identifiers and property names, are 
+  interned into atoms. Object names are not interned, since these can be created dynamically
+  without limit. An atom is integer identifier which is stable for life time of the process: Same
+  string always gets the same atom, so strings can be compared by comparing atoms. Atoms are
+  never released, the table only grows. Looking up an atom or atom's string needs no locking.
+  Adding a new atom locks the process mutex. Atom table state is stored in eAtomTable
+  structure within eglobals.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EATOM_INCLUDED
+#define EATOM_INCLUDED
+
+/** Atom, interned string identifier.
+ */
+typedef os_int eAtom;
+
+/** Atom value zero marks "no atom". Name space identifiers are interned first when
+    the atom table is initialized, so these have fixed atom values.
+ */
+#define EATOM_NONE 0
+#define EATOM_PROCESS_NS 1
+#define EATOM_THREAD_NS 2
+#define EATOM_PARENT_NS 3
+#define EATOM_THIS_NS 4
+
+/** Atom entries are allocated in chunks which are never moved. Number of entries per chunk
+    (as bits) and maximum number of chunks.
+ */
+#define EATOM_CHUNK_BITS 10
+#define EATOM_CHUNK_SZ (1 << EATOM_CHUNK_BITS)
+#define EATOM_MAX_CHUNKS 1024
+
+/** Initial number of hash slots, must be power of two.
+ */
+#define EATOM_MIN_SLOTS 256
+
+
+/**
+****************************************************************************************************
+
+  @name Atom table structures.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/** One interned string.
+ */
+typedef struct eAtomEntry
+{
+    /** Hash of the string, same as ensindex_hash() returns.
+     */
+    os_uint hash;
+
+    /** String length in bytes, without terminating '\0'.
+     */
+    os_int len;
+
+    /** Pointer to '\0' terminated copy of the string.
+     */
+    os_char *str;
+}
+eAtomEntry;
+
+/** Open addressing hash slots by string hash. Immutable size, slot values are set with
+    atomic stores. Replaced as whole when more slots are needed.
+ */
+typedef struct eAtomSlots
+{
+    /** Next replaced slot array.
+     */
+    struct eAtomSlots *next;
+
+    /** Allocated size in bytes.
+     */
+    os_memsz alloc;
+
+    /** Hash slot mask (number of slots - 1).
+     */
+    os_int slot_mask;
+
+    /** Atom in slot, zero marks an empty slot.
+     */
+    volatile os_int *slot;
+}
+eAtomSlots;
+
+/** Atom table within eglobals.
+ */
+typedef struct eAtomTable
+{
+    /** Atom entry chunks, atom is index to entries.
+     */
+    eAtomEntry *volatile chunk[EATOM_MAX_CHUNKS];
+
+    /** Current hash slots.
+     */
+    eAtomSlots *volatile slots;
+
+    /** Replaced hash slots, which may still be accessed by readers. Released at shutdown.
+     */
+    eAtomSlots *retired;
+
+    /** Next free atom.
+     */
+    volatile os_int nro_atoms;
+}
+eAtomTable;
+
+/*@}*/
+
+
+/**
+****************************************************************************************************
+
+  @name Atom table functions.
+
+  String length argument -1 means that string is '\0' terminated.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/* Initialize atom table and intern name space identifiers.
+ */
+void eatom_initialize();
+
+/* Release memory allocated for atom table.
+ */
+void eatom_shutdown();
+
+/* Get atom for a string, add new atom if string has not been interned.
+ */
+eAtom eatom_intern(
+    const os_char *str,
+    os_memsz len = -1);
+
+/* Get atom for a string without locking, EATOM_NONE if not interned.
+ */
+eAtom eatom_find(
+    const os_char *str,
+    os_memsz len = -1);
+
+/* Get atom's string.
+ */
+const os_char *eatom_str(
+    eAtom atom);
+
+/* Get atom's string hash.
+ */
+os_uint eatom_hash(
+    eAtom atom);
+
+/*@}*/
+
+#endif
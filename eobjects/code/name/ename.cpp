@@ -41,6 +41,7 @@ eName::eName(
     clear_members();
     m_ns_type = E_PARENT_NS_TYPE;
     m_namespace_id = OS_NULL;
+    m_namespace_atom = EATOM_NONE;
 
 	/* If this is name space.
 	 */
@@ -117,6 +118,8 @@ void eName::clear_members()
 {
 	m_ileft = m_iright = m_iup = OS_NULL;
 	m_namespace = OS_NULL;
+    m_hash = 0;
+    m_atom = EATOM_NONE;
     m_is_process_ns = OS_FALSE;
     ixsetred();
 }
@@ -363,39 +366,83 @@ os_char *eName::namespaceid()
 void eName::setnamespaceid(
     const os_char *namespace_id)
 {
+    eAtom
+        atom;
+
     /* Clear old stuff if any
      */
     m_ns_type = E_PARENT_NS_TYPE;
+    m_namespace_atom = EATOM_NONE;
     if (m_namespace_id)
     {
         delete m_namespace_id;
         m_namespace_id = OS_NULL;
     }
 
-    if (namespace_id)
+    if (namespace_id == OS_NULL) return;
+
+    /* Well known name space identifiers have fixed atoms.
+     */
+    atom = eatom_intern(namespace_id);
+    switch (atom)
     {
-        if (!os_strcmp(namespace_id, E_PROCESS_NS))
-        {
+        case EATOM_PROCESS_NS:
             m_ns_type = E_PROCESS_NS_TYPE;
-        }
-        else if (!os_strcmp(namespace_id, E_THREAD_NS))
-        {
+            break;
+
+        case EATOM_THREAD_NS:
             m_ns_type = E_THREAD_NS_TYPE;
-        }
-        else if (!os_strcmp(namespace_id, E_PARENT_NS))
-        {
+            break;
+
+        case EATOM_PARENT_NS:
             m_ns_type = E_PARENT_NS_TYPE;
-        }
-        else if (!os_strcmp(namespace_id, eobj_this_ns))
-        {
+            break;
+
+        case EATOM_THIS_NS:
             m_ns_type = E_THIS_NS_TYPE;
-        }
-        else 
-        {
+            break;
+
+        default:
             m_ns_type = E_SPECIFIED_NS_TYPE;
-            m_namespace_id = new eVariable(this, EOID_CHILD, EOBJ_IS_ATTACHMENT);
+            m_namespace_atom = atom;
+            m_namespace_id = new (this) eVariable(this, EOID_CHILD, EOBJ_IS_ATTACHMENT);
             m_namespace_id->sets(namespace_id);
-        }
+            break;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get name space identifier as atom.
+
+  The eName::namespaceatom function returns name space identifier of the name as atom. 
+
+  @return  Name space identifier atom. EATOM_NONE if specified name space identifier could
+           not be interned.
+
+****************************************************************************************************
+*/
+eAtom eName::namespaceatom()
+{
+    switch (m_ns_type)
+    {
+        default:
+        case E_PARENT_NS_TYPE:  
+            return EATOM_PARENT_NS;
+
+        case E_PROCESS_NS_TYPE: 
+            return EATOM_PROCESS_NS;
+
+        case E_THREAD_NS_TYPE:  
+            return EATOM_THREAD_NS;
+
+        case E_THIS_NS_TYPE:    
+            return EATOM_THIS_NS;
+
+        case E_SPECIFIED_NS_TYPE:
+            return m_namespace_atom;
     }
 }
 
@@ -425,7 +472,7 @@ eStatus eName::mapname()
 
     /* Find name space to map to. If none, return error.
      */
-    ns = findnamespace(namespaceid(), &info);
+    ns = findnamespace_atom(namespaceatom(), &info);
     if (ns == OS_NULL) return ESTATUS_NAME_MAPPING_FAILED;
 
     return mapname2(ns, info);
@@ -464,6 +511,10 @@ eStatus eName::mapname2(
      */
     ns->ixrbtree_insert(this); 
 
+    /* Names in process name space are also added to lock free index.
+     */
+    if (m_is_process_ns) ensindex_insert(this);
+
     /* Finish with syncronization and return. 
      */
     if (m_is_process_ns) os_unlock();
@@ -495,6 +546,7 @@ void eName::detach()
     /* Insert name to name space's red black tree.
      */
     m_namespace->ixrbtree_remove(this); 
+    if (m_is_process_ns) ensindex_remove(this);
 
     /* Finish with syncronization. 
      */
@@ -101,7 +101,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eName(parent, id, flags);
+        return new (parent) eName(parent, id, flags);
     }
 
     /* Get next child name identified by oid.
@@ -155,6 +155,18 @@ public:
     void setnamespaceid(
         const os_char *namespace_id);
 
+    /* Get name space identifier as atom.
+     */
+    eAtom namespaceatom();
+
+    /** Get interned name, EATOM_NONE if name is not mapped to a name space, is not a string
+        or the string has not been interned. Names are not interned when mapped.
+     */
+    inline eAtom atom()
+    {
+        return m_atom;
+    }
+
     /* Map the name to a name space.
      */
     eStatus mapname();
@@ -199,6 +211,10 @@ protected:
      */
     eVariable *m_namespace_id;
 
+    /** Name space identifier as atom when m_ns_type is E_SPECIFIED_NS_TYPE.
+     */
+    eAtom m_namespace_atom;
+
 	/** Pointer to left child in index'es red/black tree.
      */
     eName *m_ileft;
@@ -214,6 +230,12 @@ protected:
 	/** Pointer to index.
      */
     eNameSpace *m_namespace;
+
+    /** Hash of the name string and atom if the string has been interned elsewhere, set 
+        when name is added to name space's hash index.
+     */
+    os_uint m_hash;
+    eAtom m_atom;
 };
 
 #endif
@@ -99,7 +99,11 @@ eNameSpace::eNameSpace(
 	}
 
     m_namespace_id = OS_NULL;
+    m_namespace_atom = EATOM_NONE;
     m_ixroot = OS_NULL;
+    m_ixhash = OS_NULL;
+    m_ixhash_sz = m_ixhash_n = 0;
+    m_ixnonstr = 0;
 }
 
 
@@ -134,6 +138,10 @@ eNameSpace::~eNameSpace()
         if (n->nspace()) n->detach();
     }
 
+    /* Release hash index, normally released already when last name was detached.
+     */
+    ixhash_resize(0);
+
 	/* If this is name space.
 	 */
 	if (oid() == EOID_NAMESPACE)
@@ -168,13 +176,14 @@ eObject *eNameSpace::clone(
     os_int aflags)
 {
     eNameSpace *clonedobj;
-    clonedobj = new eNameSpace(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eNameSpace(parent, id == EOID_CHILD ? oid() : id, flags());
 
     if (m_namespace_id)
     {
         clonedobj->m_namespace_id 
             = eVariable::cast(m_namespace_id->clone(clonedobj, EOID_CHILD, EOBJ_NO_MAP));
     }
+    clonedobj->m_namespace_atom = m_namespace_atom;
   
     /* Copy clonable attachments.
      */
@@ -258,6 +267,12 @@ eName *eNameSpace::findname(
         *n,
         *m;
 
+    os_char
+        *str;
+
+    os_memsz
+        sz;
+
 	os_int
 		c;
 
@@ -281,6 +296,23 @@ eName *eNameSpace::findname(
         return n;
     }
     
+    /* Exact string lookups use the hash index, unless there are names which are not 
+       strings and could match by number conversion.
+     */
+    if (x->type() == OS_STR && m_ixnonstr == 0) 
+    {
+        /* Mapped name with interned string, no need to hash the string.
+         */
+        if (x->classid() == ECLASSID_NAME)
+        {
+            m = eName::cast(x);
+            if (m->m_atom) return ixhash_find(m->m_hash, m->m_atom, OS_NULL);
+        }
+
+        str = x->gets(&sz);
+        return ixhash_find(ensindex_hash(str, sz - 1), EATOM_NONE, str);
+    }
+
     /* Handle normal case where child object is searched by exactly
        matching object identifier.
      */
@@ -320,6 +352,290 @@ eName *eNameSpace::findname(
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Get first name matching interned name.
+
+  The eNameSpace::findname_atom() function returns pointer to the first name, in red/black tree 
+  order, whose value is the atom's string. The look up compares atoms instead of strings.
+
+  @param   x Interned name to search for.
+  @return  Pointer to name, or OS_NULL if no matching name was found. 
+
+****************************************************************************************************
+*/
+eName *eNameSpace::findname_atom(
+    eAtom x)
+{
+    if (x == EATOM_NONE) return OS_NULL;
+
+    /* If there are names which are not strings, search the red/black tree.
+     */
+    if (m_ixnonstr)
+    {
+        eVariable v;
+        v.sets(eatom_str(x));
+        return findname(&v);
+    }
+
+    return ixhash_find(eatom_hash(x), x, OS_NULL);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Hash index: Add name to hash index.
+
+  The eNameSpace::ixhash_insert() function adds name to name space's hash index. The name
+  must have been inserted into red/black tree before this is called. Names are not interned,
+  since dynamic names would fill the atom table which is never released. If the name string
+  has already been interned, like a property name, it's atom is used to compare names.
+  Names which are not strings are only counted. If there is already a name with the same value in hash index, it 
+  is kept: Equal names are inserted to the right in red/black tree, so the existing one is 
+  first in tree order.
+
+  @param   n Pointer to the name to add.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eNameSpace::ixhash_insert(
+    eName *n)
+{
+    eName
+        *m;
+
+    os_char
+        *str;
+
+    os_memsz
+        sz;
+
+    os_int
+        i,
+        mask;
+
+    if (n->type() != OS_STR)
+    {
+        m_ixnonstr++;
+        return;
+    }
+
+    str = n->gets(&sz);
+    n->m_hash = ensindex_hash(str, sz - 1);
+    n->m_atom = eatom_find(str, sz - 1);
+
+    /* Keep load factor at or below one half.
+     */
+    if (2 * (m_ixhash_n + 1) > m_ixhash_sz)
+    {
+        ixhash_resize(m_ixhash_sz ? 2 * m_ixhash_sz : EINDEX_HASH_MIN_SZ);
+    }
+
+    mask = m_ixhash_sz - 1;
+    i = (os_int)(n->m_hash & mask);
+    while ((m = m_ixhash[i]))
+    {
+        if (ixhash_match(m, n->m_hash, n->m_atom, str)) return;
+        i = (i + 1) & mask;
+    }
+
+    m_ixhash[i] = n;
+    m_ixhash_n++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Hash index: Remove name from hash index.
+
+  The eNameSpace::ixhash_remove() function removes name from name space's hash index. This
+  must be called while the name is still in red/black tree. If the hash slot points to the 
+  name, it is replaced by next name with same value in tree order. If there is no such name, 
+  the slot is emptied and the following slots of the probe sequence are shifted back, so 
+  no deleted markers are needed.
+
+  @param   n Pointer to the name to remove.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eNameSpace::ixhash_remove(
+    eName *n)
+{
+    eName
+        *m;
+
+    os_int
+        i,
+        j,
+        k,
+        mask;
+
+    if (n->type() != OS_STR)
+    {
+        m_ixnonstr--;
+        return;
+    }
+
+    if (m_ixhash == OS_NULL) return;
+    mask = m_ixhash_sz - 1;
+
+    /* Find slot pointing to n. If slot has another name with same value, n is not 
+       first in tree order and there is nothing to do.
+     */
+    i = (os_int)(n->m_hash & mask);
+    while ((m = m_ixhash[i]) != n)
+    {
+        if (m == OS_NULL) return;
+        if (ixhash_match(m, n->m_hash, n->m_atom, n->gets())) return;
+        i = (i + 1) & mask;
+    }
+
+    /* If there is next name with same string value, make the slot point to it.
+     */
+    m = n->ns_next(OS_TRUE);
+    while (m)
+    {
+        if (m->type() == OS_STR && !os_strcmp(m->gets(), n->gets())) 
+        {
+            m_ixhash[i] = m;
+            return;
+        }
+        m = m->ns_next(OS_TRUE);
+    }
+
+    /* Release hash index when last name is removed.
+     */
+    if (--m_ixhash_n == 0)
+    {
+        ixhash_resize(0);
+        return;
+    }
+
+    /* Empty the slot and shift back names whose probe sequence passes through it.
+     */
+    j = i;
+    while (OS_TRUE)
+    {
+        j = (j + 1) & mask;
+        m = m_ixhash[j];
+        if (m == OS_NULL) break;
+
+        k = (os_int)(m->m_hash & mask);
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) continue;
+
+        m_ixhash[i] = m;
+        i = j;
+    }
+    m_ixhash[i] = OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Hash index: Find first name by hash and atom or string.
+
+  The eNameSpace::ixhash_find() function looks up a name from hash index. 
+
+  @param   hash Hash of the name string.
+  @param   atom Interned name to search for, EATOM_NONE to compare by string.
+  @param   str Name string to search for, OS_NULL if atom is given.
+  @return  Pointer to first name with matching value in red/black tree order, or OS_NULL if
+           none found.
+
+****************************************************************************************************
+*/
+eName *eNameSpace::ixhash_find(
+    os_uint hash,
+    eAtom atom,
+    const os_char *str)
+{
+    eName
+        *m;
+
+    os_int
+        i,
+        mask;
+
+    if (m_ixhash == OS_NULL) return OS_NULL;
+
+    mask = m_ixhash_sz - 1;
+    i = (os_int)(hash & mask);
+    while ((m = m_ixhash[i]))
+    {
+        if (ixhash_match(m, hash, atom, str)) return m;
+        i = (i + 1) & mask;
+    }
+
+    return OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Hash index: Reallocate hash index with new slot count.
+
+  The eNameSpace::ixhash_resize() function allocates new hash index and moves names from
+  old hash index to it. Slot count zero releases the hash index.
+
+  @param   sz New number of slots, power of two, or zero to release hash index.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eNameSpace::ixhash_resize(
+    os_int sz)
+{
+    eName
+        **oldhash,
+        *m;
+
+    os_int
+        oldsz,
+        i,
+        j,
+        mask;
+
+    oldhash = m_ixhash;
+    oldsz = m_ixhash_sz;
+    m_ixhash = OS_NULL;
+    m_ixhash_sz = 0;
+
+    if (sz > 0)
+    {
+        m_ixhash = (eName**)os_malloc(sz * sizeof(eName*), OS_NULL);
+        os_memclear(m_ixhash, sz * sizeof(eName*));
+        m_ixhash_sz = sz;
+        mask = sz - 1;
+
+        /* Names in old hash index have distinct values, so these can be placed without
+           comparing strings.
+         */
+        for (i = 0; i < oldsz; i++)
+        {
+            m = oldhash[i];
+            if (m == OS_NULL) continue;
+
+            j = (os_int)(m->m_hash & mask);
+            while (m_ixhash[j]) j = (j + 1) & mask;
+            m_ixhash[j] = m;
+        }
+    }
+    else
+    {
+        m_ixhash_n = 0;
+    }
+
+    if (oldhash) os_free(oldhash, oldsz * sizeof(eName*));
+}
+
+
 #if EINDEX_DBTREE_DEBUG
 /**
 ****************************************************************************************************
@@ -739,6 +1055,7 @@ void eNameSpace::ixrbtree_insert(
         inserted_node->m_iup = n;
     }
     ixinsert_case1(inserted_node);
+    ixhash_insert(inserted_node);
 
 #if EINDEX_DBTREE_DEBUG
     ixverify_properties();
@@ -889,6 +1206,10 @@ void eNameSpace::ixrbtree_remove(
         *child,
         *pred;
 
+    /* Remove from hash index first, tree order is needed to find next name with same value.
+     */
+    ixhash_remove(n);
+
     if (n->m_ileft != OS_NULL && n->m_iright != OS_NULL) 
     {
         /* Swap pred and n.
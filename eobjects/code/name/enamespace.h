@@ -22,6 +22,10 @@
  */
 #define EINDEX_DBTREE_DEBUG 0
 
+/* Initial number of slots in name space's hash index. Must be power of two.
+ */
+#define EINDEX_HASH_MIN_SZ 16
+
 /* Name space identifiers. These are followed by '/', thus for example path to thread looks like 
    "/myobject..." or process "//myobject".
  */
@@ -96,7 +100,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eNameSpace(parent, oid, flags);
+        return new (parent) eNameSpace(parent, oid, flags);
     } */
 
     /*@}*/
@@ -120,12 +124,40 @@ public:
         return m_namespace_id;
     }
 
-    /* Set name space id.
+    /* Set name space id. Value of nsid must be set before this call, it is interned to 
+       name space id atom.
      */
     inline void setnamespaceid(
         eVariable *nsid) 
     {
         m_namespace_id = nsid;
+        m_namespace_atom = (nsid && !nsid->isempty()) ? eatom_intern(nsid->gets()) : EATOM_NONE;
+    }
+
+    /* Get name space id as atom, EATOM_NONE if none.
+     */
+    inline eAtom namespaceatom() 
+    {
+        return m_namespace_atom;
+    }
+
+    /* Set name space id atom.
+     */
+    inline void setnamespaceatom(
+        eAtom nsatom) 
+    {
+        m_namespace_atom = nsatom;
+    }
+
+    /* Check if name space id matches atom. If name space id has no atom, for example because
+       it's value was modified after setnamespaceid(), strings are compared.
+     */
+    inline os_boolean namespacematch(
+        eAtom nsatom) 
+    {
+        if (m_namespace_atom) return (os_boolean)(m_namespace_atom == nsatom);
+        if (m_namespace_id == OS_NULL || nsatom == EATOM_NONE) return OS_FALSE;
+        return (os_boolean)!os_strcmp(m_namespace_id->gets(), eatom_str(nsatom));
     }
 
 	/* Get first child object with specific name.
@@ -133,14 +165,77 @@ public:
     eName *findname(
         eVariable *x = OS_NULL);
 
+	/* Get first child object with specific interned name.
+     */
+    eName *findname_atom(
+        eAtom x);
+
 
     /*@}*/
 
 protected:
+    /** Name space identifier as atom.
+     */
+    eAtom m_namespace_atom;
+
 	/** Pointer to root object of indexed variables.
      */
     eName *m_ixroot;
 
+    /** Open addressing hash index for exact string name lookups. Each slot points to first
+        name with the value in red/black tree order, OS_NULL marks empty slot.
+     */
+    eName **m_ixhash;
+
+    /** Number of slots in hash index, power of two or zero if not allocated.
+     */
+    os_int m_ixhash_sz;
+
+    /** Number of used slots in hash index.
+     */
+    os_int m_ixhash_n;
+
+    /** Number of mapped names which are not strings. While there are such names, string
+        lookups must use the red/black tree, since number compares may match.
+     */
+    os_int m_ixnonstr;
+
+    /* Hash index: Add name to hash index.
+     */
+    void ixhash_insert(
+        eName *n);
+
+    /* Hash index: Remove name from hash index.
+     */
+    void ixhash_remove(
+        eName *n);
+
+    /* Hash index: Check if name in hash slot matches. Interned names are compared by atom,
+       others by string.
+     */
+    inline os_boolean ixhash_match(
+        eName *m,
+        os_uint hash,
+        eAtom atom,
+        const os_char *str)
+    {
+        if (m->m_hash != hash) return OS_FALSE;
+        if (atom && m->m_atom) return (os_boolean)(m->m_atom == atom);
+        return (os_boolean)!os_strcmp(m->gets(), str ? str : eatom_str(atom));
+    }
+
+    /* Hash index: Find first name by hash and atom or string.
+     */
+    eName *ixhash_find(
+        os_uint hash,
+        eAtom atom,
+        const os_char *str);
+
+    /* Hash index: Reallocate hash index with new slot count.
+     */
+    void ixhash_resize(
+        os_int sz);
+
 	/** Check if object is "red". The function checks if the object n is tagged as "red"
 		in red/black tree.
      */
@@ -0,0 +1,654 @@
+/**
+
+  @file    ensindex.cpp
+  @brief   Read mostly index of process name space.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The process name space index allows any thread to find names in process name space without
+  locking the process mutex. The index is divided into shards by name hash. Each shard holds
+  an immutable snapshot, which is replaced as whole when a name is added to or removed from
+  the shard. Readers are tracked by epoch counters, so that old snapshots can be released once
+  no reader may be accessing them anymore. Index state is stored in eNsIndex structure within
+  eglobals.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+/* Forward referred static functions.
+ */
+static eNsIndexSnapshot *ensindex_build(
+    eNsIndexSnapshot *old,
+    eName *skip,
+    eNsIndexEntry *add,
+    const os_char *add_name,
+    const os_char *add_oixstr);
+
+static void ensindex_publish(
+    eNsIndexShard *shard,
+    eNsIndexSnapshot *old,
+    eNsIndexSnapshot *s);
+
+static os_boolean ensindex_try_advance(
+    eNsIndexShard *shard);
+
+static void ensindex_reclaim(
+    eNsIndexShard *shard,
+    os_boolean all);
+
+
+/**
+****************************************************************************************************
+
+  @brief Initialize process name space index.
+
+  The ensindex_initialize function marks all shards of process name space index empty.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_initialize()
+{
+    os_memclear(&eglobal->nsindex, sizeof(eNsIndex));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release memory allocated for process name space index.
+
+  The ensindex_shutdown function releases all snapshots, including retired ones. No thread
+  may be using the index when this function is called.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_shutdown()
+{
+    eNsIndexShard
+        *shard;
+
+    eNsIndexSnapshot
+        *s;
+
+    os_int
+        i;
+
+    for (i = 0; i < ENSINDEX_NRO_SHARDS; i++)
+    {
+        shard = eglobal->nsindex.shard + i;
+        ensindex_reclaim(shard, OS_TRUE);
+
+        s = shard->snapshot;
+        if (s) os_free(s, s->alloc);
+        shard->snapshot = OS_NULL;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Calculate hash for a name.
+
+  The ensindex_hash function calculates 32 bit FNV-1a hash of the name.
+
+  @param   name Pointer to name, does not need to be '\0' terminated.
+  @param   name_n Name length in bytes.
+  @return  Hash value.
+
+****************************************************************************************************
+*/
+os_uint ensindex_hash(
+    const os_char *name,
+    os_memsz name_n)
+{
+    os_uint
+        h;
+
+    h = 2166136261U;
+    while (name_n-- > 0)
+    {
+        h ^= (os_uchar)*(name++);
+        h *= 16777619U;
+    }
+    return h;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add name to process name space index.
+
+  The ensindex_insert function creates a new snapshot of the shard with the name added and
+  publishes it. Old snapshot is retired. Process mutex must be locked when calling this
+  function.
+
+  @param   name Name being mapped to process name space.
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_insert(
+    eName *name)
+{
+    eObject
+        *obj;
+
+    eNsIndexShard
+        *shard;
+
+    eNsIndexSnapshot
+        *old;
+
+    eNsIndexEntry
+        e;
+
+    os_char
+        *key,
+        buf[E_OIXSTR_BUF_SZ];
+
+    os_memsz
+        sz;
+
+    obj = name->parent();
+    if (obj == OS_NULL) return;
+
+    key = name->gets(&sz);
+    obj->oixstr(buf, sizeof(buf));
+
+    os_memclear(&e, sizeof(e));
+    e.name_n = (os_int)sz - 1;
+    e.hash = ensindex_hash(key, e.name_n);
+    e.name = name;
+    e.thread = obj->thread();
+    e.is_thread = (os_boolean)((eObject*)e.thread == obj);
+
+    shard = eglobal->nsindex.shard + (e.hash & (ENSINDEX_NRO_SHARDS - 1));
+    old = shard->snapshot;
+    ensindex_publish(shard, old, ensindex_build(old, OS_NULL, &e, key, buf));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Remove name from process name space index.
+
+  The ensindex_remove function creates a new snapshot of the shard without the name and
+  publishes it. Process mutex must be locked when calling this function.
+
+  @param   name Name being detached from process name space.
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_remove(
+    eName *name)
+{
+    eNsIndexShard
+        *shard;
+
+    eNsIndexSnapshot
+        *old;
+
+    os_char
+        *key;
+
+    os_memsz
+        sz;
+
+    os_int
+        first,
+        i,
+        j;
+
+    key = name->gets(&sz);
+    first = (os_int)(ensindex_hash(key, sz - 1) & (ENSINDEX_NRO_SHARDS - 1));
+
+    /* Look for the name in shard by hash first. If value of the name has been modified after
+       it was mapped, it could be in any shard.
+     */
+    for (j = 0; j <= ENSINDEX_NRO_SHARDS; j++)
+    {
+        shard = eglobal->nsindex.shard + (j ? j - 1 : first);
+        old = shard->snapshot;
+        if (old == OS_NULL) continue;
+
+        for (i = 0; i < old->nro_entries; i++)
+        {
+            if (old->entry[i].name == name)
+            {
+                ensindex_publish(shard, old, ensindex_build(old, name, OS_NULL, OS_NULL, OS_NULL));
+                return;
+            }
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Look up a name from process name space index.
+
+  The ensindex_lookup function finds a name from process name space index without locking.
+  The reader is registered to shard's current epoch, so that the snapshot and threads found
+  trough it remain valid until the guard is released.
+
+  @param   name Pointer to name to look for, does not need to be '\0' terminated.
+  @param   name_n Name length in bytes.
+  @param   hash Hash of the name, as returned by ensindex_hash().
+  @param   result Where to store information about the first matching name.
+  @param   guard Read guard, must always be released by ensindex_release().
+  @return  OS_TRUE if name was found, OS_FALSE if not.
+
+****************************************************************************************************
+*/
+os_boolean ensindex_lookup(
+    const os_char *name,
+    os_memsz name_n,
+    os_uint hash,
+    eNsIndexResult *result,
+    eNsIndexGuard *guard)
+{
+    eNsIndexShard
+        *shard;
+
+    eNsIndexSnapshot
+        *s;
+
+    eNsIndexEntry
+        *e;
+
+    os_char
+        *p;
+
+    os_int
+        k,
+        i,
+        j;
+
+    os_boolean
+        found;
+
+    ensindex_enter(hash, guard);
+    shard = guard->shard;
+
+    os_memclear(result, sizeof(eNsIndexResult));
+    s = (eNsIndexSnapshot*)eatomic_load_ptr((void*volatile*)&shard->snapshot);
+    if (s == OS_NULL) return OS_FALSE;
+
+    /* Go trough matching entries in order the names were added.
+     */
+    found = OS_FALSE;
+    k = (os_int)(hash & s->slot_mask);
+    while ((i = s->slot[k]))
+    {
+        e = s->entry + i - 1;
+        if (e->hash == hash && e->name_n == name_n)
+        {
+            p = s->str + e->name_pos;
+            for (j = 0; j < name_n; j++) if (p[j] != name[j]) break;
+            if (j == name_n)
+            {
+                if (!found)
+                {
+                    result->thread = e->thread;
+                    result->oixstr = s->str + e->oixstr_pos;
+                    result->is_thread = e->is_thread;
+                    found = OS_TRUE;
+                }
+                else if (e->thread != result->thread)
+                {
+                    result->multiple_threads = OS_TRUE;
+                    break;
+                }
+            }
+        }
+        k = (k + 1) & s->slot_mask;
+    }
+
+    return found;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Register as reader of a shard.
+
+  The ensindex_enter function registers the caller as reader of the shard, to which names 
+  with the hash belong to. While registered, threads found trough the shard are not deleted. 
+  This is used also to validate cached routes without looking up the name.
+
+  @param   hash Hash of the name, as returned by ensindex_hash().
+  @param   guard Pointer to read guard to set.
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_enter(
+    os_uint hash,
+    eNsIndexGuard *guard)
+{
+    eNsIndexShard
+        *shard;
+
+    os_int
+        epoch;
+
+    shard = eglobal->nsindex.shard + (hash & (ENSINDEX_NRO_SHARDS - 1));
+
+    /* Register as reader of current epoch. If epoch changed between reading it and
+       registering, try again.
+     */
+    while (OS_TRUE)
+    {
+        epoch = eatomic_load_int(&shard->epoch);
+        eatomic_add_int(&shard->readers[epoch & 1], 1);
+        if (eatomic_load_int(&shard->epoch) == epoch) break;
+        eatomic_add_int(&shard->readers[epoch & 1], -1);
+    }
+    guard->shard = shard;
+    guard->epoch = epoch;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release read guard.
+
+  The ensindex_release function unregisters reader from the epoch. Data found trough the
+  index must not be used after this call.
+
+  @param   guard Read guard set by ensindex_lookup().
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_release(
+    eNsIndexGuard *guard)
+{
+    if (guard->shard)
+    {
+        eatomic_add_int(&guard->shard->readers[guard->epoch & 1], -1);
+        guard->shard = OS_NULL;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Wait for readers.
+
+  The ensindex_synchronize function waits until all readers, which may have been using data
+  removed from the index before this call, are done. This is used before deleting a thread,
+  so that no other thread can be queuing messages to it trough pointer found from the index.
+  Process mutex must not be locked when calling this function.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void ensindex_synchronize()
+{
+    eNsIndexShard
+        *shard;
+
+    os_int
+        i,
+        target;
+
+    for (i = 0; i < ENSINDEX_NRO_SHARDS; i++)
+    {
+        shard = eglobal->nsindex.shard + i;
+
+        /* All readers which have started before this point are done once epoch
+           has advanced twice.
+         */
+        target = eatomic_load_int(&shard->epoch) + 2;
+        while (eatomic_load_int(&shard->epoch) - target < 0)
+        {
+            if (!ensindex_try_advance(shard)) os_sleep(1);
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Create new snapshot.
+
+  The ensindex_build function creates a new snapshot from old one, optionally skipping one
+  name and adding a new entry at end.
+
+  @param   old Old snapshot, OS_NULL if none.
+  @param   skip Name to leave out, OS_NULL if none.
+  @param   add Entry to add, OS_NULL if none. Name and object index string positions
+           are set by this function.
+  @param   add_name Name string for new entry.
+  @param   add_oixstr Object index string for new entry.
+  @return  Pointer to new snapshot, OS_NULL if snapshot would be empty.
+
+****************************************************************************************************
+*/
+static eNsIndexSnapshot *ensindex_build(
+    eNsIndexSnapshot *old,
+    eName *skip,
+    eNsIndexEntry *add,
+    const os_char *add_name,
+    const os_char *add_oixstr)
+{
+    eNsIndexSnapshot
+        *s;
+
+    eNsIndexEntry
+        *e,
+        *src;
+
+    os_memsz
+        sz,
+        strsz,
+        n;
+
+    os_int
+        nro_entries,
+        nslots,
+        pos,
+        i,
+        k;
+
+    /* Count entries and string pool size.
+     */
+    nro_entries = 0;
+    strsz = 0;
+    if (old) for (i = 0; i < old->nro_entries; i++)
+    {
+        src = old->entry + i;
+        if (src->name == skip) continue;
+        nro_entries++;
+        strsz += src->name_n + 1 + os_strlen(old->str + src->oixstr_pos);
+    }
+    if (add)
+    {
+        nro_entries++;
+        strsz += add->name_n + 1 + os_strlen(add_oixstr);
+    }
+    if (nro_entries == 0) return OS_NULL;
+
+    /* Keep hash table at most half full.
+     */
+    nslots = 4;
+    while (nslots < 2 * nro_entries) nslots <<= 1;
+
+    /* Allocate and set up the snapshot as one memory block.
+     */
+    sz = sizeof(eNsIndexSnapshot) + nro_entries * sizeof(eNsIndexEntry)
+        + nslots * sizeof(os_int) + strsz;
+    s = (eNsIndexSnapshot*)os_malloc(sz, OS_NULL);
+    os_memclear(s, sizeof(eNsIndexSnapshot));
+    s->alloc = sz;
+    s->slot_mask = nslots - 1;
+    s->entry = (eNsIndexEntry*)(s + 1);
+    s->slot = (os_int*)(s->entry + nro_entries);
+    s->str = (os_char*)(s->slot + nslots);
+    os_memclear(s->slot, nslots * sizeof(os_int));
+
+    /* Copy entries and strings, in order the names were added.
+     */
+    pos = 0;
+    for (i = 0; i <= (old ? old->nro_entries : 0); i++)
+    {
+        if (old && i < old->nro_entries)
+        {
+            src = old->entry + i;
+            if (src->name == skip) continue;
+            add_name = old->str + src->name_pos;
+            add_oixstr = old->str + src->oixstr_pos;
+        }
+        else
+        {
+            src = add;
+            if (src == OS_NULL) break;
+        }
+
+        e = s->entry + s->nro_entries;
+        *e = *src;
+        e->name_pos = pos;
+        os_memcpy(s->str + pos, add_name, e->name_n);
+        pos += e->name_n;
+        s->str[pos++] = '\0';
+        e->oixstr_pos = pos;
+        n = os_strlen(add_oixstr);
+        os_memcpy(s->str + pos, add_oixstr, n);
+        pos += (os_int)n;
+
+        /* Place entry to the first free hash slot.
+         */
+        k = (os_int)(e->hash & s->slot_mask);
+        while (s->slot[k]) k = (k + 1) & s->slot_mask;
+        s->slot[k] = ++(s->nro_entries);
+    }
+
+    return s;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Publish new snapshot.
+
+  The ensindex_publish function makes new snapshot visible to readers, retires the old one and
+  releases retired snapshots which can no longer be in use.
+
+  @param   shard Index shard.
+  @param   old Old snapshot, OS_NULL if none.
+  @param   s New snapshot, OS_NULL if shard becomes empty.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void ensindex_publish(
+    eNsIndexShard *shard,
+    eNsIndexSnapshot *old,
+    eNsIndexSnapshot *s)
+{
+    eatomic_store_ptr((void*volatile*)&shard->snapshot, s);
+    eatomic_add_int(&shard->generation, 1);
+
+    if (old)
+    {
+        old->retired_epoch = eatomic_load_int(&shard->epoch);
+        old->next_retired = shard->retired;
+        shard->retired = old;
+    }
+
+    /* Advance epoch if there are no readers of previous epoch, and release
+       snapshots retired two or more epochs ago.
+     */
+    if (ensindex_try_advance(shard)) ensindex_try_advance(shard);
+    ensindex_reclaim(shard, OS_FALSE);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Try to advance shard's epoch.
+
+  The ensindex_try_advance function moves shard to next epoch, if no reader is registered
+  to the previous epoch. This way readers are always registered to current or previous epoch.
+
+  @param   shard Index shard.
+  @return  OS_TRUE if epoch was advanced.
+
+****************************************************************************************************
+*/
+static os_boolean ensindex_try_advance(
+    eNsIndexShard *shard)
+{
+    os_int
+        epoch;
+
+    epoch = eatomic_load_int(&shard->epoch);
+    if (eatomic_load_int(&shard->readers[(epoch + 1) & 1])) return OS_FALSE;
+    return eatomic_cas_int(&shard->epoch, epoch, epoch + 1);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release retired snapshots.
+
+  The ensindex_reclaim function releases retired snapshots, which were retired at least
+  two epochs ago. No reader can be accessing these anymore.
+
+  @param   shard Index shard.
+  @param   all OS_TRUE to release all retired snapshots (shutdown).
+  @return  None.
+
+****************************************************************************************************
+*/
+static void ensindex_reclaim(
+    eNsIndexShard *shard,
+    os_boolean all)
+{
+    eNsIndexSnapshot
+        **pp,
+        *s;
+
+    os_int
+        epoch;
+
+    epoch = eatomic_load_int(&shard->epoch);
+    pp = &shard->retired;
+    while ((s = *pp))
+    {
+        if (all || epoch - s->retired_epoch >= 2)
+        {
+            *pp = s->next_retired;
+            os_free(s, s->alloc);
+        }
+        else
+        {
+            pp = &s->next_retired;
+        }
+    }
+}
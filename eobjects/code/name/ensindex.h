@@ -0,0 +1,247 @@
+/**
+
+  @file    ensindex.h
+  @brief   Read mostly index of process name space.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The process name space index allows any thread to find names in process name space without
+  locking the process mutex. The index is divided into shards by name hash. Each shard holds
+  an immutable snapshot, which is replaced as whole when a name is added to or removed from
+  the shard. Readers are tracked by epoch counters, so that old snapshots can be released once
+  no reader may be accessing them anymore. Index state is stored in eNsIndex structure within
+  eglobals.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef ENSINDEX_INCLUDED
+#define ENSINDEX_INCLUDED
+
+class eName;
+class eThread;
+
+/** Number of shards in process name space index, must be power of two.
+ */
+#define ENSINDEX_NRO_SHARDS 64
+
+
+/**
+****************************************************************************************************
+
+  @name Process name space index structures.
+
+  Snapshot is one memory allocation: eNsIndexSnapshot header, array of entries, hash slots
+  and string pool for names and object index strings.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/** One name in process name space index.
+ */
+typedef struct eNsIndexEntry
+{
+    /** Hash of the name.
+     */
+    os_uint hash;
+
+    /** Position of name and object index string "@oix_ucnt" within string pool.
+     */
+    os_int name_pos;
+    os_int oixstr_pos;
+
+    /** Name length in bytes, without terminating '\0'.
+     */
+    os_int name_n;
+
+    /** Pointer to eName object. Used only to identify entry when removing it,
+        readers must not access the eName object.
+     */
+    eName *name;
+
+    /** Thread to which the named object belongs to, OS_NULL if none.
+     */
+    eThread *thread;
+
+    /** OS_TRUE if named object is the thread itself.
+     */
+    os_boolean is_thread;
+}
+eNsIndexEntry;
+
+/** Immutable snapshot of names in one shard.
+ */
+typedef struct eNsIndexSnapshot
+{
+    /** Next retired snapshot waiting to be released.
+     */
+    struct eNsIndexSnapshot *next_retired;
+
+    /** Epoch when snapshot was retired.
+     */
+    os_int retired_epoch;
+
+    /** Number of entries and hash slot mask (number of slots - 1).
+     */
+    os_int nro_entries;
+    os_int slot_mask;
+
+    /** Allocated size in bytes.
+     */
+    os_memsz alloc;
+
+    /** Entries in order they were added.
+     */
+    eNsIndexEntry *entry;
+
+    /** Open addressing hash slots, entry index + 1. Zero marks an empty slot.
+     */
+    os_int *slot;
+
+    /** String pool.
+     */
+    os_char *str;
+}
+eNsIndexSnapshot;
+
+/** Process name space index shard.
+ */
+typedef struct eNsIndexShard
+{
+    /** Current snapshot, OS_NULL if shard is empty.
+     */
+    eNsIndexSnapshot *volatile snapshot;
+
+    /** Current epoch and number of active readers for odd and even epochs.
+     */
+    volatile os_int epoch;
+    volatile os_int readers[2];
+
+    /** List of retired snapshots, newest first. Accessed only with process mutex locked.
+     */
+    eNsIndexSnapshot *retired;
+
+    /** Generation counter, incremented whenever a name is added to or removed from the 
+        shard. Used to validate cached routes for names in the shard.
+     */
+    volatile os_int generation;
+
+    /** Padding to keep shards in separate cache lines.
+     */
+    os_char pad[28];
+}
+eNsIndexShard;
+
+/** Process name space index.
+ */
+typedef struct eNsIndex
+{
+    eNsIndexShard shard[ENSINDEX_NRO_SHARDS];
+}
+eNsIndex;
+
+/** Read guard, keeps shard's snapshot valid while reader is using it.
+ */
+typedef struct eNsIndexGuard
+{
+    eNsIndexShard *shard;
+    os_int epoch;
+}
+eNsIndexGuard;
+
+/** Result of name look up.
+ */
+typedef struct eNsIndexResult
+{
+    /** Thread to which the first matching named object belongs to. OS_NULL if none.
+     */
+    eThread *thread;
+
+    /** Object index string of first matching named object, like "@12_3". Valid only
+        until guard is released.
+     */
+    os_char *oixstr;
+
+    /** OS_TRUE if first matching named object is the thread itself.
+     */
+    os_boolean is_thread;
+
+    /** OS_TRUE if name is mapped to objects in more than one thread.
+     */
+    os_boolean multiple_threads;
+}
+eNsIndexResult;
+
+/*@}*/
+
+
+/**
+****************************************************************************************************
+
+  @name Process name space index functions.
+
+  Insert and remove are called by eName when mapping to or detaching from process name space,
+  with process mutex locked. Look up needs no locking.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/* Initialize process name space index.
+ */
+void ensindex_initialize();
+
+/* Release memory allocated for process name space index.
+ */
+void ensindex_shutdown();
+
+/* Calculate hash for a name.
+ */
+os_uint ensindex_hash(
+    const os_char *name,
+    os_memsz name_n);
+
+/* Add name to index, process mutex must be locked.
+ */
+void ensindex_insert(
+    eName *name);
+
+/* Remove name from index, process mutex must be locked.
+ */
+void ensindex_remove(
+    eName *name);
+
+/* Look up a name without locking. Guard must always be released by ensindex_release().
+ */
+os_boolean ensindex_lookup(
+    const os_char *name,
+    os_memsz name_n,
+    os_uint hash,
+    eNsIndexResult *result,
+    eNsIndexGuard *guard);
+
+/* Register as reader of the shard for a name hash without looking up a name. Guard must 
+   always be released by ensindex_release().
+ */
+void ensindex_enter(
+    os_uint hash,
+    eNsIndexGuard *guard);
+
+/* Release read guard.
+ */
+void ensindex_release(
+    eNsIndexGuard *guard);
+
+/* Wait until no reader can be using data removed from index before this call.
+ */
+void ensindex_synchronize();
+
+/*@}*/
+
+#endif
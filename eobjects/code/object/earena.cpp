@@ -0,0 +1,129 @@
+/**
+
+  @file    earena.cpp
+  @brief   Memory arena for object subtree.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Bump allocator owned by arena root object. See earena.h.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Constructor.
+
+  The eArena constructor creates empty arena. Memory blocks are allocated when needed.
+
+****************************************************************************************************
+*/
+eArena::eArena(
+	eObject *parent,
+    e_oid id,
+	os_int flags)
+    : eObject(parent, id, flags)
+{
+    m_prev = OS_NULL;
+    m_blocks = OS_NULL;
+    m_pos = OS_NULL;
+    m_n = 0;
+    m_nro_allocs = 0;
+    m_nro_bytes = 0;
+    m_nro_blocks = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Virtual destructor.
+
+  The eArena destructor releases all memory blocks of the arena at once. If the arena is still
+  active for the thread, previously active arena is restored.
+
+****************************************************************************************************
+*/
+eArena::~eArena()
+{
+    eArenaBlock
+        *b,
+        *next_b;
+
+    if (eslab_arena() == this)
+    {
+        eslab_setarena(m_prev);
+    }
+
+    for (b = m_blocks; b; b = next_b)
+    {
+        next_b = b->next;
+        os_free(b, b->sz);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate memory from arena.
+
+  The eArena::alloc function takes memory from current memory block by moving position
+  forward. If there is not enough space left, new block is allocated. Memory allocated from
+  arena is not freed individually, it is released when the arena is deleted.
+
+  @param   sz Number of bytes to allocate.
+  @return  Pointer to allocated memory, aligned to ESLAB_GRANULE.
+
+****************************************************************************************************
+*/
+os_char *eArena::alloc(
+    os_memsz sz)
+{
+    eArenaBlock
+        *b;
+
+    os_char
+        *p;
+
+    os_memsz
+        bsz;
+
+    sz = (sz + ESLAB_GRANULE - 1) & ~(os_memsz)(ESLAB_GRANULE - 1);
+    m_nro_allocs++;
+    m_nro_bytes += sz;
+
+    if (sz > m_n)
+    {
+        bsz = sz + ESLAB_HEADER_SZ;
+        if (bsz < EARENA_BLOCK_SZ) bsz = EARENA_BLOCK_SZ;
+
+        b = (eArenaBlock*)os_malloc(bsz, OS_NULL);
+        b->next = m_blocks;
+        b->sz = bsz;
+        m_blocks = b;
+        m_nro_blocks++;
+
+        /* Object larger than block gets block of it's own, keep using current block.
+         */
+        p = (os_char*)b + ESLAB_HEADER_SZ;
+        if (bsz > EARENA_BLOCK_SZ) return p;
+
+        m_pos = p;
+        m_n = bsz - ESLAB_HEADER_SZ;
+    }
+
+    p = m_pos;
+    m_pos += sz;
+    m_n -= sz;
+    return p;
+}
@@ -0,0 +1,137 @@
+/**
+
+  @file    earena.h
+  @brief   Memory arena for object subtree.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Large object trees, like received compositions or big container result sets, are created
+  once and deleted as a whole. Object subtree can be marked as arena root by calling
+  eObject::beginarena(). Until eObject::endarena() is called, memory for objects created by
+  the thread with new (parent), when the parent is arena root or itself from the arena, is
+  carved from the arena's memory blocks by bumping a pointer. Other objects, like envelopes,
+  get memory from slab cache. Objects allocated from arena are flagged, see eslab_isarena().
+
+  When arena root's children are deleted, destructors are called only for objects, which do
+  have something to release (see eObject::trivialdestructor()). Handles of other objects are
+  returned to global handle pool in one call and arena's memory blocks are freed at once.
+
+  Objects allocated from arena must stay within arena root's subtree. eObject::adopt() accepts
+  arena object only as child of the arena root or of other object from the same arena.
+  Envelopes do not adopt arena objects as content, these are copied, and arena envelopes are
+  neither pooled nor queued to other threads. Memory of an object deleted individually is
+  released with the arena. Arena memory is used only with slab allocator, see
+  E_SLAB_ALLOCATOR.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EARENA_INCLUDED
+#define EARENA_INCLUDED
+
+/** Size of memory block allocated for arena at once. Larger objects get block of their own.
+ */
+#define EARENA_BLOCK_SZ 65536
+
+/** Memory block header, blocks of an arena are linked trough next pointer. Header size is
+    ESLAB_HEADER_SZ to keep objects aligned.
+ */
+typedef struct eArenaBlock
+{
+    struct eArenaBlock *next;
+    os_memsz sz;
+}
+eArenaBlock;
+
+
+/**
+****************************************************************************************************
+
+  @brief Arena class.
+
+  The eArena is attachment of arena root object, which owns memory blocks of the arena.
+
+****************************************************************************************************
+*/
+class eArena : public eObject
+{
+    /**
+    ************************************************************************************************
+
+      @name Generic object functionality.
+
+      These functions enable using objects of this class as generic eObjects.
+
+    ************************************************************************************************
+    */
+    /*@{*/
+public:
+	/* Constructor.
+     */
+	eArena(
+		eObject *parent = OS_NULL,
+        e_oid id = EOID_ARENA,
+		os_int flags = EOBJ_DEFAULT);
+
+	/* Virtual destructor.
+     */
+	virtual ~eArena();
+
+    /* Casting eObject pointer to eArena pointer.
+     */
+	inline static eArena *cast(
+		eObject *o)
+	{
+        e_assert_type(o, ECLASSID_ARENA)
+		return (eArena*)o;
+	}
+
+    /* Get class identifier.
+     */
+    virtual os_int classid() {return ECLASSID_ARENA;}
+    /*@}*/
+
+
+	/**
+	************************************************************************************************
+
+	  @name Arena specific
+
+	************************************************************************************************
+	*/
+	/*@{*/
+
+    /* Allocate memory from arena.
+     */
+    os_char *alloc(
+        os_memsz sz);
+
+    /** Arena which was active for the thread before this one, see eObject::beginarena().
+     */
+    eArena *m_prev;
+
+    /** Number of allocations, bytes allocated and memory blocks.
+     */
+    os_long m_nro_allocs;
+    os_long m_nro_bytes;
+    os_int m_nro_blocks;
+
+    /*@}*/
+
+protected:
+    /** Memory blocks allocated for this arena.
+     */
+    eArenaBlock *m_blocks;
+
+    /** Unused space in current memory block.
+     */
+    os_char *m_pos;
+    os_memsz m_n;
+};
+
+#endif
@@ -166,6 +166,7 @@ void eclasslist_initialize()
     eEnvelope::setupclass(); 
     ePropertyBinding::setupclass();
     eTimer::setupclass(); 
+    eRequest::setupclass();
     eQueue::setupclass(); 
     eBuffer::setupclass();
     eTable::setupclass();
@@ -188,6 +189,7 @@ void eclasslist_initialize()
 */
 void eclasslist_release()
 {
+    eproptable_shutdown();
     delete eglobal->root;
     delete eglobal->empty;
 }
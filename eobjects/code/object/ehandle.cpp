@@ -62,6 +62,28 @@
 */
 #include "eobjects/eobjects.h"
 
+/* Child array memory is taken from slab allocator's size classes, if used, so that adding
+   the first child doesn't need os_malloc() call.
+ */
+static inline eHandleChildArray *ehandle_childarray_alloc()
+{
+#if E_SLAB_ALLOCATOR
+    return (eHandleChildArray*)eslab_alloc(sizeof(eHandleChildArray));
+#else
+    return (eHandleChildArray*)os_malloc(sizeof(eHandleChildArray), OS_NULL);
+#endif
+}
+
+static inline void ehandle_childarray_free(
+    eHandleChildArray *a)
+{
+#if E_SLAB_ALLOCATOR
+    eslab_free(a);
+#else
+    os_free(a, sizeof(eHandleChildArray));
+#endif
+}
+
 
 /**
 ****************************************************************************************************
@@ -69,7 +91,9 @@
   @brief Get number of children.
 
   The eHandle::childcount() function returns pointer number of children. Argument oid specified
-  wether to count attachment in or to count children only with specific id.
+  wether to count attachment in or to count children only with specific id. Number of all 
+  children and number of attachments are maintained, so counting with EOID_CHILD or EOID_ALL
+  doesn't need to walk trough children.
 
   @param   id Object idenfifier. Default value EOID_CHILD specifies to count a child objects,
 		   which are not flagged as an attachment. Value EOID_ALL specifies to get count all 
@@ -90,6 +114,9 @@ os_long eHandle::childcount(
     eHandle
         *child;
 
+    if (id == EOID_ALL) return m_nchildren;
+    if (id == EOID_CHILD) return m_nchildren - m_nattachments;
+
     count = 0;
 
     for (child = first(id);
@@ -128,6 +155,13 @@ eHandle *eHandle::first(
         *n,
         *m;
 
+    /* If children are in child array.
+     */
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        return array_find(0, 1, id, OS_FALSE);
+    }
+
     /* Set n to point root of child object's red/black tree.
      */
     n = m_children;
@@ -219,6 +253,13 @@ eHandle *eHandle::last(
         *n,
         *m;
 
+    /* If children are in child array.
+     */
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        return array_find(m_nchildren - 1, -1, id, OS_FALSE);
+    }
+
 	/* Set n to point root of child object's red/black tree.
 	*/
 	n = m_children;
@@ -311,6 +352,13 @@ eHandle *eHandle::next(
         *n,
         *m;
 
+    /* If this object is in parent's child array, m_up is the parent.
+     */
+    if (m_oflags & EOBJ_IN_ARRAY)
+    {
+        return m_up->array_find(m_up->array_index(this) + 1, 1, id, OS_TRUE);
+    }
+
     n = this;
 
 try_again:
@@ -378,6 +426,13 @@ eHandle *eHandle::prev(
         *n,
         *m;
 
+    /* If this object is in parent's child array, m_up is the parent.
+     */
+    if (m_oflags & EOBJ_IN_ARRAY)
+    {
+        return m_up->array_find(m_up->array_index(this) - 1, -1, id, OS_TRUE);
+    }
+
     n = this;
 
 try_again:
@@ -439,6 +494,12 @@ void eHandle::delete_children()
 		*n,
 		*p;
 
+    eHandleChildArray
+        *a;
+
+    os_int
+        i;
+
     enum direc
     {
         EH_FROM_UP,
@@ -450,6 +511,31 @@ void eHandle::delete_children()
 	n = m_children;
 	if (n == OS_NULL) return;
 
+    /* Arena root's children are deleted without calling trivial destructors.
+     */
+    if (m_oflags & EOBJ_ARENA_ROOT)
+    {
+        delete_arena_children();
+        return;
+    }
+
+    /* If children are in child array, delete them in order.
+     */
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        a = m_child_array;
+        for (i = 0; i < m_nchildren; i++)
+        {
+            n = a->handle[i];
+		    n->m_oflags |= EOBJ_FAST_DELETE;
+		    delete n->m_object;
+            m_root->freehandle(n);
+        }
+        ehandle_childarray_free(a);
+        m_oflags &= ~EOBJ_CHILD_ARRAY;
+        goto done;
+    }
+
 	while (OS_TRUE)
 	{
         p = OS_NULL;
@@ -473,11 +559,420 @@ void eHandle::delete_children()
 		    delete n->m_object;
             m_root->freehandle(n);
 
-            if (p == OS_NULL) return;
+            if (p == OS_NULL) break;
             direc = (p->m_left == n) ? EH_FROM_LEFT : EH_FROM_RIGHT;
 		}
 		n = p;
     }
+
+done:
+    m_children = OS_NULL;
+    m_nchildren = m_nattachments = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Delete all child objects of arena root.
+
+  The eHandle::delete_arena_children() function deletes all children of arena root object, see
+  eObject::beginarena(). Subtree is walked breadth first. Objects allocated from arena, which
+  have trivial destructor, are not destructed: Their children are walked and their handles are
+  collected to be released to global handle pool in one call. Other objects are deleted
+  normally together with their children. Finally the arena is deleted, which frees all
+  arena memory at once.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eHandle::delete_arena_children()
+{
+    eHandle
+        **list,
+        **newlist,
+        *h,
+        *c,
+        *arena_h,
+        *chain;
+
+    eObject
+        *obj;
+
+    os_int
+        alloc,
+        n,
+        i;
+
+    alloc = 64;
+    list = (eHandle**)os_malloc(alloc * sizeof(eHandle*), OS_NULL);
+    n = i = 0;
+    arena_h = OS_NULL;
+    h = this;
+
+    while (h)
+    {
+        /* Append children of h to list. The arena is deleted last.
+         */
+        for (c = h->first(EOID_ALL); c; c = c->next(EOID_ALL))
+        {
+            if (h == this && c->m_oid == EOID_ARENA)
+            {
+                arena_h = c;
+                continue;
+            }
+
+            if (n >= alloc)
+            {
+                newlist = (eHandle**)os_malloc(2 * alloc * sizeof(eHandle*), OS_NULL);
+                os_memcpy(newlist, list, alloc * sizeof(eHandle*));
+                os_free(list, alloc * sizeof(eHandle*));
+                list = newlist;
+                alloc *= 2;
+            }
+            list[n++] = c;
+        }
+
+        /* Find next object to walk trough. Objects which need destructor are deleted
+           normally and removed from list. Nested arena roots release their own arenas.
+         */
+        h = OS_NULL;
+        while (i < n)
+        {
+            c = list[i];
+            obj = c->m_object;
+#if E_SLAB_ALLOCATOR
+            if ((c->m_oflags & EOBJ_ARENA_ROOT) == 0 &&
+                eslab_isarena(obj) &&
+                obj->trivialdestructor())
+            {
+                h = c;
+                i++;
+                break;
+            }
+#endif
+		    c->m_oflags |= EOBJ_FAST_DELETE;
+		    delete obj;
+            m_root->freehandle(c);
+            list[i++] = OS_NULL;
+        }
+    }
+
+    /* Link handles of objects which were not destructed and release them in one call.
+     */
+    chain = OS_NULL;
+    for (i = n - 1; i >= 0; i--)
+    {
+        c = list[i];
+        if (c == OS_NULL) continue;
+
+        if (c->m_oflags & EOBJ_CHILD_ARRAY)
+        {
+            ehandle_childarray_free(c->m_child_array);
+        }
+        c->m_root = OS_NULL;
+        c->m_object = OS_NULL;
+        c->ucnt_mark_unused();
+        c->m_right = chain;
+        chain = c;
+    }
+    os_free(list, alloc * sizeof(eHandle*));
+    if (chain) ehandleroot_releasehandles(chain, 0);
+
+    /* Delete the arena, this releases all arena memory.
+     */
+    if (arena_h)
+    {
+        arena_h->m_oflags |= EOBJ_FAST_DELETE;
+        delete arena_h->m_object;
+        m_root->freehandle(arena_h);
+    }
+
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        ehandle_childarray_free(m_child_array);
+    }
+    m_children = OS_NULL;
+    m_nchildren = m_nattachments = 0;
+    m_oflags &= ~(EOBJ_CHILD_ARRAY|EOBJ_ARENA_ROOT);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add child object.
+
+  The eHandle::insertchild() function adds a child object to this object. Up to 
+  EHANDLE_CHILD_ARRAY_SZ children are kept in child array sorted by object identifier. When
+  the child array is full, children are moved to red/black tree.
+
+  The this pointer points to the parent object in eobjects object hierarcy.
+
+  @param   h Pointer to handle of child object to add.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eHandle::insertchild(
+    eHandle *h)
+{
+    eHandleChildArray
+        *a;
+
+    os_int
+        i;
+
+    /* If this is the first child, allocate child array.
+     */
+    if (m_children == OS_NULL)
+    {
+        m_child_array = ehandle_childarray_alloc();
+        m_oflags |= EOBJ_CHILD_ARRAY;
+    }
+
+    /* If children are in child array.
+     */
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        /* If child array is not full, insert the child after children with same or 
+           smaller object identifier.
+         */
+        if (m_nchildren < EHANDLE_CHILD_ARRAY_SZ)
+        {
+            a = m_child_array;
+            i = m_nchildren;
+            while (i > 0 && a->oid[i - 1] > h->m_oid)
+            {
+                a->oid[i] = a->oid[i - 1];
+                a->handle[i] = a->handle[i - 1];
+                i--;
+            }
+            a->oid[i] = h->m_oid;
+            a->handle[i] = h;
+
+            h->m_left = h->m_right = OS_NULL;
+            h->m_up = this;
+            h->m_oflags |= EOBJ_IN_ARRAY;
+            goto count;
+        }
+
+        /* Child array is full, move children to red/black tree.
+         */
+        promote_children();
+    }
+
+    rbtree_insert(h);
+
+count:
+    m_nchildren++;
+    if (h->m_oflags & EOBJ_IS_ATTACHMENT) m_nattachments++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Remove child object.
+
+  The eHandle::removechild() function removes a child object from child array or from 
+  red/black tree. Once children have been moved to red/black tree, they stay there until
+  the last child is removed.
+
+  @param   h Pointer to handle of child object to remove.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eHandle::removechild(
+    eHandle *h)
+{
+    eHandleChildArray
+        *a;
+
+    os_int
+        i;
+
+    if (h->m_oflags & EOBJ_IS_ATTACHMENT) m_nattachments--;
+
+    if (h->m_oflags & EOBJ_IN_ARRAY)
+    {
+        a = m_child_array;
+        for (i = array_index(h) + 1; i < m_nchildren; i++)
+        {
+            a->oid[i - 1] = a->oid[i];
+            a->handle[i - 1] = a->handle[i];
+        }
+        m_nchildren--;
+
+        h->m_up = OS_NULL;
+        h->m_oflags &= ~EOBJ_IN_ARRAY;
+
+        /* If this was the last child, release child array.
+         */
+        if (m_nchildren == 0)
+        {
+            ehandle_childarray_free(a);
+            m_children = OS_NULL;
+            m_oflags &= ~EOBJ_CHILD_ARRAY;
+        }
+        return;
+    }
+
+    m_nchildren--;
+    rbtree_remove(h);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Move children from child array to red/black tree.
+
+  The eHandle::promote_children() function is called when child array is full. Children are 
+  inserted to red/black tree in order and child array is released.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eHandle::promote_children()
+{
+    eHandleChildArray
+        *a;
+
+    eHandle
+        *h;
+
+    os_int
+        i;
+
+    a = m_child_array;
+    m_children = OS_NULL;
+    m_oflags &= ~EOBJ_CHILD_ARRAY;
+
+    for (i = 0; i < m_nchildren; i++)
+    {
+        h = a->handle[i];
+        h->m_oflags = (h->m_oflags & ~EOBJ_IN_ARRAY) | EOBJ_IS_RED;
+        h->m_left = h->m_right = h->m_up = OS_NULL;
+        rbtree_insert(h);
+    }
+
+    ehandle_childarray_free(a);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find position of child in child array.
+
+  The eHandle::array_index() function finds index of child handle h in this object's child
+  array. The child must be in the array.
+
+  @param   h Pointer to child handle.
+  @return  Index in child array.
+
+****************************************************************************************************
+*/
+os_int eHandle::array_index(
+    eHandle *h)
+{
+    eHandleChildArray
+        *a;
+
+    os_int
+        i;
+
+    a = m_child_array;
+    for (i = 0; a->handle[i] != h; i++);
+
+#if EOBJECT_DBTREE_DEBUG
+    osal_debug_assert(i < m_nchildren);
+#endif
+
+    return i;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find child in child array.
+
+  The eHandle::array_find() function searches this object's child array for child matching
+  object identifier id, starting from index i and moving to direction given by step.
+
+  @param   i Index to start from, may be out of range.
+  @param   step 1 to search forward, -1 to search backwards.
+  @param   id Object identifier, EOID_CHILD or EOID_ALL, see eHandle::first().
+  @param   immediate If OS_TRUE and id is specific object identifier, only the child at
+           index i is checked. This is used by next() and prev().
+  @return  Pointer to child handle, or OS_NULL if no matching child was found.
+
+****************************************************************************************************
+*/
+eHandle *eHandle::array_find(
+    os_int i,
+    os_int step,
+    e_oid id,
+    os_boolean immediate)
+{
+    eHandleChildArray
+        *a;
+
+    eHandle
+        *h;
+
+    a = m_child_array;
+    while (i >= 0 && i < m_nchildren)
+    {
+        h = a->handle[i];
+        if (id == EOID_ALL) return h;
+        if (id == EOID_CHILD) 
+        {
+            if (!h->isattachment()) return h;
+        }
+        else if (a->oid[i] == id) 
+        {
+            return h;
+        }
+        else if (immediate || (step > 0 ? a->oid[i] > id : a->oid[i] < id))
+        {
+            return OS_NULL;
+        }
+        i += step;
+    }
+
+    return OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Update parent's attachment count.
+
+  The eHandle::countattachment() function is called when EOBJ_IS_ATTACHMENT flag of this
+  object is set or cleared, to keep parent's attachment count up to date.
+
+  @param   delta 1 if object became an attachment, -1 if not anymore.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eHandle::countattachment(
+    os_int delta)
+{
+    eObject
+        *parent;
+
+    if (m_object == OS_NULL) return;
+    parent = m_object->mm_parent;
+    if (parent == OS_NULL) return;
+    if (parent->mm_handle) parent->mm_handle->m_nattachments += delta;
 }
 
 
@@ -781,10 +1276,21 @@ void eHandle::verify_whole_tree()
 void eHandle::verify_node(
     eRoot *root)
 {
-    if (m_left) osal_debug_assert(m_left->m_up == this);
-    if (m_right) osal_debug_assert(m_right->m_up == this);
-    if (m_up) osal_debug_assert(m_up->m_left == this || m_up->m_right == this);
-    if (m_children) osal_debug_assert(m_children->m_object->mm_parent == this->m_object);
+    if (m_oflags & EOBJ_IN_ARRAY)
+    {
+        osal_debug_assert(m_up->m_oflags & EOBJ_CHILD_ARRAY);
+        osal_debug_assert(m_object->mm_parent == m_up->m_object);
+    }
+    else
+    {
+        if (m_left) osal_debug_assert(m_left->m_up == this);
+        if (m_right) osal_debug_assert(m_right->m_up == this);
+        if (m_up) osal_debug_assert(m_up->m_left == this || m_up->m_right == this);
+    }
+    if (m_children && (m_oflags & EOBJ_CHILD_ARRAY) == 0) 
+    {
+        osal_debug_assert(m_children->m_object->mm_parent == this->m_object);
+    }
     osal_debug_assert(m_object->mm_handle == this);
     osal_debug_assert(m_root == root);
 }        
@@ -817,9 +1323,26 @@ void eHandle::verify_children(
     } 
     direc = EH_FROM_UP; 
 
+    os_int
+        i;
+
 	n = m_children;
 	if (n == OS_NULL) return;
 
+    if (m_oflags & EOBJ_CHILD_ARRAY)
+    {
+        osal_debug_assert(m_nchildren > 0 && m_nchildren <= EHANDLE_CHILD_ARRAY_SZ);
+        for (i = 0; i < m_nchildren; i++)
+        {
+            n = m_child_array->handle[i];
+            osal_debug_assert(n->m_oid == m_child_array->oid[i]);
+            if (i) osal_debug_assert(m_child_array->oid[i - 1] <= n->m_oid);
+            n->verify_node(root);
+            n->verify_children(root);
+        }
+        return;
+    }
+
 	while (OS_TRUE)
 	{
         p = OS_NULL;
@@ -36,6 +36,7 @@ class eNameSpace;
 class eName;
 class eRoot;
 class ePointer;
+class eHandle;
 
 
 /**
@@ -68,6 +69,23 @@ the treee structure after deletion. This changes deleting object trees from Nlog
  */
 #define EOBJ_FAST_DELETE   0x20000000
 
+/** Internal flags for small child arrays: EOBJ_CHILD_ARRAY is set for parent when children 
+    are in child array instead of red/black tree. EOBJ_IN_ARRAY is set for child which is in 
+    parent's child array.
+ */
+#define EOBJ_CHILD_ARRAY   0x10000000
+#define EOBJ_IN_ARRAY      0x08000000
+
+/** Internal flag EOBJ_ARENA_ROOT is set for object which owns memory arena for it's subtree,
+    see eObject::beginarena().
+ */
+#define EOBJ_ARENA_ROOT    0x04000000
+
+/** Internal flag EOBJ_ARENA_MEMORY is set for object which memory is allocated from arena,
+    see eslab_isarena().
+ */
+#define EOBJ_ARENA_MEMORY  0x02000000
+
 /** Red/black tree's red or black node bit.
  */
 #define EOBJ_IS_RED        0x40000000
@@ -87,6 +105,22 @@ the treee structure after deletion. This changes deleting object trees from Nlog
 /*@}*/
 
 
+/** Maximum number of children in child array. When more children are added, children are
+    moved to red/black tree.
+ */
+#define EHANDLE_CHILD_ARRAY_SZ 8
+
+/** Child array. Most objects have only a few children, these are kept in contiguous array
+    of (oid, handle) pairs sorted by oid. Equal oids are in insertion order, same as in 
+    red/black tree. Number of used entries is parent handle's m_nchildren.
+ */
+typedef struct eHandleChildArray
+{
+    e_oid oid[EHANDLE_CHILD_ARRAY_SZ];
+    eHandle *handle[EHANDLE_CHILD_ARRAY_SZ];
+}
+eHandleChildArray;
+
 
 /**
 ****************************************************************************************************
@@ -104,6 +138,8 @@ class eHandle
 	friend class eHandleTable;
 	friend class eRoot;
 	friend class ePointer;
+	friend class eThread;
+	friend class eMessageBatch;
 
 public:
 
@@ -125,11 +161,13 @@ public:
         return m_oflags;
     }
 
-    /** Set specified object flags.
+    /** Set specified object flags. If attachment flag changes, parent's attachment count 
+        is updated.
      */
     inline void setflags(
 		os_int flags)
     {
+        if (flags & ~m_oflags & EOBJ_IS_ATTACHMENT) countattachment(1);
         m_oflags |= flags;
     }
 
@@ -138,6 +176,7 @@ public:
     inline void clearflags(
 		os_int flags)
     {
+        if (flags & m_oflags & EOBJ_IS_ATTACHMENT) countattachment(-1);
         m_oflags &= ~flags;
     }
 
@@ -193,10 +232,11 @@ public:
     }
 	
 	/** Get reuse counter. If reuse counter is unused (negative), mark used and icrement.
+        Reuse counter is written atomically, since other threads read it without locking.
      */
     inline os_int ucnt() 
     {
-        if (m_ucnt<=0) m_ucnt = -m_ucnt + 1; 
+        if (m_ucnt<=0) eatomic_store_int((volatile os_int*)&m_ucnt, -m_ucnt + 1); 
         return m_ucnt;
     }
 
@@ -205,7 +245,7 @@ public:
      */
     inline void ucnt_mark_unused() 
     {
-        if (m_ucnt>0) m_ucnt = -m_ucnt; 
+        if (m_ucnt>0) eatomic_store_int((volatile os_int*)&m_ucnt, -m_ucnt); 
     }
 
     /** Get object pointer.
@@ -259,6 +299,34 @@ public:
         m_right = h;
     }
 
+    /* First handle of a batch of free handles in global handle pool holds object index + 1 of 
+       first handle of next batch (0 if none), last handle in this batch and number of handles
+       in this batch. Next batch is stored as integer, so that it can be read without 
+       dereferencing anything from a batch which other thread may have just popped. Up, oid and 
+       nchildren fields are not otherwise used by free handles.
+     */
+    inline void setbatch(os_uint next_batch_top, eHandle *last, e_oix n)
+    {
+        eatomic_store_int(&m_nchildren, (os_int)next_batch_top);
+        m_up = last;
+        m_oid = (e_oid)n;
+    }
+
+    inline os_uint nextbatchtop()
+    {
+        return (os_uint)eatomic_load_int(&m_nchildren);
+    }
+
+    inline eHandle *batchlast()
+    {
+        return m_up;
+    }
+
+    inline e_oix batchcount()
+    {
+        return (e_oix)m_oid;
+    }
+
 	/** Save object identifier, clear flags, mark new node as red,
 		not part of object hierarcy, nor no children yet.
      */
@@ -270,6 +338,9 @@ public:
         m_oid = id;
 		m_oflags = EOBJ_IS_RED | flags;
 		m_object = obj;
+        m_left = m_right = m_up = OS_NULL;
+        m_children = OS_NULL;
+        m_nchildren = m_nattachments = 0;
     }
 
     /* Verify whole object tree.
@@ -397,6 +468,42 @@ protected:
      */
     void delete_children();
 
+	/* Delete all child objects of arena root.
+     */
+    void delete_arena_children();
+
+	/* Add child object to child array or to red/black tree.
+     */
+    void insertchild(
+        eHandle *h);
+
+	/* Remove child object from child array or from red/black tree.
+     */
+    void removechild(
+        eHandle *h);
+
+	/* Move children from child array to red/black tree.
+     */
+    void promote_children();
+
+	/* Find position of child in child array.
+     */
+    os_int array_index(
+        eHandle *h);
+
+	/* Find child in child array.
+     */
+    eHandle *array_find(
+        os_int i,
+        os_int step,
+        e_oid id,
+        os_boolean immediate);
+
+	/* Update attachment count of parent when attachment flag changes.
+     */
+    void countattachment(
+        os_int delta);
+
 	/* Red/Black tree: Rotate tree left.
      */
     void rotate_left(
@@ -457,7 +564,7 @@ protected:
      */
 	e_oix m_oix;
 	
-    /** Reuse counter (other theads can access this).
+    /** Reuse counter (other theads can access this without locking, see eget_handle_check()).
      */
 	os_int m_ucnt;
 
@@ -477,7 +584,7 @@ protected:
      */
     eHandle *m_right;
 
-	/** Parent in red/black tree.
+	/** Parent in red/black tree. If this handle is in parent's child array, parent handle.
      */
     eHandle *m_up;
 
@@ -490,9 +597,21 @@ protected:
      */
     eRoot *m_root;
 
-	/** Root child object handle in red/black tree.
+    union
+    {
+	    /** Root child object handle in red/black tree.
+         */
+        eHandle *m_children;
+
+	    /** Child array, if EOBJ_CHILD_ARRAY flag is set.
+         */
+        eHandleChildArray *m_child_array;
+    };
+
+    /** Number of child objects and number of attachments among those.
      */
-    eHandle *m_children;
+    os_int m_nchildren;
+    os_int m_nattachments;
 };
 
 #endif
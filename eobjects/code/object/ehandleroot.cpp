@@ -18,6 +18,36 @@
 ****************************************************************************************************
 */
 #include "eobjects/eobjects.h"
+#if E_HUGEPAGE_HANDLE_TABLES
+#include <sys/mman.h>
+
+/* Huge page size.
+ */
+#define EHANDLEROOT_HUGEPAGE_SZ (2*1024*1024)
+#endif
+
+
+/* Forward referred static functions.
+ */
+static void ehandleroot_pushbatch(
+    eHandleRoot *hroot,
+    eHandle *first,
+    eHandle *last,
+    e_oix n);
+
+static eHandle *ehandleroot_popbatch(
+    eHandleRoot *hroot);
+
+static os_boolean ehandleroot_newtable(
+    eHandleRoot *hroot);
+
+static os_boolean ehandleroot_addtable(
+    eHandleRoot *hroot);
+
+#if E_HUGEPAGE_HANDLE_TABLES
+static void ehandleroot_reservehugepages(
+    eHandleRoot *hroot);
+#endif
 
 
 /**
@@ -34,7 +64,11 @@
 void ehandleroot_initialize()
 {
     eglobal->hroot.m_nrotables = 0;
-    eglobal->hroot.m_first_free = OS_NULL;
+    eglobal->hroot.m_free_batches = 0;
+
+#if E_HUGEPAGE_HANDLE_TABLES
+    ehandleroot_reservehugepages(&eglobal->hroot);
+#endif
 }
 
 
@@ -65,10 +99,56 @@ void ehandleroot_shutdown()
     hroot = &eglobal->hroot;
     table = hroot->m_table;
     n = hroot->m_nrotables;
+
+#if E_HUGEPAGE_HANDLE_TABLES
+    /* If handle tables are in huge pages, release whole address space at once.
+     */
+    if (hroot->m_hugepages)
+    {
+        munmap(hroot->m_hugepages_map, (size_t)hroot->m_hugepages_map_sz);
+        hroot->m_hugepages = OS_NULL;
+        n = 0;
+    }
+#endif
+
     for (i = 0; i < n; i++) 
         delete table[i];
     hroot->m_nrotables = 0;
-    hroot->m_first_free = OS_NULL;
+    hroot->m_free_batches = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate handle tables in advance.
+
+  The ehandleroot_presize function allocates handle tables for known number of objects at 
+  startup, so that handle tables do not need to be allocated while the application runs. Each
+  handle table holds EHANDLE_HANDLE_MAX + 1 handles. This should be called after 
+  eobjects_initialize().
+
+  @param   nro_tables Number of handle tables needed, at most EHANDLE_TABLE_MAX tables
+           are allocated.
+  @return  None.
+
+****************************************************************************************************
+*/
+void ehandleroot_presize(
+    os_int nro_tables)
+{
+    eHandleRoot
+        *hroot;
+
+    hroot = &eglobal->hroot;
+    if (nro_tables > EHANDLE_TABLE_MAX) nro_tables = EHANDLE_TABLE_MAX;
+
+    os_lock();
+    while (hroot->m_nrotables < nro_tables)
+    {
+        if (!ehandleroot_addtable(hroot)) break;
+    }
+    os_unlock();
 }
 
 
@@ -82,49 +162,42 @@ void ehandleroot_shutdown()
   a time to make threads's handle's closer to each others in memory to take better advantage of 
   processor cache.
 
+  Handles are taken from global pool as whole batches without locking, so number of handles
+  reserved may be larger than requested.
+
   @param   nro_handles Number of handles to reserve, >= 1.
+  @param   nro_reserved Pointer where to store number of handles actually reserved.
   @return  Pointer to first handle in linked list of allocated handles to be returned.
 
 ****************************************************************************************************
 */
 eHandle *ehandleroot_reservehandles(
-	e_oix nro_handles)
+	e_oix nro_handles,
+    e_oix *nro_reserved)
 {
     eHandleRoot
         *hroot;
 
-    eHandleTable
-        *htable;
-
     eHandle 
         *newchain = OS_NULL,
         *last_h = OS_NULL,
         *h;
 
-    hroot = &eglobal->hroot;
+    e_oix
+        n = 0;
 
-	/* Synchronize while handling global free handles
-	 */
-    os_lock();
+    hroot = &eglobal->hroot;
 
-    while (nro_handles-- > 0)
+    while (n < nro_handles)
     {
-        if (hroot->m_first_free == OS_NULL)
-        {
-            if (hroot->m_nrotables > EHANDLE_TABLE_MAX) 
-            {
-                osal_debug_error("Maximum eHandle limit reached");
-                return OS_NULL;
-            }
-            htable = new eHandleTable(hroot->m_nrotables * (EHANDLE_HANDLE_MAX + 1) /* + 1 */);
-			hroot->m_first_free = htable->firsthandle();
-			hroot->m_table[hroot->m_nrotables++] = htable;
-		}
-
-        /* Take of from current chain.
+        /* Pop batch of free handles. If global pool is empty, allocate new handle table.
          */
-        h = hroot->m_first_free;
-        hroot->m_first_free = h->right();
+        h = ehandleroot_popbatch(hroot);
+        if (h == OS_NULL)
+        {
+            if (!ehandleroot_newtable(hroot)) break;
+            continue;
+        }
 
         /* Add to new chain
          */
@@ -136,13 +209,13 @@ eHandle *ehandleroot_reservehandles(
         {
             last_h->setright(h);
         }
-        last_h = h;
+        last_h = h->batchlast();
+        n += h->batchcount();
     }
 
 	if (last_h) last_h->setright(OS_NULL);
 
-    os_unlock();
-
+    *nro_reserved = n;
     return newchain;
 }
 
@@ -153,7 +226,8 @@ eHandle *ehandleroot_reservehandles(
   @brief Release handles from thread or another root object.
 
   The ehandleroot_releasehandles releases handles reserved by thread to common list of free handles
-  in handle tables.
+  in handle tables. Handles are pushed to global pool in batches of EHANDLEROOT_BATCH_SZ handles
+  without locking.
 
   @param   h Pointer to first handle in linked list of handles to release.
   @param   nro_handles Maximum number of handles to release, >= 1. 0 to release all handles  in 
@@ -168,31 +242,273 @@ eHandle *ehandleroot_releasehandles(
 {
 	eHandle
 		*first_to_keep,
+		*batch_first,
 		*last_to_join;
 
-    /* Find out last handle to join to globally free handles and first handle to keep
-       reserved for a root object. 
-     */
+    e_oix
+        n;
+
 	first_to_keep = h;
-	last_to_join = OS_NULL;
 	if (nro_handles == 0) nro_handles = ~(e_oix)0;
-	while (nro_handles-- != 0 && first_to_keep)
+	while (nro_handles != 0 && first_to_keep)
 	{
-		last_to_join = first_to_keep;
-        last_to_join->ucnt_mark_unused();
-		first_to_keep = first_to_keep->right();
-	}
-
-	/* Synchronize while handling global free handles.
-	*/
-	os_lock();
-	if (last_to_join) 
-    {   last_to_join->setright(eglobal->hroot.m_first_free);
-	    eglobal->hroot.m_first_free = h;
+        /* Find out last handle to join to this batch.
+         */
+        batch_first = first_to_keep;
+    	last_to_join = OS_NULL;
+        n = 0;
+	    while (nro_handles != 0 && first_to_keep && n < EHANDLEROOT_BATCH_SZ)
+	    {
+		    last_to_join = first_to_keep;
+            last_to_join->ucnt_mark_unused();
+		    first_to_keep = first_to_keep->right();
+            nro_handles--;
+            n++;
+	    }
+
+        last_to_join->setright(OS_NULL);
+        ehandleroot_pushbatch(&eglobal->hroot, batch_first, last_to_join, n);
     }
-	os_unlock();
 
 	/* Return pointer to first eHandle to keep allocated for the thread.
  	 */
 	return first_to_keep;
 }
+
+
+/**
+****************************************************************************************************
+
+  @brief Push batch of handles to global pool.
+
+  The ehandleroot_pushbatch function adds linked list of free handles to top of lock free
+  stack of free handle batches.
+
+  @param   hroot Pointer to handle root.
+  @param   first First handle in batch, handles are linked by right pointer.
+  @param   last Last handle in batch.
+  @param   n Number of handles in batch.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void ehandleroot_pushbatch(
+    eHandleRoot *hroot,
+    eHandle *first,
+    eHandle *last,
+    e_oix n)
+{
+    os_long
+        top,
+        newtop;
+
+    os_uint
+        tag;
+
+    do
+    {
+        top = eatomic_load_long(&hroot->m_free_batches);
+        first->setbatch((os_uint)top, last, n);
+        tag = ((os_uint)(top >> 32) + 1) & 0x7FFFFFFF;
+        newtop = ((os_long)tag << 32) | (os_long)(first->oix() + 1);
+    }
+    while (!eatomic_cas_long(&hroot->m_free_batches, top, newtop));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Pop batch of handles from global pool.
+
+  The ehandleroot_popbatch function removes batch of free handles from top of lock free stack.
+  Next batch may be read from batch which has just been popped by other thread, but then 
+  modification count in top has changed and compare and swap fails. Next batch is read as
+  integer from the batch head, so nothing is dereferenced trough it before compare and swap.
+
+  @param   hroot Pointer to handle root.
+  @return  Pointer to first handle of the batch, OS_NULL if global pool is empty.
+
+****************************************************************************************************
+*/
+static eHandle *ehandleroot_popbatch(
+    eHandleRoot *hroot)
+{
+    eHandle
+        *h;
+
+    os_long
+        top,
+        newtop;
+
+    os_uint
+        tag;
+
+    do
+    {
+        top = eatomic_load_long(&hroot->m_free_batches);
+        if ((os_uint)top == 0) return OS_NULL;
+        h = eget_handle((os_uint)top - 1);
+        tag = ((os_uint)(top >> 32) + 1) & 0x7FFFFFFF;
+        newtop = ((os_long)tag << 32) | (os_long)h->nextbatchtop();
+    }
+    while (!eatomic_cas_long(&hroot->m_free_batches, top, newtop));
+
+    return h;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate new handle table when global pool is empty.
+
+  The ehandleroot_newtable function allocates a new handle table and pushes it's handles to
+  global pool as batches. Allocation is synchronized, if other thread has meanwhile added 
+  handles to pool, new table is not allocated.
+
+  @param   hroot Pointer to handle root.
+  @return  OS_TRUE if successfull, OS_FALSE if maximum number of handle tables has been reached.
+
+****************************************************************************************************
+*/
+static os_boolean ehandleroot_newtable(
+    eHandleRoot *hroot)
+{
+    os_boolean
+        rval;
+
+	/* Synchronize while allocating handle tables.
+	 */
+    os_lock();
+    rval = OS_TRUE;
+    if ((os_uint)eatomic_load_long(&hroot->m_free_batches) == 0)
+    {
+        rval = ehandleroot_addtable(hroot);
+    }
+    os_unlock();
+
+    return rval;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate new handle table.
+
+  The ehandleroot_addtable function allocates a new handle table and pushes it's handles to
+  global pool as batches. If huge pages are used, the table is constructed in reserved address 
+  space and memory gets committed when handles are initialized. The caller must hold os_lock().
+
+  @param   hroot Pointer to handle root.
+  @return  OS_TRUE if successfull, OS_FALSE if maximum number of handle tables has been reached.
+
+****************************************************************************************************
+*/
+static os_boolean ehandleroot_addtable(
+    eHandleRoot *hroot)
+{
+    eHandleTable
+        *htable;
+
+    eHandle 
+        *h;
+
+    e_oix
+        oix;
+
+    os_int
+        i;
+
+    if (hroot->m_nrotables >= EHANDLE_TABLE_MAX) 
+    {
+        osal_debug_error("Maximum eHandle limit reached");
+        return OS_FALSE;
+    }
+
+    oix = hroot->m_nrotables * (EHANDLE_HANDLE_MAX + 1);
+#if E_HUGEPAGE_HANDLE_TABLES
+    if (hroot->m_hugepages)
+    {
+        htable = new (hroot->m_hugepages + hroot->m_nrotables * sizeof(eHandleTable)) 
+            eHandleTable(oix);
+    }
+    else
+#endif
+    {
+        htable = new eHandleTable(oix);
+    }
+
+    /* Store table pointer before incrementing number of tables, lock free 
+       eget_handle_check() relies on this.
+     */
+    eatomic_store_ptr((void*volatile*)&hroot->m_table[hroot->m_nrotables], htable);
+    eatomic_store_int((volatile os_int*)&hroot->m_nrotables, hroot->m_nrotables + 1);
+
+    /* Push handles to global pool in batches, the last batch first so that handles are 
+       reserved in order. Lock is held so that other threads do not allocate tables meanwhile.
+     */
+    for (i = (EHANDLE_HANDLE_MAX + 1) - EHANDLEROOT_BATCH_SZ; i >= 0; i -= EHANDLEROOT_BATCH_SZ)
+    {
+        h = htable->firsthandle() + i;
+        h[EHANDLEROOT_BATCH_SZ - 1].setright(OS_NULL);
+        ehandleroot_pushbatch(hroot, h, h + EHANDLEROOT_BATCH_SZ - 1, EHANDLEROOT_BATCH_SZ);
+    }
+
+    return OS_TRUE;
+}
+
+
+#if E_HUGEPAGE_HANDLE_TABLES
+/**
+****************************************************************************************************
+
+  @brief Reserve address space for handle tables from huge pages.
+
+  The ehandleroot_reservehugepages function reserves address space for maximum number of
+  handle tables. Memory is not committed (MAP_NORESERVE), so unused tables cost nothing. 
+  Address space is aligned to huge page boundary and marked for transparent huge pages. If
+  reservation fails, for example on 32 bit system, handle tables are allocated with new.
+
+  @param   hroot Pointer to handle root.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void ehandleroot_reservehugepages(
+    eHandleRoot *hroot)
+{
+    os_memsz
+        sz;
+
+    void
+        *p;
+
+    os_char
+        *aligned;
+
+    hroot->m_hugepages = OS_NULL;
+    sz = (os_memsz)sizeof(eHandleTable) * (EHANDLE_TABLE_MAX + 1);
+    sz += EHANDLEROOT_HUGEPAGE_SZ;
+    if (sizeof(void*) < 8) return;
+
+    p = mmap(OS_NULL, (size_t)sz, PROT_READ|PROT_WRITE, 
+        MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) 
+    {
+        osal_debug_error("ehandleroot: huge page reservation failed");
+        return;
+    }
+
+    aligned = (os_char*)(((os_memsz)p + EHANDLEROOT_HUGEPAGE_SZ - 1) 
+        & ~(os_memsz)(EHANDLEROOT_HUGEPAGE_SZ - 1));
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, (size_t)(sz - EHANDLEROOT_HUGEPAGE_SZ), MADV_HUGEPAGE);
+#endif
+
+    hroot->m_hugepages = aligned;
+    hroot->m_hugepages_map = p;
+    hroot->m_hugepages_map_sz = sz;
+}
+#endif
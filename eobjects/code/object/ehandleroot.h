@@ -26,6 +26,11 @@ class eHandleTable;
  */
 #define EHANDLE_TABLE_MAX 0x1FFF
 
+/** Number of handles in a batch of free handles in global handle pool. Handles are
+    reserved and released in batches, a batch may be smaller when a root object is deleted.
+ */
+#define EHANDLEROOT_BATCH_SZ 64
+
 /**
 ****************************************************************************************************
 
@@ -35,11 +40,17 @@ class eHandleTable;
   list of free handles, which are not reserved for any root object. There is one handle root
   object per process.
 
+  Free handles are kept as lock free stack of handle batches. Top of the stack holds object 
+  index of first handle of the top batch + 1 in low 32 bits (0 if stack is empty) and 
+  modification count in high bits. The modification count protects against ABA problem:
+  Handle memory is never freed, so batch can be popped and pushed back while other thread
+  is trying to pop it. The global lock is taken only when a new handle table is allocated.
+
 ****************************************************************************************************
 */
 typedef struct eHandleRoot
 {
-    /** Array of handle table pointers. Index is from 0 to EHANDLE_TABLE_MAX.
+    /** Array of handle table pointers. At most EHANDLE_TABLE_MAX tables are allocated.
      */
     eHandleTable *m_table[EHANDLE_TABLE_MAX+1];
 
@@ -47,9 +58,21 @@ typedef struct eHandleRoot
      */
     os_int m_nrotables;
 
-    /* First free common handle (not reserved for any root object) in handle tables.
+    /* Top of stack of free handle batches (not reserved for any root object).
+     */
+    volatile os_long m_free_batches;
+
+#if E_HUGEPAGE_HANDLE_TABLES
+    /* Address space reserved for all handle tables, 2MB aligned. OS_NULL if huge page
+       allocation is not available and tables are allocated with new.
      */
-    eHandle *m_first_free;
+    os_char *m_hugepages;
+
+    /* Memory pointer and size returned by mmap().
+     */
+    void *m_hugepages_map;
+    os_memsz m_hugepages_map_sz;
+#endif
 }
 eHandleRoot;
 
@@ -74,10 +97,16 @@ void ehandleroot_initialize();
  */
 void ehandleroot_shutdown();
 
+/* Allocate handle tables in advance for known number of objects.
+ */
+void ehandleroot_presize(
+    os_int nro_tables);
+
 /* Reserve handles for thread or another root object.
  */
 eHandle *ehandleroot_reservehandles(
-    e_oix nro_handles);
+    e_oix nro_handles,
+    e_oix *nro_reserved);
 
 /* Release handles from thread or another root object.
  */
@@ -43,6 +43,33 @@ class eHandleTable
 public:
     eHandleTable(e_oix oix);
 
+    inline void* operator new(
+        size_t size)
+    {
+        return ::operator new(size);
+    }
+
+    inline void operator delete(
+        void *buf)
+    {
+        ::operator delete(buf);
+    }
+
+    /* Placement new, construct handle table in memory reserved from huge pages.
+     */
+    inline void* operator new(
+        size_t size,
+        void *buf)
+    {
+        return buf;
+    }
+
+    inline void operator delete(
+        void *buf,
+        void *hugepage_buf)
+    {
+    }
+
     inline eHandle *firsthandle() {return m_handle;}
 
     /* Handle table xontent.
@@ -99,6 +99,9 @@ eObject::eObject(
 
 			root = parent->mm_handle->m_root;
             root->newhandle(this, parent, id, flags);
+#if E_SLAB_ALLOCATOR
+            if (eslab_claimarena(this)) mm_handle->setflags(EOBJ_ARENA_MEMORY);
+#endif
 		}
 	}
 }
@@ -181,7 +184,7 @@ eObject::~eObject()
             } */
             if (mm_parent)
             {
-                mm_parent->mm_handle->rbtree_remove(mm_handle);
+                mm_parent->mm_handle->removechild(mm_handle);
             }
 
             /* Handle no longer needed.
@@ -296,13 +299,14 @@ eObject *eObject::newobject(
 }
 
 
-#if EOVERLOAD_NEW_AND_DELETE
+#if EOVERLOAD_NEW_AND_DELETE || E_SLAB_ALLOCATOR
 /**
 ****************************************************************************************************
 
   @brief Overloaded new operator.
 
-  The new operator maps object memory allocation to OSAL function os_malloc().
+  The new operator maps object memory allocation to thread local slab allocator, or to OSAL 
+  function os_malloc() if slab allocator is not used.
 
   @param   size Number of bytes to allocate.
   @return  Pointer to allocated memory block.
@@ -312,6 +316,9 @@ eObject *eObject::newobject(
 void *eObject::operator new(
 	size_t size)
 {
+#if E_SLAB_ALLOCATOR
+    return eslab_alloc((os_memsz)size);
+#else
 	os_char *buf;
 		
 	size += sizeof(os_memsz);
@@ -320,16 +327,46 @@ void *eObject::operator new(
 	*(os_memsz*)buf = (os_memsz)size;
 
 	return buf + sizeof(os_memsz);
+#endif
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief New operator for child object.
+
+  The new (parent) operator is used to allocate memory for object which will be created as
+  child of parent. If calling thread has active arena and the parent is arena root or has
+  been allocated from the arena, memory is taken from the arena. Otherwise this is the same
+  as new operator without parent.
+
+  @param   size Number of bytes to allocate.
+  @param   parent Parent object, OS_NULL if none.
+  @return  Pointer to allocated memory block.
+
+****************************************************************************************************
+*/
+void *eObject::operator new(
+	size_t size,
+    eObject *parent)
+{
+#if E_SLAB_ALLOCATOR
+    return eslab_alloc_child((os_memsz)size, parent);
+#else
+    return eObject::operator new(size);
+#endif
 }
 #endif
 
-#if EOVERLOAD_NEW_AND_DELETE
+#if EOVERLOAD_NEW_AND_DELETE || E_SLAB_ALLOCATOR
 /**
 ****************************************************************************************************
 
   @brief Overloaded delete operator.
 
-  The delete operator maps freeing object memory to OSAL function os_free().
+  The delete operator maps freeing object memory to slab allocator or to OSAL function 
+  os_free().
 
   @param   buf Pointer to memory block to free.
   @return  None.
@@ -339,15 +376,105 @@ void *eObject::operator new(
 void eObject::operator delete(
 	void *buf)
 {
+#if E_SLAB_ALLOCATOR
+    eslab_free(buf);
+#else
 	if (buf)
 	{
 		buf = (os_char*)buf - sizeof(os_memsz);
 		os_free(buf, *(os_memsz*)buf);
 	}
+#endif
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Delete operator matching new (parent).
+
+  This is called only if constructor of object allocated with new (parent) fails.
+
+  @param   buf Pointer to memory block to free.
+  @param   parent Not used.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eObject::operator delete(
+	void *buf,
+    eObject *parent)
+{
+    eObject::operator delete(buf);
 }
 #endif
 
 
+/**
+****************************************************************************************************
+
+  @brief Start allocating objects from this object's arena.
+
+  The eObject::beginarena() function marks this object as arena root, creates arena attachment
+  if it doesn't exist and sets it as calling thread's active arena. Objects created by the
+  thread with new (parent) within this object's subtree after this are allocated from the 
+  arena, until endarena() is called. Calls for the same object may not be nested.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eObject::beginarena()
+{
+    eArena
+        *arena;
+
+    if (mm_handle == OS_NULL) return;
+
+    arena = eArena::cast(first(EOID_ARENA));
+    if (arena == OS_NULL)
+    {
+        /* Arena object itself is allocated from slab cache, not from another arena.
+         */
+        arena = new eArena(this, EOID_ARENA,
+            EOBJ_IS_ATTACHMENT | EOBJ_NOT_CLONABLE | EOBJ_NOT_SERIALIZABLE);
+        setflags(EOBJ_ARENA_ROOT);
+    }
+
+    if (eslab_arena() != arena)
+    {
+        arena->m_prev = eslab_setarena(arena);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Stop allocating objects from this object's arena.
+
+  The eObject::endarena() function restores arena which was active before beginarena() call.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eObject::endarena()
+{
+    eArena
+        *arena;
+
+    arena = eArena::cast(first(EOID_ARENA));
+    if (arena == OS_NULL) return;
+
+    if (eslab_arena() == arena)
+    {
+        eslab_setarena(arena->m_prev);
+        arena->m_prev = OS_NULL;
+    }
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -671,10 +798,14 @@ eObject *eObject::prev(
   @brief Adopt obeject as child.
 
   The eObject::adopt() function moves on object from it's position in tree structure to
-  an another. 
+  an another. Object allocated from memory arena can be adopted only within the same arena,
+  since the arena memory is released when arena root is deleted. Such adopt is rejected
+  and the object is left where it was, see earena.h.
   
   @param   id EOID_CHILD object identifier unchanged.
   @param   aflags EOBJ_BEFORE_THIS Adopt before this object. EOBJ_NO_MAP not to map names.
+           EOBJ_NO_SYNC Internal: child has been detached from it's tree and is owned only by
+           the calling thread, no synchronization needed even if adopting between trees.
   @return  None.
 
 ****************************************************************************************************
@@ -684,9 +815,12 @@ void eObject::adopt(
     e_oid id,
     os_int aflags)
 {
-    os_boolean sync;
+    os_boolean sync, newroot;
     eHandle *childh;
     os_int mapflags;
+#if E_SLAB_ALLOCATOR
+    eArena *arena;
+#endif
 
     /* Make sure that parent object is already part of tree structure.
      */
@@ -695,6 +829,21 @@ void eObject::adopt(
         osal_debug_error("adopt(): parent object is not part of tree");
 		return;
     }
+
+#if E_SLAB_ALLOCATOR
+    /* Arena object may not be moved outside it's arena: This object must be the arena
+       root or allocated from the same arena.
+     */
+    arena = eslab_arenaof(child);
+    if (arena)
+    {
+        if (arena->parent() != this && eslab_arenaof(this) != arena)
+        {
+            osal_debug_error("adopt(): arena object can not be adopted outside arena");
+            return;
+        }
+    }
+#endif
     
     if (child->mm_handle == OS_NULL)
     {
@@ -716,9 +865,11 @@ void eObject::adopt(
 
         childh = child->mm_handle;
 
-        /* Synchronize if adopting from three structure to another.
+        /* Synchronize if adopting from three structure to another. A detached child
+           (EOBJ_NO_SYNC) is not visible to other threads and needs no synchronization.
          */
-        sync = (mm_handle->m_root != childh->m_root);
+        newroot = (os_boolean)(mm_handle->m_root != childh->m_root);
+        sync = (os_boolean)(newroot && (aflags & EOBJ_NO_SYNC) == 0);
 
         if (sync) 
         {
@@ -726,9 +877,13 @@ void eObject::adopt(
         }
 
         /* Detach names of child object and it's childen from name spaces 
-           above this object in tree structure.
+           above this object in tree structure. Detached child's names have already
+           been detached.
          */
-        child->map(E_DETACH_FROM_NAMESPACES_ABOVE);
+        if ((aflags & EOBJ_NO_SYNC) == 0)
+        {
+            child->map(E_DETACH_FROM_NAMESPACES_ABOVE);
+        }
 
         /* if (childh->m_parent)
         {
@@ -736,7 +891,7 @@ void eObject::adopt(
         } */
         if (child->mm_parent)
         {
-            child->mm_parent->mm_handle->rbtree_remove(childh);
+            child->mm_parent->mm_handle->removechild(childh);
 
         }
 
@@ -745,7 +900,7 @@ void eObject::adopt(
         if (id != EOID_CHILD) childh->m_oid = id;
 		childh->m_oflags |= EOBJ_IS_RED;
 		childh->m_left = childh->m_right = childh->m_up = OS_NULL;
-		mm_handle->rbtree_insert(childh);
+		mm_handle->insertchild(childh);
         /* childh->m_parent = mm_handle; */
 
         /* Map names back: If not disabled by user flag EOBJ_NO_MAP, then attach all names of 
@@ -754,16 +909,23 @@ void eObject::adopt(
            If we are adoprion from a=one tree structure to another (sync is on), we need to set 
            m_root pointer (pointer to eRoot of a tree structure)to all child objects.
          */
-        mapflags = sync ? E_SET_ROOT_POINTER : 0;
+        mapflags = newroot ? E_SET_ROOT_POINTER : 0;
         if ((aflags & EOBJ_NO_MAP) == 0) 
         {
             mapflags |= E_ATTACH_NAMES;
         }
 
-        if (mapflags)
+        if (newroot)
         {
             childh->m_root = mm_handle->m_root;
-            child->map(E_ATTACH_NAMES|E_SET_ROOT_POINTER);
+        }
+
+        /* Walk trough child's children only if needed. Adopting a detached envelope with
+           EOBJ_NO_MAP to another thread is O(1), if content is in detached payload.
+         */
+        if (mapflags && (childh->m_children || childh->m_oid == EOID_NAME))
+        {
+            child->map(mapflags);
         }
 
 // mm_root->mm_handle->verify_whole_tree();
@@ -791,6 +953,7 @@ void eObject::ns_create(
     const os_char *namespace_id)
 {
 	eNameSpace *ns;
+    eVariable *nsid;
 
 	/* If object has already name space.
 	 */
@@ -799,17 +962,16 @@ void eObject::ns_create(
 	{
 		/* If namespace identifier matches, just return.
 		 */
-        if (ns->namespaceid())
+        if (namespace_id && ns->namespacematch(eatom_find(namespace_id)))
         {
-            if (!os_strcmp(namespace_id, ns->namespaceid()->gets()))
-                return;
+            return;
         }
 
 		/* Delete old name space.
            We should keep ot if we want to have multiple name spaces???
 		 */
-		delete ns;
         ns->setnamespaceid(OS_NULL);
+		delete ns;
 	}
 
 	/* Create name space.
@@ -818,8 +980,9 @@ void eObject::ns_create(
 	ns = new eNameSpace(this, EOID_NAMESPACE);
     if (namespace_id)
     {
-        ns->setnamespaceid(new eVariable(ns));
-        ns->namespaceid()->sets(namespace_id);
+        nsid = new eVariable(ns);
+        nsid->sets(namespace_id);
+        ns->setnamespaceid(nsid);
     }
 
 	/* Remap names in child objects ??? Do we need this. In practise name space is created 
@@ -1000,6 +1163,68 @@ eContainer *eObject::ns_getc(
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Find eName by interned name and name space identifier.
+
+  The eObject::ns_first_atom() function finds the first eName object matching to name. 
+  Unlike ns_first(), the name cannot contain name space prefix. Names and name space 
+  identifiers are compared as atoms, no strings are hashed or compared.
+  
+  @param   name Interned name to search for.
+  @param   namespace_atom Name space identifier as atom.
+  @return  Pointer to name. OS_NULL if none found.
+
+****************************************************************************************************
+*/
+eName *eObject::ns_first_atom(
+    eAtom name,
+    eAtom namespace_atom)
+{
+    eNameSpace *ns;
+
+    ns = findnamespace_atom(namespace_atom);
+    if (ns == OS_NULL) return OS_NULL;
+    return ns->findname_atom(name);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find object by interned name.
+
+  The eObject::ns_get_atom() function finds the first named object matching to name in 
+  speficied namespace. See ns_first_atom().
+  
+  @param   name Interned name to search for.
+  @param   namespace_atom Name space identifier as atom.
+  @param   cid Class identifier of object to get, ECLASSID_OBJECT for any class.
+  @return  Pointer to object. OS_NULL if none found.
+
+****************************************************************************************************
+*/
+eObject *eObject::ns_get_atom(
+    eAtom name,
+    eAtom namespace_atom,
+    os_int cid)
+{
+    eName *n;
+    eObject *p;
+
+    n = ns_first_atom(name, namespace_atom);
+    while (n)
+    {
+        p = n->parent();
+        if (cid == ECLASSID_OBJECT || p->classid() == cid) return p;
+        n = n->ns_next();
+    }
+
+    return OS_NULL;
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -1028,6 +1253,59 @@ eNameSpace *eObject::findnamespace(
     const os_char *namespace_id,
     os_int *info,
     eObject *checkpoint)
+{
+    eAtom atom;
+
+	/* If name space id NULL, it is same as parent name space.
+	 */
+    if (namespace_id == OS_NULL)
+    {
+        atom = EATOM_PARENT_NS;
+    }
+
+	/* Process and thread name spaces are recognized by the first character.
+	 */
+    else if (*namespace_id == '/')
+    {
+        atom = EATOM_PROCESS_NS;
+    }
+    else if (*namespace_id == '\0')
+    {
+        atom = EATOM_THREAD_NS;
+    }
+
+	/* Name space identifier which has not been interned cannot match any name space.
+	 */
+    else 
+    {
+        atom = eatom_find(namespace_id);
+    }
+
+    return findnamespace_atom(atom, info, checkpoint);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find name space by name space identifier atom.
+
+  The eObject::findnamespace_atom() function finds name space like findnamespace(), but the 
+  name space identifier is given as atom. Name space identifiers are compared as atoms.
+
+  @param  namespace_atom Identifier for the name space as atom, EATOM_PARENT_NS refers to first
+          parent name space, regardless of name space identifier.
+  @param  info Pointer where to set information bits. OS_NULL if not needed. See findnamespace().
+  @param  checkpoint Pointer to object in tree structure to check if name space is above this one.
+          OS_NULL if not needed.
+  @return Pointer to name space, eNameSpace class. OS_NULL if none found.
+
+****************************************************************************************************
+*/
+eNameSpace *eObject::findnamespace_atom(
+    eAtom namespace_atom,
+    os_int *info,
+    eObject *checkpoint)
 {
 	eNameSpace *ns;
     eHandle *h, *ns_h;
@@ -1037,37 +1315,29 @@ eNameSpace *eObject::findnamespace(
      */
     if (info) *info = 0;
 
-	/* If name space id NULL, it is same as parent name space.
-	 */
-    if (namespace_id == OS_NULL)
-    {
-        namespace_id = E_PARENT_NS;
-    }
-
-    switch (*namespace_id)
+    switch (namespace_atom)
     {
 	    /* If name space id refers to process name space, just return pointer to it.
 	     */
-        case '/':
+        case EATOM_PROCESS_NS:
             if (info) *info = E_INFO_PROCES_NS|E_INFO_ABOVE_CHECKPOINT;
             return eglobal->process_ns;
 
 	    /* If thread name space, just return pointer to the name space.
 	     */
-        case '\0':
+        case EATOM_THREAD_NS:
             if (info) *info = E_INFO_ABOVE_CHECKPOINT;
             return eNameSpace::cast(mm_handle->m_root->first(EOID_NAMESPACE));
 
+        case EATOM_THIS_NS:
+            if ((flags() & EOBJ_HAS_NAMESPACE) == 0) return OS_NULL;
+            return eNameSpace::cast(first(EOID_NAMESPACE));
+
+        case EATOM_NONE:
+            return OS_NULL;
+
         default:
-            if (!os_strcmp(namespace_id, "."))
-            {
-                if ((flags() & EOBJ_HAS_NAMESPACE) == 0) return OS_NULL;
-                return eNameSpace::cast(first(EOID_NAMESPACE));
-            }
-            else 
-            {
-                getparent = (os_boolean)!os_strcmp(namespace_id, "..");
-            }
+            getparent = (os_boolean)(namespace_atom == EATOM_PARENT_NS);
             break;
     }
 
@@ -1089,14 +1359,10 @@ eNameSpace *eObject::findnamespace(
 
                 /* If name space has identifier, and it matches?
                  */
-                if (namespace_id)
+                ns = eNameSpace::cast(ns_h->object());
+                if (ns) if (ns->namespacematch(namespace_atom))
                 {
-                    ns = eNameSpace::cast(ns_h->object());
-                    if (ns) if (ns->namespaceid())
-                    {
-                        if (os_strcmp(namespace_id, ns->namespaceid()->gets()))
-                            return ns;
-                    }
+                    return ns;
                 }
                 ns_h = ns_h->next(EOID_NAMESPACE);
             }
@@ -1137,7 +1403,7 @@ eName *eObject::addname(
 
 	/* Create name object.
 	 */
-	n = new eName(this, EOID_NAME);
+	n = new (this) eName(this, EOID_NAME);
 
     /* Set flags for name, like persistancy.
      */
@@ -1319,7 +1585,7 @@ void eObject::mapone(
 
     name = eName::cast(handle->m_object);
 
-    ns = handle->m_object->findnamespace(name->namespaceid(), &info, this);
+    ns = handle->m_object->findnamespace_atom(name->namespaceatom(), &info, this);
 
     if ((mflags & E_ATTACH_NAMES))
     {
@@ -1367,6 +1633,34 @@ eObject *eObject::byname(
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Get object by interned name.
+
+  The eObject::byname_atom() function looks for name in this object's name space. 
+
+  @param  name Interned name to look for.  
+  @return If name is found, returns pointer to named object. Otherwise the function returns OS_NULL.
+
+****************************************************************************************************
+*/
+eObject *eObject::byname_atom(
+    eAtom name)
+{
+    eName *nobj;
+    eNameSpace *nspace;
+    
+    nspace = eNameSpace::cast(first(EOID_NAMESPACE));
+    if (nspace)
+    {
+        nobj = nspace->findname_atom(name);
+        if (nobj) return nobj->parent();
+    }
+    return OS_NULL;
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -1392,30 +1686,72 @@ void eObject::message(
     eObject *content,
     os_int mflags,
     eObject *context)
+{
+    message(newenvelope(command, target, source, content, mflags, context));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Create envelope for a message.
+
+  The eObject::newenvelope() function creates an envelope and sets command, target and source
+  paths, content and context to it. Envelope memory is taken from thread's envelope pool,
+  if available.
+
+  @param   command Command, like ECMD_SETPROPERTY.
+  @param   target Path to target object.
+  @param   source Source path, OS_NULL if none.
+  @param   content Message content, OS_NULL if none.
+  @param   mflags Message flags, like EMSG_DEL_CONTENT.
+  @param   context Message context, OS_NULL if none.
+  @return  Pointer to new envelope.
+
+****************************************************************************************************
+*/
+eEnvelope *eObject::newenvelope(
+    os_int command, 
+    const os_char *target,
+    const os_char *source,
+    eObject *content,
+    os_int mflags,
+    eObject *context)
 {
     eEnvelope *envelope;
     eObject *parent;
+    void *buf;
 
     /* We use eRoot as pasent, in case object receiving message gets deleted.
-       parent = this is just fallback mechanim.
+       parent = this is just fallback mechanim. Take envelope memory from
+       thread's envelope pool, if available.
      */
+    buf = OS_NULL;
 	if (mm_handle) 
     {
         parent = mm_handle->m_root;
+        buf = mm_handle->m_root->envelope_alloc();
     }
     else
     {
         parent = this;
     }
 
-    envelope = new eEnvelope(parent, EOBJ_IS_ATTACHMENT);
+    if (buf)
+    {
+        envelope = new(buf) eEnvelope(parent, EOBJ_IS_ATTACHMENT);
+    }
+    else
+    {
+        envelope = new eEnvelope(parent, EOBJ_IS_ATTACHMENT);
+    }
     envelope->setcommand(command);
     envelope->setmflags(mflags & ~(EMSG_DEL_CONTENT|EMSG_DEL_CONTEXT));
     envelope->settarget(target);
     if (source) envelope->prependsource(source);
     envelope->setcontent(content, mflags);
     envelope->setcontext(context, mflags);
-    message(envelope);
+    return envelope;
 }
 
 
@@ -1474,7 +1810,7 @@ void eObject::message(
         else 
         {
             envelope->move_target_pos(1);
-            message_within_thread(envelope, E_THREAD_NS);
+            message_within_thread(envelope, EATOM_THREAD_NS);
         }
         return;
 
@@ -1492,7 +1828,7 @@ void eObject::message(
         if (target[1] == '/' || target[1] == '\0') 
         {
             envelope->move_target_over_objname(1);
-            message_within_thread(envelope, eobj_this_ns);
+            message_within_thread(envelope, EATOM_THIS_NS);
             return;
         } 
 
@@ -1502,20 +1838,22 @@ void eObject::message(
              if (target[2] == '/' || target[2] == '\0')
         {
             envelope->move_target_over_objname(2);
-            message_within_thread(envelope, E_PARENT_NS);
+            message_within_thread(envelope, EATOM_PARENT_NS);
             return;
         }
         break;
     }
 
-    /* Name or user specified name space.
+    /* Name or user specified name space. Name space identifiers are interned when name 
+       space is created, so the path segment can be looked up as atom.
      */
     eVariable nspacevar;
     envelope->nexttarget(&nspacevar);
     namespace_id = nspacevar.gets(&sz);
     envelope->move_target_over_objname((os_short)sz-1);
 
-    message_within_thread(envelope, namespace_id);
+    message_within_thread(envelope, *namespace_id 
+        ? eatom_find(namespace_id, sz - 1) : EATOM_THREAD_NS);
 }
 
 
@@ -1530,20 +1868,21 @@ void eObject::message(
   
   @param   envelope Message envelope to send. Contains command, target and source paths and
            message content, etc.
+  @param   namespace_atom Name space identifier as atom.
   @return  None. 
 
 ****************************************************************************************************
 */
 void eObject::message_within_thread(
     eEnvelope *envelope,
-    const os_char *namespace_id)
+    eAtom namespace_atom)
 {
 	eNameSpace *nspace;
     eVariable objname;
     eName *name;
     os_memsz sz;
 
-    nspace = findnamespace(namespace_id);
+    nspace = findnamespace_atom(namespace_atom);
     if (nspace == OS_NULL) goto getout;
 
     /* Get next object name in target path. 
@@ -1561,7 +1900,8 @@ void eObject::message_within_thread(
     }
 
     name->parent()->onmessage(envelope);
-    delete envelope;
+    if (mm_handle->m_root) mm_handle->m_root->envelope_recycle(envelope);
+    else delete envelope;
     return;
 
 getout:
@@ -1610,9 +1950,16 @@ void eObject::message_process_ns(
     eNameSpace *process_ns;
     eName *name, *nextname;
     eThread *thread;
+    eNsIndexResult res;
+    eNsIndexGuard guard;
+    eRoot *root;
+    eRouteCacheEntry *route;
     os_memsz sz;
-    os_char buf[E_OIXSTR_BUF_SZ], *oname, c;
-    os_boolean multiplethreads;
+    os_char buf[E_OIXSTR_BUF_SZ], *oname, *p, c;
+    os_uint hash;
+    e_oix oix;
+    os_int generation, ucnt;
+    os_boolean multiplethreads, wait;
 
     /* If this is message to process ?
      */
@@ -1651,9 +1998,95 @@ void eObject::message_process_ns(
         return;
     }
 
-    /* Otherwise message to named object.
+    /* Otherwise message to named object. Try first route cache of this thread, then
+       process name space index, which needs no locking. Names mapped to objects in
+       multiple threads are left for the synchronized code below.
+     */
+    oname = envelope->target();
+    for (p = oname; *p != '/' && *p != '\0'; p++);
+    sz = p - oname;
+    hash = ensindex_hash(oname, sz);
+    generation = ensindex_generation(hash);
+
+    root = mm_handle ? mm_handle->m_root : OS_NULL;
+    if (root)
+    {
+        route = root->routecache_get(oname, sz, hash, generation);
+        if (route)
+        {
+            if (message_route(envelope, route, sz)) return;
+            root->routecache_invalidate(route);
+        }
+    }
+
+    if (!ensindex_lookup(oname, sz, hash, &res, &guard))
+    {
+        ensindex_release(&guard);
+#if OSAL_DEBUG
+        if ((envelope->flags() & EMSG_NO_ERRORS) == 0)
+        {
+            osal_debug_error("message() failed: Name not found in process NS");   
+        }
+#endif
+        goto getout;
+    }
+
+    if (!res.multiple_threads)
+    {
+        if (res.thread == OS_NULL)
+        {
+            ensindex_release(&guard);
+#if OSAL_DEBUG
+            if ((envelope->flags() & EMSG_NO_ERRORS) == 0)
+            {
+                osal_debug_error("message() failed: Name in process NS has no eThread as root");
+            }
+#endif
+            goto getout;
+        }
+
+        /* Remember the route, so next message to same name needs no look up.
+         */
+        if (root)
+        {
+            root->routecache_set(oname, sz, hash, generation, res.oixstr, 
+                res.thread, res.is_thread);
+        }
+
+        /* Replace object name with oix string, unless this is message to thread itself
+           or object name is already oix. Queue the envelope while still holding the
+           guard, which keeps the thread from being deleted.
+         */
+        if (!res.is_thread) 
+        {
+            if (*oname != '@')
+            {
+                envelope->move_target_over_objname((os_short)sz);
+                envelope->prependtarget(res.oixstr);
+            }
+        }
+        else
+        {
+            envelope->move_target_over_objname((os_short)sz);
+        }
+
+        wait = res.thread->queue(envelope);
+        if (wait)
+        {
+            oix = res.thread->mm_handle->oix();
+            ucnt = res.thread->mm_handle->ucnt();
+        }
+        ensindex_release(&guard);
+
+        /* If receiving thread's queue is full, wait for space.
+         */
+        if (wait) eThread::waitqueue(oix, ucnt);
+        return;
+    }
+    ensindex_release(&guard);
+
+    /* Name is mapped to multiple threads.
      */
-    else
     {
         eVariable objname;
 
@@ -1662,6 +2095,7 @@ void eObject::message_process_ns(
          */
         envelope->nexttarget(&objname);
         oname = objname.gets(&sz);
+        wait = OS_FALSE;
 
         /* Synchronize.
          */
@@ -1740,7 +2174,12 @@ void eObject::message_process_ns(
 
             /* Move the envelope to thread's message queue.
              */
-            thread->queue(envelope);
+            wait = thread->queue(envelope);
+            if (wait)
+            {
+                oix = thread->mm_handle->oix();
+                ucnt = thread->mm_handle->ucnt();
+            }
         }
 
         /* Multiple threads.
@@ -1751,6 +2190,14 @@ void eObject::message_process_ns(
              */
             envelope->move_target_over_objname((os_short)sz - 1);
 
+            /* If sender allows, share content and context between recipients instead
+               of copying those for each thread.
+             */
+            if (envelope->mflags() & EMSG_SHARED_CONTENT)
+            {
+                envelope->share_content();
+            }
+
             eVariable savedtarget, mytarget;
             savedtarget.sets(envelope->target());
 
@@ -1792,6 +2239,10 @@ void eObject::message_process_ns(
         /* End synchronization
          */
         os_unlock();
+
+        /* If receiving thread's queue is full, wait for space.
+         */
+        if (wait) eThread::waitqueue(oix, ucnt);
     }
 
     return;
@@ -1819,6 +2270,10 @@ getout:
   target belongs to. If this is in same object tree as the sender of the message message,
   then object's onmessage function is called directly. If target belongs to different object
   three from sender, the function places message to target thread's message queue.
+
+  Handle lookup is lock free: Handle tables are never freed while the process runs, so use
+  count and root pointer can be read atomically. The global lock is taken only when the
+  message is placed in other thread's queue.
   
   @param   envelope Message envelope to send. Contains command, target and source paths and
            message content, etc.
@@ -1834,6 +2289,7 @@ void eObject::message_oix(
     e_oix oix;
     os_int ucnt;
     os_short count;
+    os_boolean wait;
 
     /* Parse object index and use count from string.
      */
@@ -1849,58 +2305,68 @@ void eObject::message_oix(
         goto getout;
     }
 
-    /* Synchnronize and find handle pointer.
+    /* Find handle pointer without locking. If use count doesn't match, the object has been
+       deleted (or oix was never valid).
      */
-    os_lock();
-    handle = eget_handle(oix);
-    if (ucnt != handle->m_ucnt)
-    {
-        os_unlock();
-#if OSAL_DEBUG
-        if ((envelope->flags() & EMSG_NO_ERRORS) == 0)
-        {
-            osal_debug_error("message() failed: target object has been deleted");
-        }
-#endif
-        goto getout;
-    }
+    handle = eget_handle_check(oix);
+    if (handle == OS_NULL) goto deleted;
+    if (ucnt != eatomic_load_int((volatile os_int*)&handle->m_ucnt)) goto deleted;
 
-    /* If object is in same root tree (same thread), end syncronization and call function.
+    /* If object is in same root tree (same thread), call function. Only this thread can
+       move the object into or out of it's own tree, so no synchronization is needed.
      */
-    if (mm_handle->m_root == handle->m_root)
+    if (mm_handle->m_root == (eRoot*)eatomic_load_ptr((void*volatile*)&handle->m_root))
     {
         /* Advance in target path.
          */
         envelope->move_target_over_objname(count);
 
-        os_unlock();
         handle->m_object->onmessage(envelope);
-        delete envelope;
+        if (mm_handle->m_root) mm_handle->m_root->envelope_recycle(envelope);
+        else delete envelope;
         return;
     }
 
-    /* Otherwise different threads.
+    /* Otherwise different threads. Synchronize and check again that the object has not
+       been deleted meanwhile.
      */
-    osal_debug_assert(handle->m_root);
+    os_lock();
+    if (ucnt != handle->m_ucnt || handle->m_root == OS_NULL)
+    {
+        os_unlock();
+        goto deleted;
+    }
     thread = eThread::cast(handle->m_root->parent());
     if (thread == handle->m_object) envelope->move_target_over_objname(count);
    
     /* Place the envelope in thread's message queue.
      */
+    wait = OS_FALSE;
     if (thread)
     {
-        thread->queue(envelope);
+        wait = thread->queue(envelope);
+        oix = thread->mm_handle->oix();
+        ucnt = thread->mm_handle->ucnt();
     }
     else
     {
         delete envelope;
     }
 
-    /* Finish with synchronization and return.
+    /* Finish with synchronization. If receiving thread's queue is full, wait for space.
      */
     os_unlock();
+    if (wait) eThread::waitqueue(oix, ucnt);
     return;
 
+deleted:
+#if OSAL_DEBUG
+    if ((envelope->flags() & EMSG_NO_ERRORS) == 0)
+    {
+        osal_debug_error("message() failed: target object has been deleted");
+    }
+#endif
+
 getout:
     /* Send "no target" reply message to indicate that recipient was not found.
      */
@@ -1914,6 +2380,72 @@ getout:
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Send message using cached route.
+
+  The eObject::message_route is helper function for eObject::message_process_ns() to send
+  message to named object using route cache. No locking is needed: The caller is registered 
+  as reader of the name's index shard and shard generation is checked, so the named object 
+  has not been detached and the thread cannot be deleted while queuing. Use counter of cached 
+  object index is checked also, without locking.
+
+  @param   envelope Message envelope to send. Target path starts with name in process name space.
+  @param   route Route cache entry for the name.
+  @param   name_n Name length in bytes.
+  @return  OS_TRUE if message was queued. OS_FALSE if cached route is no longer valid, envelope
+           is not modified.
+
+****************************************************************************************************
+*/
+os_boolean eObject::message_route(
+    eEnvelope *envelope,
+    eRouteCacheEntry *route,
+    os_memsz name_n)
+{
+    eHandle *handle;
+    eThread *thread;
+    eNsIndexGuard guard;
+    e_oix oix;
+    os_int ucnt;
+    os_boolean wait;
+
+    /* Register as reader of the shard. If names in the shard have changed since the
+       route was resolved, or the object has been deleted, the route is stale.
+     */
+    ensindex_enter(route->hash, &guard);
+    if (ensindex_generation(route->hash) != route->generation)
+    {
+        ensindex_release(&guard);
+        return OS_FALSE;
+    }
+
+    handle = eget_handle_check(route->oix);
+    if (handle == OS_NULL || handle->ucnt() != route->ucnt)
+    {
+        ensindex_release(&guard);
+        return OS_FALSE;
+    }
+    thread = route->thread;
+
+    /* Replace name with object index string, unless this is message to thread itself.
+     */
+    envelope->move_target_over_objname((os_short)name_n);
+    if (!route->is_thread) envelope->prependtarget(route->oixstr);
+
+    /* Place the envelope in thread's message queue while still holding the guard. If 
+       receiving thread's queue is full, wait for space once the guard is released.
+     */
+    wait = thread->queue(envelope);
+    oix = thread->mm_handle->oix();
+    ucnt = thread->mm_handle->ucnt();
+    ensindex_release(&guard);
+    if (wait) eThread::waitqueue(oix, ucnt);
+    return OS_TRUE;
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -2074,8 +2606,8 @@ void eObject::onmessage_oix(
 
     /* Find handle pointer.
      */
-    handle = eget_handle(oix);
-    if (ucnt != handle->m_ucnt)
+    handle = eget_handle_check(oix);
+    if (handle == OS_NULL || ucnt != handle->m_ucnt)
     {
 #if OSAL_DEBUG
         if ((envelope->flags() & EMSG_NO_ERRORS) == 0)
@@ -2235,7 +2767,9 @@ eVariable *eObject::addproperty(
 
   @brief Property set for class done, complete it.
 
-  The propertysetdone function lists attributes (subproperties) for each base property.
+  The propertysetdone function lists attributes (subproperties) for each base property and
+  freezes the property set into flat property table, which property functions use without
+  locking. Properties should not be added to the property set after this call.
   
   @param  classid Specifies to which classes property set the property is being added.
   @return None.
@@ -2278,6 +2812,10 @@ void eObject::propertysetdone(
             }
         }
     }
+
+    os_lock();
+    eproptable_build(cid, propertyset);
+    os_unlock();
 }
 
 
@@ -2435,11 +2973,21 @@ os_int eObject::propertynr(
     const os_char *propertyname)
 {
     eContainer *propertyset;
+    ePropertyTable *table;
     eNameSpace *ns;
     eName *name;
     os_int pnr;
     eVariable v;
 
+    /* Look up from flat property table without locking.
+     */
+    table = eproptable_get(classid());
+    if (table)
+    {
+        pnr = eproptable_nr(table, propertyname);
+        if (pnr >= 0) return pnr;
+    }
+
     /* Synchronize.
      */
     os_lock();
@@ -2470,6 +3018,40 @@ notfound:
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Get property number by interned property name.
+
+  The propertynr_atom() function gets property number for this class by property name atom.
+  Atoms are compared from flat property table. If the class has no property table, this falls
+  back to propertynr().
+  
+  @param  propertyname Interned property name.
+  @return Property number, -1 if failed.
+
+****************************************************************************************************
+*/
+os_int eObject::propertynr_atom(
+    eAtom propertyname)
+{
+    ePropertyTable *table;
+    const os_char *namestr;
+    os_int pnr;
+
+    table = eproptable_get(classid());
+    if (table)
+    {
+        pnr = eproptable_nr_atom(table, propertyname);
+        if (pnr >= 0) return pnr;
+    }
+
+    namestr = eatom_str(propertyname);
+    if (namestr == OS_NULL) return -1;
+    return propertynr(namestr);
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -2486,10 +3068,23 @@ os_char *eObject::propertyname(
     os_int propertynr)
 {
     eContainer *propertyset;
+    ePropertyTable *table;
     eName *name;
     eVariable *p;
     os_char *namestr;
 
+    /* Look up from flat property table without locking.
+     */
+    table = eproptable_get(classid());
+    if (table)
+    {
+        if (eproptable_var(table, propertynr)) 
+        {
+            namestr = table->name[propertynr];
+            if (namestr) return namestr;
+        }
+    }
+
     /* Synchronize.
      */
     os_lock();
@@ -2544,12 +3139,25 @@ void eObject::setpropertyv(
     os_int flags)
 {
     eContainer *propertyset;
+    ePropertyTable *table;
     eSet *properties;
     eVariable *p;
     eVariable v;
     os_int pflags;
+    os_boolean isdefault;
 
-    /* Synchronize access to global property set.
+    /* Get global eVariable describing this property from flat property table without
+       locking.
+     */
+    table = eproptable_get(classid());
+    p = table ? eproptable_var(table, propertynr) : OS_NULL;
+    if (p)
+    {
+        pflags = table->pflags[propertynr];
+        goto gotit;
+    }
+
+    /* Not in property table, synchronize access to global property set.
      */
     os_lock();
 
@@ -2578,6 +3186,7 @@ void eObject::setpropertyv(
      */
     os_unlock();
 
+gotit:
     /* Empty x and x as null pointer are thes ame thing, handle these in 
        the same way. 
      */
@@ -2628,9 +3237,12 @@ void eObject::setpropertyv(
         }
 
         /* If x matches to default value, then remove the
-           value from eSet. 
+           value from eSet. Global default value is compared with process mutex locked.
          */
-        if (!p->compare(x)) 
+        os_lock();
+        isdefault = (os_boolean)!p->compare(x);
+        os_unlock();
+        if (isdefault) 
         {
             properties->set(propertynr, OS_NULL);
         }
@@ -2732,6 +3344,7 @@ void eObject::propertyv(
 {
     eSet *properties;
     eContainer *propertyset;
+    ePropertyTable *table;
     eVariable *p;
     
     /* Look for eSet holding stored property values. If found, check for 
@@ -2749,7 +3362,21 @@ void eObject::propertyv(
      */
     if (simpleproperty(propertynr, x) == ESTATUS_SUCCESS) return;
 
-    /* Look for default value. Start by synchronizing access to global property data.
+    /* Look for default value from flat property table. Lookup needs no locking, but the
+       global default value variable may be modified by other threads: Copy it with process
+       mutex locked.
+     */
+    table = eproptable_get(classid());
+    p = table ? eproptable_var(table, propertynr) : OS_NULL;
+    if (p)
+    {
+        os_lock();
+        x->setv(p);
+        os_unlock();
+        return;
+    }
+
+    /* Not in property table, synchronize access to global property data.
      */
     os_lock();
 
@@ -2771,13 +3398,10 @@ void eObject::propertyv(
         goto getout;
     }
 
-    /* Finished with synchwonization.
-     */
-    os_unlock();
-
-    /* Return default value for the property.
+    /* Return default value for the property and finish with synchronization.
      */
     x->setv(p);
+    os_unlock();
     return;
 
 getout:
@@ -2828,6 +3452,12 @@ os_double eObject::propertyd(
           - EBIND_METADATA: If meta data, like text, unit, attributes, etc exists, it is 
             also transferred from remote object to local object.
           - EBIND_TEMPORARY: Binding is temporary and will not be cloned nor serialized.
+          - EBIND_DEADBAND_REL: Deadband is relative to last value sent.
+          - EBIND_CONFLATE: Last value wins, only one value waits for acknowledge.
+  @param  min_interval_ms Minimum time between forwarded values in milliseconds, 0 for no
+          limit.
+  @param  deadband Numeric value change smaller than deadband is not forwarded, 0.0 to
+          forward every change.
   @param  envelope Used for server binding only. OS_NULL for clint binding.
   @return None.
 
@@ -2837,7 +3467,9 @@ void eObject::bind(
     os_int localpropertynr,
     const os_char *remotepath,
     const os_char *remoteproperty,
-    os_int bflags)
+    os_int bflags,
+    os_int min_interval_ms,
+    os_double deadband)
 {
     eContainer *bindings;
     ePropertyBinding *binding;
@@ -2860,7 +3492,8 @@ void eObject::bind(
 
     /* Bind properties. This function will send message to remote object to bind.
      */
-    binding->bind(localpropertynr, remotepath, remoteproperty, bflags);
+    binding->bind(localpropertynr, remotepath, remoteproperty, bflags, 
+        min_interval_ms, deadband);
 }
 
 
@@ -34,6 +34,8 @@ class eStream;
 class eEnvelope;
 class eThread;
 class ePointer;
+class eRequest;
+struct eRouteCacheEntry;
 
 /* Flags for message()
  */
@@ -45,9 +47,12 @@ class ePointer;
 #define EMSG_NO_NEW_SOURCE_OIX 4
 #define EMSG_NO_ERRORS 8
 #define EMSG_INTERTHREAD 16 /* Message has been passed from thread to another */
+#define EMSG_SHARED_CONTENT 32 /* Multicast recipients share read only content and context */
+#define EMSG_HIGH_PRIORITY 64 /* Queue to receiving thread's high priority lane */
 #define EMSG_DEL_CONTENT 128
 #define EMSG_DEL_CONTEXT 256
 #define EMSG_CAN_BE_ADOPTED 512 /* Internal: True if envelope or message can be adopted */
+#define EMSG_OVERFLOW_REPLY 1024 /* Internal: Queue was full, sender thread replies ECMD_NO_TARGET */
 #define EMSG_HAS_CONTENT 2 /* Special flag to be passed over connection only */
 #define EMSG_HAS_CONTEXT 4 /* Special flag to be passed over connection only */
 
@@ -74,6 +79,7 @@ class ePointer;
 #define EOBJ_BEFORE_THIS 1
 #define EOBJ_NO_MAP 2
 #define EOBJ_CLONE_ALL_CHILDREN 4
+#define EOBJ_NO_SYNC 8 /* Internal: Adopted object is detached and owned by calling thread */
 
 /* Serialization flags eObject::write(), eObject::read() and clonegeeric() functions.
  */
@@ -96,6 +102,15 @@ extern os_char eobj_thread_ns[];
 extern os_char eobj_parent_ns[];
 extern os_char eobj_this_ns[];
 
+/* Reply callback function type for request(). The obj is the requesting object, reply
+   the reply envelope or OS_NULL if request timed out, and prm the parameter given to
+   request(). Reply command is ECMD_NO_TARGET if the request target was not found.
+ */
+typedef void eReplyFunc(
+    eObject *obj,
+    eEnvelope *reply,
+    void *prm);
+
 
 /**
 ****************************************************************************************************
@@ -112,6 +127,8 @@ class eObject
 	friend class eHandle;
 	friend class eRoot;
     friend class ePointer;
+    friend class eThread;
+    friend class eMessageBatch;
 
     /** 
     ************************************************************************************************
@@ -147,24 +164,6 @@ private:
 	    os_int flags);
 
 public:
-/*     void* operator new(size_t sz)
-    {
-        size_t *p;
-        sz += sizeof(size_t);
-        p = (size_t*)os_malloc(sz, OS_NULL);
-        *p = sz;
-        return p + 1;
-    }
-
-    void operator delete(void *p)
-    {
-        if (p)
-        {
-            size_t *q = (size_t*)p - 1;
-            os_free(q, *q);
-        }
-    }
-*/
 
     /* Delete eObject, virtual destructor.
      */
@@ -228,33 +227,106 @@ public:
     /*@}*/
 
 
-#if EOVERLOAD_NEW_AND_DELETE
+#if EOVERLOAD_NEW_AND_DELETE || E_SLAB_ALLOCATOR
     /** 
     ************************************************************************************************
 
       @name Memory allocation
 
       Memory for objects is allocated by overloaded new and delete operators. These map the
-      memory allocation to OSAL memory management.
+      memory allocation to thread local slab allocator, or to OSAL memory management. 
+      new (parent) form is used for object created as child of parent, it allocates from
+      thread's active arena if the parent is within the arena.
 
     ************************************************************************************************
     */
     /*@{*/
 
-    /* Overloaded new operator calls os_malloc().
+    /* Overloaded new operator calls eslab_alloc() or os_malloc().
      */
     void* operator new(
         size_t);
 
-    /* Overloaded delete operator calls os_free().
+    /* New operator for child object, calls eslab_alloc_child() or os_malloc().
+     */
+    void* operator new(
+        size_t size,
+        eObject *parent);
+
+    /* Overloaded delete operator calls eslab_free() or os_free().
      */
     void operator delete(
         void *buf); 
 
+    /* Delete operator matching new (parent), called only if constructor throws.
+     */
+    void operator delete(
+        void *buf,
+        eObject *parent);
+
     /*@}*/
+#else
+    inline void* operator new(
+        size_t size)
+    {
+        return ::operator new(size);
+    }
+
+    inline void* operator new(
+        size_t size,
+        eObject *parent)
+    {
+        return ::operator new(size);
+    }
+
+    inline void operator delete(
+        void *buf)
+    {
+        ::operator delete(buf);
+    }
+
+    inline void operator delete(
+        void *buf,
+        eObject *parent)
+    {
+        ::operator delete(buf);
+    }
 #endif
 
-    /** 
+    /**
+    ************************************************************************************************
+
+      @name Memory arena
+
+      Objects created by the thread with new (parent) between beginarena() and endarena()
+      calls, within this object's subtree, are allocated from memory arena owned by this
+      object. Other objects, like envelopes, are never allocated from the arena. Deleting this
+      object's children then calls only destructors, which are not trivial, and releases
+      handles and arena memory at once. See earena.h.
+
+    ************************************************************************************************
+    */
+    /*@{*/
+
+    /* Start allocating objects from this object's arena.
+     */
+    void beginarena();
+
+    /* Stop allocating objects from this object's arena.
+     */
+    void endarena();
+
+    /* Return OS_TRUE if the object has nothing to release in destructor, so destructor call
+       can be skipped when the object is deleted with it's arena.
+     */
+    virtual os_boolean trivialdestructor()
+    {
+        return OS_FALSE;
+    }
+
+    /*@}*/
+
+    /**
     ************************************************************************************************
 
       @name Object flags
@@ -591,6 +663,19 @@ public:
         const os_char *name,
         const os_char *namespace_id = eobj_this_ns);
 
+    /* Find eName by interned name and name space identifier.
+     */
+    eName *ns_first_atom(
+        eAtom name,
+        eAtom namespace_atom = EATOM_THIS_NS);
+
+    /* Find object by interned name.
+     */
+    eObject *ns_get_atom(
+        eAtom name,
+        eAtom namespace_atom = EATOM_THIS_NS,
+        os_int cid = ECLASSID_OBJECT);
+
     /* Info bits for findnamespace().
      */
     #define E_INFO_PROCES_NS 1
@@ -603,6 +688,13 @@ public:
         os_int *info = OS_NULL,
         eObject *checkpoint = OS_NULL);
 
+    /* Find name space by name space ID atom. 
+     */
+	eNameSpace *findnamespace_atom(
+        eAtom namespace_atom = EATOM_PARENT_NS,
+        os_int *info = OS_NULL,
+        eObject *checkpoint = OS_NULL);
+
 	/* Give name to this object.
      */
 	eName *addname(
@@ -634,6 +726,11 @@ public:
 	eObject *byname(
         const os_char *name);
 
+    /* Get object by interned name.
+     */
+	eObject *byname_atom(
+        eAtom name);
+
 
     /*@}*/
 
@@ -665,6 +762,17 @@ public:
         os_int mflags = EMSG_DEFAULT,
         eObject *context = OS_NULL);
 
+    /* Send message and call func when reply arrives, see erequest.cpp.
+     */
+    eRequest *request(
+        os_int command, 
+        const os_char *target,
+        eObject *content,
+        eReplyFunc *func,
+        void *prm = OS_NULL,
+        os_long timeout_ms = 0,
+        os_int mflags = EMSG_DEFAULT);
+
     virtual void onmessage(
         eEnvelope *envelope);
 
@@ -760,6 +868,11 @@ public:
     os_int propertynr(
         const os_char *propertyname);
 
+    /* Interned property name to number.
+     */
+    os_int propertynr_atom(
+        eAtom propertyname);
+
     /* Property number to name.
      */
     os_char *propertyname(
@@ -848,7 +961,9 @@ public:
         os_int localpropertynr,
         const os_char *remotepath,
         const os_char *remoteproperty,
-        os_int bflags);
+        os_int bflags,
+        os_int min_interval_ms = 0,
+        os_double deadband = 0.0);
 
     /* Bind properties, remote property .
      */
@@ -880,9 +995,19 @@ public:
     /*@}*/
 
 private:
+    /* Create envelope for message() from thread's envelope pool.
+     */
+    eEnvelope *newenvelope(
+        os_int command, 
+        const os_char *target,
+        const os_char *source,
+        eObject *content,
+        os_int mflags,
+        eObject *context);
+
     void message_within_thread(
         eEnvelope *envelope,
-        const os_char *namespace_id);
+        eAtom namespace_atom);
 
     void message_process_ns(
         eEnvelope *envelope);
@@ -890,6 +1015,13 @@ private:
     void message_oix(
         eEnvelope *envelope);
 
+    /* Send message to named object in process name space using cached route.
+     */
+    os_boolean message_route(
+        eEnvelope *envelope,
+        eRouteCacheEntry *route,
+        os_memsz name_n);
+
     /* Forward message by object index within thread's object tree.
      */
     void onmessage_oix(
@@ -0,0 +1,275 @@
+/**
+
+  @file    eproptable.cpp
+  @brief   Flat per class property tables.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Property tables are built when property set is done and read without locking. See
+  eproptable.h.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Build property table.
+
+  The eproptable_build function creates flat property table from class'es property set and
+  publishes it, replacing previous table of the class if any. Replaced table is kept until
+  shutdown, since readers may still be using it. If property numbers are out of range, or
+  slots are full, no table is published and property functions use the property set.
+  Process mutex must be locked when calling this function.
+
+  @param   cid Class identifier.
+  @param   propertyset Class'es property set.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eproptable_build(
+    os_int cid,
+    eContainer *propertyset)
+{
+    ePropertyTables
+        *tables;
+
+    ePropertyTable
+        *t,
+        *old;
+
+    eVariable
+        *p;
+
+    eName
+        *name;
+
+    os_char
+        *namestr,
+        *q;
+
+    os_memsz
+        sz;
+
+    os_int
+        nro_properties,
+        nro_names,
+        nro_slots,
+        pnr,
+        i,
+        n;
+
+    tables = &eglobal->proptables;
+
+    /* Find out highest property number and number of named properties.
+     */
+    nro_properties = nro_names = 0;
+    for (p = propertyset->firstv(); p; p = p->nextv())
+    {
+        pnr = p->oid();
+        if (pnr < 0 || pnr > EPROPTABLE_MAX_PROPERTY_NR) return;
+        if (pnr >= nro_properties) nro_properties = pnr + 1;
+        if (p->firstn()) nro_names++;
+    }
+
+    nro_slots = 4;
+    while (nro_slots < 2 * nro_names) nro_slots *= 2;
+
+    /* Allocate table as one memory block: Header, pointer arrays, flags and slots.
+     */
+    sz = sizeof(ePropertyTable)
+        + nro_properties * (sizeof(eVariable*) + sizeof(os_char*) + sizeof(os_int)
+            + sizeof(eAtom))
+        + nro_slots * sizeof(os_int);
+    t = (ePropertyTable*)os_malloc(sz, OS_NULL);
+    os_memclear(t, sz);
+    t->cid = cid;
+    t->nro_properties = nro_properties;
+    t->slot_mask = nro_slots - 1;
+    t->alloc = sz;
+    q = (os_char*)t + sizeof(ePropertyTable);
+    t->var = (eVariable**)q;
+    q += nro_properties * sizeof(eVariable*);
+    t->name = (os_char**)q;
+    q += nro_properties * sizeof(os_char*);
+    t->pflags = (os_int*)q;
+    q += nro_properties * sizeof(os_int);
+    t->atom = (eAtom*)q;
+    q += nro_properties * sizeof(eAtom);
+    t->slot = (os_int*)q;
+
+    for (p = propertyset->firstv(); p; p = p->nextv())
+    {
+        pnr = p->oid();
+        t->var[pnr] = p;
+        t->pflags[pnr] = p->flags();
+
+        name = p->firstn();
+        if (name == OS_NULL) continue;
+        namestr = name->gets();
+        t->name[pnr] = namestr;
+        t->atom[pnr] = eatom_intern(namestr);
+
+        i = (os_int)(ensindex_hash(namestr, os_strlen(namestr) - 1) & t->slot_mask);
+        while (t->slot[i]) i = (i + 1) & t->slot_mask;
+        t->slot[i] = pnr + 1;
+    }
+
+    /* Find slot for the class: Slot already used by the class or first empty slot.
+     */
+    i = cid & (EPROPTABLE_NRO_SLOTS - 1);
+    for (n = 0; n < EPROPTABLE_NRO_SLOTS; n++)
+    {
+        old = tables->slot[i];
+        if (old == OS_NULL || old->cid == cid) break;
+        i = (i + 1) & (EPROPTABLE_NRO_SLOTS - 1);
+    }
+    if (n >= EPROPTABLE_NRO_SLOTS)
+    {
+        os_free(t, sz);
+        return;
+    }
+
+    /* Publish the table. Table contents are written before the pointer.
+     */
+    t->next = tables->all;
+    tables->all = t;
+    eatomic_store_ptr((void*volatile*)&tables->slot[i], t);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get property table of a class.
+
+  The eproptable_get function finds property table by class identifier without locking.
+
+  @param   cid Class identifier.
+  @return  Pointer to property table, OS_NULL if class has no table.
+
+****************************************************************************************************
+*/
+ePropertyTable *eproptable_get(
+    os_int cid)
+{
+    ePropertyTable
+        *t;
+
+    os_int
+        i,
+        n;
+
+    i = cid & (EPROPTABLE_NRO_SLOTS - 1);
+    for (n = 0; n < EPROPTABLE_NRO_SLOTS; n++)
+    {
+        t = (ePropertyTable*)eatomic_load_ptr((void*volatile*)&eglobal->proptables.slot[i]);
+        if (t == OS_NULL) return OS_NULL;
+        if (t->cid == cid) return t;
+        i = (i + 1) & (EPROPTABLE_NRO_SLOTS - 1);
+    }
+    return OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get property number by property name.
+
+  The eproptable_nr function looks up property name from table's hash slots.
+
+  @param   table Property table.
+  @param   propertyname Property name.
+  @return  Property number, -1 if not found.
+
+****************************************************************************************************
+*/
+os_int eproptable_nr(
+    ePropertyTable *table,
+    const os_char *propertyname)
+{
+    os_int
+        i,
+        pnr;
+
+    i = (os_int)(ensindex_hash(propertyname, os_strlen(propertyname) - 1) & table->slot_mask);
+    while ((pnr = table->slot[i]))
+    {
+        pnr--;
+        if (!os_strcmp(table->name[pnr], propertyname)) return pnr;
+        i = (i + 1) & table->slot_mask;
+    }
+    return -1;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get property number by interned property name.
+
+  The eproptable_nr_atom function looks up property name from table's hash slots. Atom's
+  string hash is used for the slots, so no string is hashed or compared.
+
+  @param   table Property table.
+  @param   propertyname Interned property name.
+  @return  Property number, -1 if not found.
+
+****************************************************************************************************
+*/
+os_int eproptable_nr_atom(
+    ePropertyTable *table,
+    eAtom propertyname)
+{
+    os_int
+        i,
+        pnr;
+
+    if (propertyname == EATOM_NONE) return -1;
+
+    i = (os_int)(eatom_hash(propertyname) & table->slot_mask);
+    while ((pnr = table->slot[i]))
+    {
+        pnr--;
+        if (table->atom[pnr] == propertyname) return pnr;
+        i = (i + 1) & table->slot_mask;
+    }
+    return -1;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release all property tables.
+
+  The eproptable_shutdown function frees all property tables. This is called when property
+  sets are released.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eproptable_shutdown()
+{
+    ePropertyTable
+        *t,
+        *next_t;
+
+    for (t = eglobal->proptables.all; t; t = next_t)
+    {
+        next_t = t->next;
+        os_free(t, t->alloc);
+    }
+    os_memclear(&eglobal->proptables, sizeof(ePropertyTables));
+}
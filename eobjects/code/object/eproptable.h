@@ -0,0 +1,149 @@
+/**
+
+  @file    eproptable.h
+  @brief   Flat per class property tables.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Class'es property set is stored in global eContainer as eVariables, one per property. Once
+  the property set is complete, propertysetdone() freezes it into a flat table indexed by
+  property number, with an open addressing hash map from property name to property number.
+  Tables are immutable once published, so property functions can use them without locking
+  the process mutex. Tables are found by class identifier from fixed size hash slots within
+  eglobals. If the class has no table, or property is not in the table, the property set is
+  searched with process mutex locked as before.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EPROPTABLE_INCLUDED
+#define EPROPTABLE_INCLUDED
+
+class eContainer;
+
+/** Number of class slots, must be power of two. Largest property number to put in table.
+ */
+#define EPROPTABLE_NRO_SLOTS 256
+#define EPROPTABLE_MAX_PROPERTY_NR 1023
+
+
+/**
+****************************************************************************************************
+
+  @name Property table structures.
+
+  Property table is one memory allocation: ePropertyTable header, arrays indexed by property
+  number and name hash slots.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/** Immutable property table of one class.
+ */
+typedef struct ePropertyTable
+{
+    /** Next table in list of all tables, including replaced ones.
+     */
+    struct ePropertyTable *next;
+
+    /** Class identifier.
+     */
+    os_int cid;
+
+    /** Highest property number + 1 and hash slot mask (number of slots - 1).
+     */
+    os_int nro_properties;
+    os_int slot_mask;
+
+    /** Allocated size in bytes.
+     */
+    os_memsz alloc;
+
+    /** Global eVariable describing the property, OS_NULL if there is no property with the
+        number. Property flags, property names and interned property names by property number.
+     */
+    eVariable **var;
+    os_int *pflags;
+    os_char **name;
+    eAtom *atom;
+
+    /** Open addressing hash slots by name hash, property number + 1. Zero marks an empty
+        slot.
+     */
+    os_int *slot;
+}
+ePropertyTable;
+
+/** Property tables within eglobals. Tables are published by atomic pointer store with
+    process mutex locked and read without locking.
+ */
+typedef struct ePropertyTables
+{
+    /** Hash slots by class identifier.
+     */
+    ePropertyTable *volatile slot[EPROPTABLE_NRO_SLOTS];
+
+    /** All tables, released at shutdown.
+     */
+    ePropertyTable *all;
+}
+ePropertyTables;
+
+/*@}*/
+
+
+/**
+****************************************************************************************************
+
+  @name Property table functions.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/* Build property table from class'es property set and publish it.
+ */
+void eproptable_build(
+    os_int cid,
+    eContainer *propertyset);
+
+/* Get property table of a class.
+ */
+ePropertyTable *eproptable_get(
+    os_int cid);
+
+/* Get property number by property name.
+ */
+os_int eproptable_nr(
+    ePropertyTable *table,
+    const os_char *propertyname);
+
+/* Get property number by interned property name.
+ */
+os_int eproptable_nr_atom(
+    ePropertyTable *table,
+    eAtom propertyname);
+
+/* Get global eVariable describing the property, OS_NULL if not in table.
+ */
+inline eVariable *eproptable_var(
+    ePropertyTable *table,
+    os_int propertynr)
+{
+    if ((os_uint)propertynr >= (os_uint)table->nro_properties) return OS_NULL;
+    return table->var[propertynr];
+}
+
+/* Release all property tables.
+ */
+void eproptable_shutdown();
+
+/*@}*/
+
+#endif
@@ -0,0 +1,610 @@
+/**
+
+  @file    eslab.cpp
+  @brief   Thread local slab allocator for objects.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Per thread size class free lists for eObject memory. See eslab.h.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+/* Object header. If n is ESLAB_ARENA_N, memory is from arena and arena points to it. 
+   Otherwise cache is OS_NULL if object was allocated by os_malloc(), then n is allocated
+   size. Otherwise n is size class index.
+ */
+typedef struct eSlabHeader
+{
+    union
+    {
+        eSlabCache *cache;
+        eArena *arena;
+    };
+    os_memsz n;
+}
+eSlabHeader;
+
+#define ESLAB_ARENA_N -1
+
+/* Thread exit hook: Destructor of thread local object releases the thread's cache.
+ */
+class eSlabThread
+{
+public:
+    ~eSlabThread();
+
+    eSlabCache *cache;
+};
+
+/* Calling thread's cache, active arena and exit hook.
+ */
+static thread_local eSlabCache *eslab_tcache;
+static thread_local eArena *eslab_tarena;
+static thread_local void *eslab_tlastarena;
+static thread_local eSlabThread eslab_thread;
+
+/* Forward referred static functions.
+ */
+static eSlabCache *eslab_newcache();
+
+static os_char *eslab_carve(
+    eSlabCache *c,
+    os_int cls);
+
+static void eslab_take_remote(
+    eSlabCache *c);
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate memory for an object.
+
+  The eslab_alloc function allocates memory from calling thread's free list for the size
+  class. If the free list is empty, objects deleted by other threads are taken back, and if
+  there are none, memory is split from block. Memory is never taken from an arena, see 
+  eslab_alloc_child().
+
+  @param   sz Object size in bytes.
+  @return  Pointer to allocated memory.
+
+****************************************************************************************************
+*/
+void *eslab_alloc(
+    os_memsz sz)
+{
+    eSlabCache
+        *c;
+
+    os_char
+        *p;
+
+    eSlabHeader
+        *h;
+
+    os_int
+        cls;
+
+    sz += ESLAB_HEADER_SZ;
+    c = eslab_tcache;
+    if (c == OS_NULL) c = eslab_newcache();
+
+    if (sz > ESLAB_MAX_SZ)
+    {
+        p = os_malloc(sz, OS_NULL);
+        h = (eSlabHeader*)p;
+        h->cache = OS_NULL;
+        h->n = sz;
+        c->large_allocs++;
+        return p + ESLAB_HEADER_SZ;
+    }
+
+    cls = (os_int)((sz - 1) / ESLAB_GRANULE);
+    p = c->free[cls];
+    if (p == OS_NULL)
+    {
+        eslab_take_remote(c);
+        p = c->free[cls];
+    }
+    if (p)
+    {
+        c->free[cls] = *(os_char**)(p + ESLAB_HEADER_SZ);
+    }
+    else
+    {
+        p = eslab_carve(c, cls);
+    }
+
+    h = (eSlabHeader*)p;
+    h->cache = c;
+    h->n = cls;
+    c->stats[cls].allocs++;
+    return p + ESLAB_HEADER_SZ;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate memory for a child object.
+
+  The eslab_alloc_child function allocates memory for an object to be created as child of
+  parent. Memory is taken from calling thread's active arena only if the parent is the arena
+  root or the parent itself was allocated from the arena, so only objects within arena 
+  root's subtree get arena memory. Otherwise memory is allocated by eslab_alloc(). The parent
+  is checked by object flags, memory before the parent is not read, since the parent may be
+  a stack or global object. Arena memory returned is remembered, so eObject constructor can
+  flag the object with EOBJ_ARENA_MEMORY, see eslab_claimarena().
+
+  @param   sz Object size in bytes.
+  @param   parent Parent of the object to be created, OS_NULL if none.
+  @return  Pointer to allocated memory.
+
+****************************************************************************************************
+*/
+void *eslab_alloc_child(
+    os_memsz sz,
+    eObject *parent)
+{
+    eArena
+        *arena;
+
+    os_char
+        *p;
+
+    eSlabHeader
+        *h;
+
+    arena = eslab_tarena;
+    if (arena == OS_NULL || parent == OS_NULL) return eslab_alloc(sz);
+    if (parent != arena->parent() && eslab_arenaof(parent) != arena) return eslab_alloc(sz);
+
+    p = arena->alloc(sz + ESLAB_HEADER_SZ);
+    h = (eSlabHeader*)p;
+    h->arena = arena;
+    h->n = ESLAB_ARENA_N;
+    eslab_tlastarena = p + ESLAB_HEADER_SZ;
+    return p + ESLAB_HEADER_SZ;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Free memory allocated by eslab_alloc().
+
+  The eslab_free function returns memory to calling thread's free list, if the object was
+  allocated by the same thread. Otherwise the memory is pushed to owner cache's remote free
+  list with compare and swap. Memory allocated from arena is released only when the arena
+  is deleted.
+
+  @param   buf Pointer to memory to free, OS_NULL is ignored.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eslab_free(
+    void *buf)
+{
+    eSlabCache
+        *c,
+        *owner;
+
+    os_char
+        *p,
+        *head;
+
+    eSlabHeader
+        *h;
+
+    os_int
+        cls;
+
+    if (buf == OS_NULL) return;
+    p = (os_char*)buf - ESLAB_HEADER_SZ;
+    h = (eSlabHeader*)p;
+    if (h->n == ESLAB_ARENA_N) return;
+    owner = h->cache;
+    c = eslab_tcache;
+
+    if (owner == OS_NULL)
+    {
+        os_free(p, h->n);
+        if (c) c->large_frees++;
+        return;
+    }
+
+    cls = (os_int)h->n;
+    if (owner == c)
+    {
+        *(os_char**)(p + ESLAB_HEADER_SZ) = c->free[cls];
+        c->free[cls] = p;
+        c->stats[cls].frees++;
+        return;
+    }
+
+    do
+    {
+        head = (os_char*)eatomic_load_ptr((void*volatile*)&owner->remote);
+        *(os_char**)(p + ESLAB_HEADER_SZ) = head;
+    }
+    while (!eatomic_cas_ptr((void*volatile*)&owner->remote, head, p));
+
+    if (c) c->stats[cls].remote_frees++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set arena to allocate objects from.
+
+  The eslab_setarena function sets arena from which memory for objects created by calling
+  thread is taken, see eObject::beginarena().
+
+  @param   arena Pointer to arena, OS_NULL to allocate from slab cache.
+  @return  Previously set arena, OS_NULL if none.
+
+****************************************************************************************************
+*/
+eArena *eslab_setarena(
+    eArena *arena)
+{
+    eArena
+        *prev;
+
+    prev = eslab_tarena;
+    eslab_tarena = arena;
+    eslab_tlastarena = OS_NULL;
+    return prev;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get calling thread's active arena.
+
+  @return  Pointer to arena, OS_NULL if none.
+
+****************************************************************************************************
+*/
+eArena *eslab_arena()
+{
+    return eslab_tarena;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if memory was just allocated from arena.
+
+  The eslab_claimarena function is called by eObject constructor to check if the object's
+  memory is the one which eslab_alloc_child() last took from arena for calling thread. If so,
+  the object is flagged with EOBJ_ARENA_MEMORY and the remembered pointer is cleared.
+
+  @param   buf Pointer to object being constructed.
+  @return  OS_TRUE if memory is from arena.
+
+****************************************************************************************************
+*/
+os_boolean eslab_claimarena(
+    void *buf)
+{
+    if (buf == OS_NULL || buf != eslab_tlastarena) return OS_FALSE;
+    eslab_tlastarena = OS_NULL;
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if object memory was allocated from arena.
+
+  The eslab_isarena function checks EOBJ_ARENA_MEMORY flag of the object. Memory header is
+  not read, so the object may be also stack, global or otherwise allocated object.
+
+  @param   o Pointer to object.
+  @return  OS_TRUE if memory is from arena.
+
+****************************************************************************************************
+*/
+os_boolean eslab_isarena(
+    eObject *o)
+{
+    return (os_boolean)((o->flags() & EOBJ_ARENA_MEMORY) != 0);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get arena from which object memory was allocated.
+
+  The eslab_arenaof function gets the arena from memory header. The header is read only if
+  object is flagged with EOBJ_ARENA_MEMORY.
+
+  @param   o Pointer to object.
+  @return  Pointer to arena, OS_NULL if memory is not from arena.
+
+****************************************************************************************************
+*/
+eArena *eslab_arenaof(
+    eObject *o)
+{
+    eSlabHeader
+        *h;
+
+    if ((o->flags() & EOBJ_ARENA_MEMORY) == 0) return OS_NULL;
+    h = (eSlabHeader*)((os_char*)o - ESLAB_HEADER_SZ);
+    return h->arena;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get allocation counters.
+
+  The eslab_stats function sums counters of all thread caches. Counters are read without
+  synchronizing with the threads, so the result is approximate while threads are running.
+
+  @param   stats Pointer to structure where to store the counters.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eslab_stats(
+    eSlabStats *stats)
+{
+    eSlabCache
+        *c;
+
+    os_int
+        i;
+
+    os_memclear(stats, sizeof(eSlabStats));
+
+    os_lock();
+    for (c = eglobal->slab.caches; c; c = c->next)
+    {
+        for (i = 0; i < ESLAB_NRO_CLASSES; i++)
+        {
+            stats->cls[i].allocs += c->stats[i].allocs;
+            stats->cls[i].frees += c->stats[i].frees;
+            stats->cls[i].remote_frees += c->stats[i].remote_frees;
+            stats->cls[i].blocks += c->stats[i].blocks;
+        }
+        stats->large_allocs += c->large_allocs;
+        stats->large_frees += c->large_frees;
+    }
+    stats->nro_caches = eglobal->slab.nro_caches;
+    os_unlock();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release memory blocks of all slab caches.
+
+  The eslab_shutdown function frees all memory blocks and caches. This is called by
+  eobjects_shutdown() when all threads have exited and objects have been deleted.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void eslab_shutdown()
+{
+    eSlabCache
+        *c,
+        *next_c;
+
+    eSlabBlock
+        *b,
+        *next_b;
+
+    for (c = eglobal->slab.caches; c; c = next_c)
+    {
+        next_c = c->next;
+        for (b = c->blocks; b; b = next_b)
+        {
+            next_b = b->next;
+            os_free(b, ESLAB_BLOCK_SZ);
+        }
+        os_free(c, sizeof(eSlabCache));
+    }
+
+    eglobal->slab.caches = OS_NULL;
+    eglobal->slab.orphans = OS_NULL;
+    eglobal->slab.nro_caches = 0;
+
+    eslab_tcache = OS_NULL;
+    eslab_thread.cache = OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get cache for calling thread.
+
+  The eslab_newcache function is called when thread allocates memory for the first time. Cache
+  of an exited thread is reused, if any, otherwise new cache is allocated.
+
+  @return  Pointer to thread's cache.
+
+****************************************************************************************************
+*/
+static eSlabCache *eslab_newcache()
+{
+    eSlabCache
+        *c;
+
+    os_lock();
+    c = eglobal->slab.orphans;
+    if (c)
+    {
+        eglobal->slab.orphans = c->next_orphan;
+    }
+    else
+    {
+        c = (eSlabCache*)os_malloc(sizeof(eSlabCache), OS_NULL);
+        os_memclear(c, sizeof(eSlabCache));
+        c->next = eglobal->slab.caches;
+        eglobal->slab.caches = c;
+        eglobal->slab.nro_caches++;
+    }
+    os_unlock();
+
+    eslab_tcache = c;
+    eslab_thread.cache = c;
+    return c;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release cache of exiting thread.
+
+  The eSlabThread destructor is called when a thread exits. The thread's cache is placed to
+  orphan list to be reused by next new thread. Objects still allocated from the cache stay
+  valid, when deleted they are pushed to the cache's remote free list.
+
+****************************************************************************************************
+*/
+eSlabThread::~eSlabThread()
+{
+    if (cache == OS_NULL || !eglobal->initialized) return;
+
+    os_lock();
+    cache->next_orphan = eglobal->slab.orphans;
+    eglobal->slab.orphans = cache;
+    os_unlock();
+
+    eslab_tcache = OS_NULL;
+    cache = OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Split object from memory block.
+
+  The eslab_carve function takes memory for one object of size class cls from cache's current
+  block for the class. If there is no space left, a new block is allocated.
+
+  @param   c Pointer to thread's cache.
+  @param   cls Size class index.
+  @return  Pointer to object memory, including header.
+
+****************************************************************************************************
+*/
+static os_char *eslab_carve(
+    eSlabCache *c,
+    os_int cls)
+{
+    eSlabBlock
+        *b;
+
+    os_char
+        *p;
+
+    os_memsz
+        sz;
+
+    sz = (os_memsz)(cls + 1) * ESLAB_GRANULE;
+    if (c->carve_n[cls] < sz)
+    {
+        b = (eSlabBlock*)os_malloc(ESLAB_BLOCK_SZ, OS_NULL);
+        b->next = c->blocks;
+        c->blocks = b;
+        c->carve_pos[cls] = (os_char*)b + ESLAB_HEADER_SZ;
+        c->carve_n[cls] = ESLAB_BLOCK_SZ - ESLAB_HEADER_SZ;
+        c->stats[cls].blocks++;
+    }
+
+    p = c->carve_pos[cls];
+    c->carve_pos[cls] += sz;
+    c->carve_n[cls] -= sz;
+    return p;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take back objects deleted by other threads.
+
+  The eslab_take_remote function takes whole remote free list of the cache with one atomic
+  exchange and moves objects to free lists by size class.
+
+  @param   c Pointer to thread's cache.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void eslab_take_remote(
+    eSlabCache *c)
+{
+    os_char
+        *p,
+        *next;
+
+    os_int
+        cls;
+
+    if (eatomic_load_ptr((void*volatile*)&c->remote) == OS_NULL) return;
+
+    p = (os_char*)eatomic_exchange_ptr((void*volatile*)&c->remote, OS_NULL);
+    while (p)
+    {
+        next = *(os_char**)(p + ESLAB_HEADER_SZ);
+        cls = (os_int)((eSlabHeader*)p)->n;
+        *(os_char**)(p + ESLAB_HEADER_SZ) = c->free[cls];
+        c->free[cls] = p;
+        p = next;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if memory block can be kept in pool for reuse.
+
+  The eslab_ispoolable function checks from memory header that the block was allocated from
+  slab cache or by os_malloc(), not from an arena, and that it has room for sz bytes. Such
+  block can be kept in a pool, like thread's envelope pool, and released later by eslab_free().
+
+  @param   buf Pointer to memory allocated by eslab_alloc() or eslab_alloc_child().
+  @param   sz Size needed when the block is reused.
+  @return  OS_TRUE if the block can be pooled.
+
+****************************************************************************************************
+*/
+os_boolean eslab_ispoolable(
+    void *buf,
+    os_memsz sz)
+{
+    eSlabHeader
+        *h;
+
+    h = (eSlabHeader*)((os_char*)buf - ESLAB_HEADER_SZ);
+    if (h->n == ESLAB_ARENA_N) return OS_FALSE;
+    if (h->cache == OS_NULL) return (os_boolean)(h->n - ESLAB_HEADER_SZ >= sz);
+    return (os_boolean)((h->n + 1) * ESLAB_GRANULE - ESLAB_HEADER_SZ >= sz);
+}
@@ -0,0 +1,213 @@
+/**
+
+  @file    eslab.h
+  @brief   Thread local slab allocator for objects.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  Objects are small and many of them, like envelopes and temporary variables, are created and
+  deleted at high rate. The slab allocator keeps per thread free lists for each size class, so
+  allocating and freeing an object within a thread needs no synchronization. Memory is taken
+  from operating system in ESLAB_BLOCK_SZ blocks, which are split to objects of one size class.
+
+  Each allocated object is prefixed by a header, which holds the owner cache and size class.
+  When an object is deleted by another thread, it is pushed to owner cache's lock free remote
+  free list. The owner takes remote frees back to it's own free lists when it runs out of
+  free objects. When a thread exits, it's cache is marked orphaned and the next new thread
+  takes it over. Objects larger than ESLAB_MAX_SZ are allocated with os_malloc(). While an
+  arena is set for the thread, memory for objects created within arena root's subtree is
+  taken from the arena instead, see eslab_alloc_child() and earena.h. Arena memory is tagged 
+  in the header and object allocated from arena is flagged with EOBJ_ARENA_MEMORY.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef ESLAB_INCLUDED
+#define ESLAB_INCLUDED
+
+/** Size class granularity, largest object size served from slabs and number of size classes.
+ */
+#define ESLAB_GRANULE 16
+#define ESLAB_MAX_SZ 512
+#define ESLAB_NRO_CLASSES (ESLAB_MAX_SZ / ESLAB_GRANULE)
+
+/** Size of memory block allocated for a size class at once.
+ */
+#define ESLAB_BLOCK_SZ 16384
+
+/** Object header size. Header is placed before the object and it is 16 bytes to keep
+    objects aligned.
+ */
+#define ESLAB_HEADER_SZ 16
+
+struct eSlabCache;
+class eArena;
+class eObject;
+
+/** Counters for one size class.
+ */
+typedef struct eSlabClassStats
+{
+    /** Number of allocations and frees.
+     */
+    os_long allocs;
+    os_long frees;
+
+    /** Number of objects deleted by other thread than the one which allocated it.
+     */
+    os_long remote_frees;
+
+    /** Number of memory blocks allocated.
+     */
+    os_long blocks;
+}
+eSlabClassStats;
+
+/** Slab allocator counters. Class index is (object size + header - 1) / ESLAB_GRANULE.
+ */
+typedef struct eSlabStats
+{
+    eSlabClassStats cls[ESLAB_NRO_CLASSES];
+
+    /** Number of allocations and frees of too large objects, which use os_malloc().
+     */
+    os_long large_allocs;
+    os_long large_frees;
+
+    /** Number of thread caches.
+     */
+    os_int nro_caches;
+}
+eSlabStats;
+
+/** Memory block allocated for slabs, blocks of a cache are linked trough next pointer.
+ */
+typedef struct eSlabBlock
+{
+    struct eSlabBlock *next;
+}
+eSlabBlock;
+
+/** Thread's slab cache.
+ */
+typedef struct eSlabCache
+{
+    /** Free objects of each size class (pointers to headers), linked trough first pointer
+        after the header.
+     */
+    os_char *free[ESLAB_NRO_CLASSES];
+
+    /** Objects deleted by other threads, linked trough first pointer after the header.
+     */
+    os_char *volatile remote;
+
+    /** Unused space in last allocated block of each size class.
+     */
+    os_char *carve_pos[ESLAB_NRO_CLASSES];
+    os_memsz carve_n[ESLAB_NRO_CLASSES];
+
+    /** Memory blocks allocated by this cache.
+     */
+    eSlabBlock *blocks;
+
+    /** Next cache in all caches list and in orphan list.
+     */
+    struct eSlabCache *next;
+    struct eSlabCache *next_orphan;
+
+    /** Counters, written only by the owner thread.
+     */
+    eSlabClassStats stats[ESLAB_NRO_CLASSES];
+    os_long large_allocs;
+    os_long large_frees;
+}
+eSlabCache;
+
+/** Slab allocator state within eglobals. Lists are synchronized by os_lock().
+ */
+typedef struct eSlab
+{
+    /** All thread caches and caches of exited threads.
+     */
+    eSlabCache *caches;
+    eSlabCache *orphans;
+    os_int nro_caches;
+}
+eSlab;
+
+
+/**
+****************************************************************************************************
+
+  @name Slab allocator functions.
+
+  The eObject's new and delete operators call eslab_alloc() and eslab_free().
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/* Allocate memory for an object.
+ */
+void *eslab_alloc(
+    os_memsz sz);
+
+/* Allocate memory for an object to be created as child of parent, from arena if parent is
+   within active arena.
+ */
+void *eslab_alloc_child(
+    os_memsz sz,
+    eObject *parent);
+
+/* Free memory allocated by eslab_alloc().
+ */
+void eslab_free(
+    void *buf);
+
+/* Set arena to allocate objects from for calling thread, returns previous one.
+ */
+eArena *eslab_setarena(
+    eArena *arena);
+
+/* Get calling thread's active arena.
+ */
+eArena *eslab_arena();
+
+/* Check if memory being constructed as object was just allocated from arena.
+ */
+os_boolean eslab_claimarena(
+    void *buf);
+
+/* Check if object memory was allocated from arena.
+ */
+os_boolean eslab_isarena(
+    eObject *o);
+
+/* Get arena from which object memory was allocated, OS_NULL if not from arena.
+ */
+eArena *eslab_arenaof(
+    eObject *o);
+
+/* Check if memory block is from slab cache or os_malloc() and has room for sz bytes.
+ */
+os_boolean eslab_ispoolable(
+    void *buf,
+    os_memsz sz);
+
+/* Get allocation counters summed over all threads.
+ */
+void eslab_stats(
+    eSlabStats *stats);
+
+/* Release memory blocks of all slab caches.
+ */
+void eslab_shutdown();
+
+/*@}*/
+
+#endif
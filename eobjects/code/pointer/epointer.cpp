@@ -114,11 +114,15 @@ eObject *ePointer::get()
      */
     if (m_ref.ref.ucnt <= 0) return OS_NULL;
     
-    handle = eget_handle(m_ref.ref.oix);
-    if (m_ref.ref.ucnt != handle->m_ucnt)
+    /* No locking: Handle tables are never freed, use counter tells if the object
+       has been deleted.
+     */
+    handle = eget_handle_check(m_ref.ref.oix);
+    if (handle == OS_NULL) return OS_NULL;
+    if (m_ref.ref.ucnt != eatomic_load_int((volatile os_int*)&handle->m_ucnt))
     {
         return OS_NULL;
     }
 
-    return handle->object();
+    return (eObject*)eatomic_load_ptr((void*volatile*)&handle->m_object);
 }
@@ -94,7 +94,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
 	{
-		return new ePointer(parent, oid, flags);
+		return new (parent) ePointer(parent, oid, flags);
 	} */
 
     /*@}*/
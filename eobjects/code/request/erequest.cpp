@@ -0,0 +1,228 @@
+/**
+
+  @file    erequest.cpp
+  @brief   Request/reply helper object.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The eObject::request() function sends a message and calls a callback function when reply
+  arrives, instead of sender matching replies in onmessage(). The request message is sent by
+  an eRequest object, which is child of the requesting object: Replies are sent to source
+  path of the request message, so they arrive to the eRequest within requesting object's own
+  thread. Timeout is implemented by timer thread. If the requesting object is deleted before
+  reply, the eRequest is deleted with it and the callback is never called.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Send request message.
+
+  The eObject::request() function sends a message and calls func when reply to it arrives.
+  The callback is called within this object's thread. Any message to source path of the
+  request, except ECMD_TIMER, is considered a reply. The callback must not delete the
+  requesting object, since the request is deleted after the callback returns.
+
+  @param   command Command, like ECMD_SETPROPERTY.
+  @param   target Path to target object.
+  @param   content Message content, OS_NULL if none.
+  @param   func Callback function to call when reply arrives or request times out.
+  @param   prm Parameter passed to callback function.
+  @param   timeout_ms Timeout in milliseconds, 0 for no timeout. Timeout precision is that of
+           eObject::timer().
+  @param   mflags Message flags, like EMSG_DEL_CONTENT. EMSG_NO_REPLIES is ignored.
+  @return  Pointer to request object. The request can be cancelled by deleting it.
+
+****************************************************************************************************
+*/
+eRequest *eObject::request(
+    os_int command, 
+    const os_char *target,
+    eObject *content,
+    eReplyFunc *func,
+    void *prm,
+    os_long timeout_ms,
+    os_int mflags)
+{
+    eRequest *r;
+
+    r = new eRequest(this);
+    r->send(command, target, content, mflags, func, prm, timeout_ms);
+    return r;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Constructor.
+
+  Clear member variables.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+eRequest::eRequest(
+	eObject *parent,
+    e_oid id,
+	os_int flags)
+    : eObject(parent, id, flags)
+{
+    m_func = OS_NULL;
+    m_prm = OS_NULL;
+    m_timer_set = OS_FALSE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Virtual destructor.
+
+  Disable timer, if enabled. If timer message is already on it's way, it is replied with
+  ECMD_NO_TARGET and timer thread removes the timer.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+eRequest::~eRequest()
+{
+    if (m_timer_set)
+    {
+        timer(0);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add eRequest to class list.
+
+  The eRequest::setupclass function adds eRequest to class list. The class list enables 
+  creating new objects dynamically by class identifier, which is used for serialization 
+  functions. It is also used to access class name.
+
+****************************************************************************************************
+*/
+void eRequest::setupclass()
+{
+    const os_int cls = ECLASSID_REQUEST;
+
+    /* Synchronize, add the class to class list.
+     */
+    os_lock();
+    eclasslist_add(cls, (eNewObjFunc)newobj, "eRequest");
+    os_unlock();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Send request message and start waiting for reply.
+
+  The eRequest::send function sends the request message with this object as source, so
+  that replies will be addressed to this object.
+
+  @param   command Command, like ECMD_SETPROPERTY.
+  @param   target Path to target object.
+  @param   content Message content, OS_NULL if none.
+  @param   mflags Message flags.
+  @param   func Callback function.
+  @param   prm Parameter passed to callback function.
+  @param   timeout_ms Timeout in milliseconds, 0 for no timeout.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRequest::send(
+    os_int command, 
+    const os_char *target,
+    eObject *content,
+    os_int mflags,
+    eReplyFunc *func,
+    void *prm,
+    os_long timeout_ms)
+{
+    m_func = func;
+    m_prm = prm;
+
+    message(command, target, OS_NULL, content, mflags & ~EMSG_NO_REPLIES);
+
+    if (timeout_ms > 0)
+    {
+        timer(timeout_ms);
+        m_timer_set = OS_TRUE;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Function to process incoming messages. 
+
+  The eRequest::onmessage function handles reply to request and timer message for timeout.
+  Messages to children are passed to base class.
+
+  @param   envelope Message envelope.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRequest::onmessage(
+    eEnvelope *envelope)
+{
+    if (*envelope->target() != '\0')
+    {
+        eObject::onmessage(envelope);
+        return;
+    }
+
+    if (envelope->command() == ECMD_TIMER)
+    {
+        complete(OS_NULL);
+        return;
+    }
+
+    complete(envelope);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Call callback function and delete this request.
+
+  The eRequest::complete function calls callback with the requesting object (parent) as
+  argument. The request object is deleted after the callback, so the reply envelope can be
+  used only within the callback.
+
+  @param   reply Reply envelope, OS_NULL if request timed out.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRequest::complete(
+    eEnvelope *reply)
+{
+    if (m_func)
+    {
+        m_func(parent(), reply, m_prm);
+    }
+
+    delete this;
+}
@@ -0,0 +1,138 @@
+/**
+
+  @file    erequest.h
+  @brief   Request/reply helper object.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    9.11.2011
+
+  The eObject::request() function sends a message and calls a callback function when reply
+  arrives, instead of sender matching replies in onmessage(). The request message is sent by
+  an eRequest object, which is child of the requesting object: Replies are sent to source
+  path of the request message, so they arrive to the eRequest within requesting object's own
+  thread. Timeout is implemented by timer thread. If the requesting object is deleted before
+  reply, the eRequest is deleted with it and the callback is never called.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef EREQUEST_INCLUDED
+#define EREQUEST_INCLUDED
+
+/**
+****************************************************************************************************
+
+  @brief Request class.
+
+  The eRequest is one pending request. It is created by eObject::request() and deletes itself
+  once reply has been received or request has timed out.
+
+****************************************************************************************************
+*/
+class eRequest : public eObject
+{
+public:
+    /**
+    ************************************************************************************************
+
+      @name Generic object functionality.
+
+      These functions enable using objects of this class as generic eObjects.
+
+    ************************************************************************************************
+    */
+    /*@{*/
+
+    /* Constructor.
+	 */
+	eRequest(
+		eObject *parent = OS_NULL,
+        e_oid id = EOID_INTERNAL,
+		os_int flags = EOBJ_IS_ATTACHMENT);
+
+	/* Virtual destructor.
+ 	 */
+	virtual ~eRequest();
+
+    /* Casting eObject pointer to eRequest pointer.
+     */
+	inline static eRequest *cast(
+		eObject *o) 
+	{ 
+        e_assert_type(o, ECLASSID_REQUEST)
+		return (eRequest*)o;
+	}
+
+    /* Get class identifier.
+     */
+    virtual os_int classid() 
+    {
+        return ECLASSID_REQUEST;
+    }
+
+    /* Static function to add class to class list.
+     */
+    static void setupclass();
+
+	/* Static constructor function.
+	*/
+	static eRequest *newobj(
+		eObject *parent,
+        e_oid id = EOID_INTERNAL,
+		os_int flags = EOBJ_IS_ATTACHMENT)
+	{
+        return new eRequest(parent, id, flags);
+	}
+
+    /* Function to process incoming messages. 
+     */
+    virtual void onmessage(
+        eEnvelope *envelope);
+
+    /*@}*/
+
+	/** 
+	************************************************************************************************
+
+	  @name Request functions
+
+	  Used by eObject::request().
+
+	************************************************************************************************
+	*/
+	/*@{*/
+
+    /* Send request message and start waiting for reply.
+     */
+    void send(
+        os_int command, 
+        const os_char *target,
+        eObject *content,
+        os_int mflags,
+        eReplyFunc *func,
+        void *prm,
+        os_long timeout_ms);
+
+    /*@}*/
+
+protected:
+    /* Call callback function and delete this request.
+     */
+    void complete(
+        eEnvelope *reply);
+
+    /* Callback function and parameter for it.
+     */
+    eReplyFunc *m_func;
+    void *m_prm;
+
+    /* OS_TRUE if timer has been enabled for timeout.
+     */
+    os_boolean m_timer_set;
+};
+
+#endif
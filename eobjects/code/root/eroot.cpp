@@ -38,7 +38,19 @@ eRoot::eRoot(
 	 */
 	m_first_free_handle = OS_NULL;
 	m_free_handle_count = 0;
-	m_reserve_at_once = 1;
+	m_reserve_at_once = 0;
+
+    /* Route cache is allocated when first needed.
+     */
+    m_route_cache = OS_NULL;
+
+    /* Envelope and path buffer pools are initially empty.
+     */
+    m_envelope_pool = OS_NULL;
+    m_envelope_pool_n = 0;
+    os_memclear(m_pathbuf_pool, sizeof(m_pathbuf_pool));
+    os_memclear(m_pathbuf_pool_n, sizeof(m_pathbuf_pool_n));
+    os_memclear(&m_poolstats, sizeof(m_poolstats));
 }
 
 
@@ -55,7 +67,39 @@ eRoot::eRoot(
 */
 eRoot::~eRoot()
 {
-    ehandleroot_releasehandles(m_first_free_handle, m_reserve_at_once);
+    void
+        *p;
+
+    os_char
+        *buf;
+
+    os_int
+        i;
+
+    /* Release envelope and path buffer pools.
+     */
+    while (m_envelope_pool)
+    {
+        p = m_envelope_pool;
+        m_envelope_pool = *(void**)p;
+        eEnvelope::operator delete(p);
+    }
+
+    for (i = 0; i < EROOT_PATHBUF_NRO_CLASSES; i++)
+    {
+        while ((buf = m_pathbuf_pool[i]))
+        {
+            m_pathbuf_pool[i] = *(os_char**)buf;
+            os_free(buf, EROOT_PATHBUF_MIN_SZ << i);
+        }
+    }
+
+    ehandleroot_releasehandles(m_first_free_handle, 0);
+
+    if (m_route_cache)
+    {
+        os_free(m_route_cache, EROOT_ROUTE_CACHE_SZ * sizeof(eRouteCacheEntry));
+    }
 }
 
 
@@ -79,25 +123,25 @@ void eRoot::newhandle(
 	eHandle
 		*handle;
 
-	/* If we have no free handles, allocate more. Incse number of handles to 
-	   allocate at once. 
+    e_oix
+        n;
+
+	/* If we have no free handles, allocate more. Increase number of handles to 
+	   allocate at once each time we run out of handles, up to EROOT_MAX_HANDLE_RESERVE. 
 	 */
 	if (m_first_free_handle == OS_NULL)
 	{
-		if (m_reserve_at_once < 4)
+		if (m_reserve_at_once < EHANDLEROOT_BATCH_SZ)
 		{
-			m_reserve_at_once = 4;
+			m_reserve_at_once = EHANDLEROOT_BATCH_SZ;
 		}
-		else if (m_reserve_at_once < 16)
-		{
-			m_reserve_at_once = 16;
-		}
-		else if (m_reserve_at_once <= 64)
+		else if (m_reserve_at_once < EROOT_MAX_HANDLE_RESERVE)
 		{
 			m_reserve_at_once *= 2;
 		}
-		m_first_free_handle = ehandleroot_reservehandles(m_reserve_at_once);
-		m_free_handle_count += m_reserve_at_once;
+		m_first_free_handle = ehandleroot_reservehandles(m_reserve_at_once, &n);
+		m_free_handle_count += n;
+        m_poolstats.handle_refills++;
 	}
 
 	/* Remove handle to use from chain of free handles.
@@ -117,9 +161,9 @@ void eRoot::newhandle(
         /* handle->m_parent = parent->mm_handle; */
 
 	    /* Save parent object pointer. If parent object is given, join the new object
-	       to red black tree of parent's children.
+	       to parent's children.
 	     */
-        parent->mm_handle->rbtree_insert(handle);
+        parent->mm_handle->insertchild(handle);
 	}
 }
 
@@ -139,9 +183,289 @@ void eRoot::freehandle(
     m_first_free_handle = handle;
     m_free_handle_count++;
 
+    /* If we have too many free handles, release some to global pool and decrease number of
+       handles to allocate at once.
+     */
     if (m_free_handle_count > 2*m_reserve_at_once)
     {
 		m_first_free_handle = ehandleroot_releasehandles(m_first_free_handle, m_reserve_at_once);
         m_free_handle_count -= m_reserve_at_once;
+        m_poolstats.handle_releases++;
+        if (m_reserve_at_once > EHANDLEROOT_BATCH_SZ) m_reserve_at_once /= 2;
     }
 }
+
+
+/**
+****************************************************************************************************
+
+  @brief Find route from route cache.
+
+  The eRoot::routecache_get() function looks for previously resolved route for a name in
+  process name space. Route is valid only if the name space index shard of the name has not 
+  been modified since the route was resolved. Caller must check the generation again while
+  registered as reader of the shard, before using the thread pointer.
+
+  @param   name Pointer to name, does not need to be '\0' terminated.
+  @param   name_n Name length in bytes.
+  @param   hash Hash of the name, see ensindex_hash().
+  @param   generation Current generation of the shard, see ensindex_generation().
+  @return  Pointer to route cache entry, OS_NULL if none.
+
+****************************************************************************************************
+*/
+eRouteCacheEntry *eRoot::routecache_get(
+    const os_char *name,
+    os_memsz name_n,
+    os_uint hash,
+    os_int generation)
+{
+    eRouteCacheEntry
+        *route;
+
+    os_int
+        i;
+
+    if (m_route_cache == OS_NULL) return OS_NULL;
+
+    route = m_route_cache + (hash & (EROOT_ROUTE_CACHE_SZ - 1));
+    if (route->name_n != name_n ||
+        route->hash != hash ||
+        route->generation != generation)
+    {
+        return OS_NULL;
+    }
+
+    for (i = 0; i < name_n; i++)
+    {
+        if (route->name[i] != name[i]) return OS_NULL;
+    }
+
+    return route;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store route in route cache.
+
+  The eRoot::routecache_set() function saves resolved route for a name. Cache is direct
+  mapped by hash, the new route replaces any route stored in the same slot.
+
+  @param   name Pointer to name, does not need to be '\0' terminated.
+  @param   name_n Name length in bytes.
+  @param   hash Hash of the name, see ensindex_hash().
+  @param   generation Generation of the shard before the name was resolved.
+  @param   oixstr Object index string of named object, like "@12_3".
+  @param   thread Thread to which the named object belongs to.
+  @param   is_thread OS_TRUE if named object is the thread itself.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRoot::routecache_set(
+    const os_char *name,
+    os_memsz name_n,
+    os_uint hash,
+    os_int generation,
+    const os_char *oixstr,
+    eThread *thread,
+    os_boolean is_thread)
+{
+    eRouteCacheEntry
+        *route;
+
+    os_memsz
+        sz;
+
+    /* os_strlen() counts terminating '\0', sz is number of characters. Object index string
+       must fit in route->oixstr with it's terminator, so it is never truncated.
+     */
+    sz = os_strlen(oixstr) - 1;
+    if (name_n >= EROOT_ROUTE_NAME_SZ || sz >= E_OIXSTR_BUF_SZ) return;
+
+    if (m_route_cache == OS_NULL)
+    {
+        sz = EROOT_ROUTE_CACHE_SZ * sizeof(eRouteCacheEntry);
+        m_route_cache = (eRouteCacheEntry*)os_malloc(sz, OS_NULL);
+        os_memclear(m_route_cache, sz);
+    }
+
+    route = m_route_cache + (hash & (EROOT_ROUTE_CACHE_SZ - 1));
+    if (oixparse((os_char*)oixstr, &route->oix, &route->ucnt) == 0)
+    {
+        route->name_n = 0;
+        return;
+    }
+
+    route->hash = hash;
+    route->generation = generation;
+    route->name_n = (os_short)name_n;
+    route->thread = thread;
+    route->is_thread = is_thread;
+    os_memcpy(route->name, name, name_n);
+    route->name[name_n] = '\0';
+    os_strncpy(route->oixstr, oixstr, E_OIXSTR_BUF_SZ);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get memory for an envelope from envelope pool.
+
+  The eRoot::envelope_alloc() function takes a memory block of deleted envelope from the pool.
+  Envelope is then constructed in the memory block by placement new.
+
+  @return  Pointer to memory block of sizeof(eEnvelope) bytes, OS_NULL if pool is empty.
+
+****************************************************************************************************
+*/
+void *eRoot::envelope_alloc()
+{
+    void
+        *p;
+
+    p = m_envelope_pool;
+    if (p == OS_NULL)
+    {
+        m_poolstats.envelope_misses++;
+        return OS_NULL;
+    }
+
+    m_envelope_pool = *(void**)p;
+    m_envelope_pool_n--;
+    m_poolstats.envelope_hits++;
+    return p;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Delete envelope and keep it's memory in envelope pool.
+
+  The eRoot::envelope_recycle() function deletes an envelope. Envelope's memory block is kept
+  in pool for reuse, unless the pool is full. The envelope must belong to this root's tree.
+  Only envelopes which memory header marks as slab or heap memory of sufficient size are
+  pooled, envelope allocated from memory arena is deleted normally.
+
+  @param   envelope Envelope to delete.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRoot::envelope_recycle(
+    eEnvelope *envelope)
+{
+    void
+        *p;
+
+    if (m_envelope_pool_n >= EROOT_ENVELOPE_POOL_MAX
+#if E_SLAB_ALLOCATOR
+        || !eslab_ispoolable(envelope, sizeof(eEnvelope))
+#endif
+        )
+    {
+        delete envelope;
+        return;
+    }
+
+    p = envelope;
+    envelope->~eEnvelope();
+
+    *(void**)p = m_envelope_pool;
+    m_envelope_pool = p;
+    m_envelope_pool_n++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Allocate path buffer.
+
+  The eRoot::pathbuf_alloc() function allocates a buffer for envelope's target or source path.
+  Small buffers are rounded up to size class and taken from pool, if available.
+
+  @param   sz Minimum buffer size in bytes.
+  @param   allocated Pointer where to store allocated buffer size.
+  @return  Pointer to buffer.
+
+****************************************************************************************************
+*/
+os_char *eRoot::pathbuf_alloc(
+    os_memsz sz,
+    os_memsz *allocated)
+{
+    os_char
+        *buf;
+
+    os_int
+        i;
+
+    for (i = 0; i < EROOT_PATHBUF_NRO_CLASSES; i++)
+    {
+        if (sz <= (EROOT_PATHBUF_MIN_SZ << i)) break;
+    }
+
+    /* Too large to pool.
+     */
+    if (i == EROOT_PATHBUF_NRO_CLASSES)
+    {
+        m_poolstats.pathbuf_misses++;
+        return os_malloc(sz, allocated);
+    }
+
+    *allocated = EROOT_PATHBUF_MIN_SZ << i;
+    buf = m_pathbuf_pool[i];
+    if (buf == OS_NULL)
+    {
+        m_poolstats.pathbuf_misses++;
+        return os_malloc(*allocated, OS_NULL);
+    }
+
+    m_pathbuf_pool[i] = *(os_char**)buf;
+    m_pathbuf_pool_n[i]--;
+    m_poolstats.pathbuf_hits++;
+    return buf;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release path buffer.
+
+  The eRoot::pathbuf_free() function places path buffer in pool, if it's size matches a size
+  class and the pool is not full. Otherwise the buffer is freed.
+
+  @param   buf Pointer to buffer.
+  @param   sz Buffer size in bytes.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eRoot::pathbuf_free(
+    os_char *buf,
+    os_memsz sz)
+{
+    os_int
+        i;
+
+    for (i = 0; i < EROOT_PATHBUF_NRO_CLASSES; i++)
+    {
+        if (sz == (EROOT_PATHBUF_MIN_SZ << i))
+        {
+            if (m_pathbuf_pool_n[i] >= EROOT_PATHBUF_POOL_MAX) break;
+
+            *(os_char**)buf = m_pathbuf_pool[i];
+            m_pathbuf_pool[i] = buf;
+            m_pathbuf_pool_n[i]++;
+            return;
+        }
+    }
+
+    os_free(buf, sz);
+}
@@ -16,6 +16,88 @@
 #ifndef EROOT_INCLUDED
 #define EROOT_INCLUDED
 
+/** Number of entries in route cache (must be power of two) and maximum length of cached name
+    including terminating '\0'. Longer names are not cached.
+ */
+#define EROOT_ROUTE_CACHE_SZ 64
+#define EROOT_ROUTE_NAME_SZ 32
+
+/** Route cache entry. Maps name in process name space to object index and use counter of
+    named object.
+ */
+typedef struct eRouteCacheEntry
+{
+    /** Hash of the name, see ensindex_hash().
+     */
+    os_uint hash;
+
+    /** Generation of process name space index shard when the route was resolved. Names
+        in other shards do not invalidate the route.
+     */
+    os_int generation;
+
+    /** Object index and use counter of named object.
+     */
+    e_oix oix;
+    os_int ucnt;
+
+    /** Thread to which the named object belongs to. Valid only while registered as reader
+        of the shard and shard generation has not changed.
+     */
+    eThread *thread;
+
+    /** Name length in bytes without terminating '\0', zero if entry is not used.
+     */
+    os_short name_n;
+
+    /** OS_TRUE if named object is thread itself.
+     */
+    os_boolean is_thread;
+
+    /** Name and object index string, like "@12_3".
+     */
+    os_char name[EROOT_ROUTE_NAME_SZ];
+    os_char oixstr[E_OIXSTR_BUF_SZ];
+}
+eRouteCacheEntry;
+
+/** Maximum number of envelopes in envelope pool.
+ */
+#define EROOT_ENVELOPE_POOL_MAX 64
+
+/** Path buffer size classes: 32, 64, 128 and 256 bytes. Larger path buffers are not pooled.
+    Maximum number of buffers kept in pool for each size class.
+ */
+#define EROOT_PATHBUF_NRO_CLASSES 4
+#define EROOT_PATHBUF_MIN_SZ 32
+#define EROOT_PATHBUF_POOL_MAX 64
+
+/** Maximum number of handles root object reserves from global pool at once.
+ */
+#define EROOT_MAX_HANDLE_RESERVE 1024
+
+/** Envelope, path buffer and handle pool counters.
+ */
+typedef struct eRootPoolStats
+{
+    /** Number of allocations served from pool (hits) and from os_malloc() (misses).
+     */
+    os_long envelope_hits;
+    os_long envelope_misses;
+    os_long pathbuf_hits;
+    os_long pathbuf_misses;
+
+    /** Number of free handles held by the root, number of times handles were reserved
+        from and released to global handle pool, and current reserve size.
+     */
+    os_long handles_free;
+    os_long handle_refills;
+    os_long handle_releases;
+    os_long handle_reserve;
+}
+eRootPoolStats;
+
+
 /**
 ****************************************************************************************************
 
@@ -98,6 +180,63 @@ public:
      */
     void freehandle(
         eHandle *handle);
+
+    /* Find route by name from route cache.
+     */
+    eRouteCacheEntry *routecache_get(
+        const os_char *name,
+        os_memsz name_n,
+        os_uint hash,
+        os_int generation);
+
+    /* Store resolved route to route cache.
+     */
+    void routecache_set(
+        const os_char *name,
+        os_memsz name_n,
+        os_uint hash,
+        os_int generation,
+        const os_char *oixstr,
+        eThread *thread,
+        os_boolean is_thread);
+
+    /* Remove route from route cache.
+     */
+    inline void routecache_invalidate(
+        eRouteCacheEntry *route)
+    {
+        route->name_n = 0;
+    }
+
+    /* Get memory for an envelope from envelope pool, OS_NULL if pool is empty.
+     */
+    void *envelope_alloc();
+
+    /* Delete envelope and keep it's memory in envelope pool.
+     */
+    void envelope_recycle(
+        eEnvelope *envelope);
+
+    /* Allocate path buffer.
+     */
+    os_char *pathbuf_alloc(
+        os_memsz sz,
+        os_memsz *allocated);
+
+    /* Release path buffer.
+     */
+    void pathbuf_free(
+        os_char *buf,
+        os_memsz sz);
+
+    /* Get envelope, path buffer and handle pool counters.
+     */
+    inline eRootPoolStats *poolstats()
+    {
+        m_poolstats.handles_free = m_free_handle_count;
+        m_poolstats.handle_reserve = m_reserve_at_once;
+        return &m_poolstats;
+    }
     /*@}*/
 
 protected:
@@ -105,14 +244,36 @@ protected:
 	 */
 	eHandle *m_first_free_handle;
 
-	/** Number of handles to reserve at once. Initially reserve for example two handles at the time,
-	    grow the number when more handles are allocated until maximum limit reached.
+	/** Number of handles to reserve at once. Initially reserve one batch of handles at the time,
+	    grow the number when more handles are allocated until maximum limit reached and shrink
+        it when handles are released.
 	 */
 	os_int m_reserve_at_once;
 
 	/** Number of free handles.
 	 */
 	os_int m_free_handle_count;
+
+    /** Route cache for messages sent trough process name space, allocated when first needed.
+        Only the thread owning this root accesses the cache, so no synchronization is needed.
+     */
+    eRouteCacheEntry *m_route_cache;
+
+    /** Envelope pool: Memory blocks of deleted envelopes, linked trough first pointer
+        in the block, and number of blocks in pool.
+     */
+    void *m_envelope_pool;
+    os_int m_envelope_pool_n;
+
+    /** Path buffer pool for each size class, linked trough first pointer in the
+        buffer, and number of buffers in each pool.
+     */
+    os_char *m_pathbuf_pool[EROOT_PATHBUF_NRO_CLASSES];
+    os_int m_pathbuf_pool_n[EROOT_PATHBUF_NRO_CLASSES];
+
+    /** Pool counters.
+     */
+    eRootPoolStats m_poolstats;
 };
 
 #endif
@@ -37,6 +37,8 @@ eSet::eSet(
 {
     m_items = OS_NULL;
     m_used = m_alloc = 0;
+    m_index = OS_NULL;
+    m_index_n = 0;
 }
 
 
@@ -57,9 +59,10 @@ eSet::~eSet()
      */
     clear();
     
-    /* Release items buffer
+    /* Release items buffer and index.
      */    
     os_free(m_items, m_alloc);
+    os_free(m_index, m_index_n * sizeof(os_int));
 }
 
 
@@ -114,7 +117,7 @@ eObject *eSet::clone(
     os_memsz sz;
     eHandle *handle;
 
-    clonedobj = new eSet(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eSet(parent, id == EOID_CHILD ? oid() : id, flags());
 
     if (m_items)
     {
@@ -122,6 +125,7 @@ eObject *eSet::clone(
         clonedobj->m_used = m_used;
         clonedobj->m_alloc = (os_int)sz;
         os_memcpy(clonedobj->m_items, m_items, m_used);
+        clonedobj->buildindex();
 
         /* Prepare to go trough items.
          */
@@ -388,7 +392,7 @@ eStatus eSet::reader(
                read variable from stream.
              */
             if (stream->getl(&lval)) goto failed;
-            v = new eVariable(this, (e_oid)lval);
+            v = new (this) eVariable(this, (e_oid)lval);
             if (v->reader(stream, flags)) goto failed;
         }
     }
@@ -458,6 +462,8 @@ eStatus eSet::reader(
 
 
 skipit:
+    buildindex();
+
 	/* End the object.
      */
     if (stream->read_end_block()) goto failed;
@@ -472,6 +478,7 @@ failed:
     os_free(m_items, m_alloc);
     m_items = OS_NULL;
     m_alloc = m_used = 0;
+    buildindex();
 
     return ESTATUS_READING_OBJ_FAILED;
 }
@@ -628,7 +635,8 @@ failed:
 
   @brief Store value into set.
 
-  The eSet::set function 
+  The eSet::set function stores value of any type into the set. Integer and double values are
+  packed by setitem_l() and setitem_d(), other types are packed here.
   
   @param  id Identification number (for example property number) for value to store.
   @param  x Variable containing value to store.
@@ -647,15 +655,11 @@ void eSet::set(
 {
     eVariable *v;
     eObject *o, *optr;
-    os_long l;
-    os_double d;
-    os_int i, isz;
-    os_short s;
-    os_schar itype, jtype, c;
-    os_uchar ibytes, jbytes, jid;
-    os_char *p, *e, *q, *sptr, *start;
+    os_int isz;
+    os_schar itype;
+    os_uchar ibytes;
+    os_char *q, *sptr;
     os_memsz sz;
-    const os_int slack = 10;
     void *iptr;
 
     osal_debug_assert(id >= 0);
@@ -677,61 +681,26 @@ void eSet::set(
         goto store_as_var;
     }
 
-    /* Determnine size and type,
+    /* Delete value.
      */
     if (x == OS_NULL)
     {
-        ibytes = -1;
+        removeitem(id);
+        return;
     }
-    else switch (x->type())
+
+    /* Determnine size and type,
+     */
+    isz = 0;
+    switch (x->type())
     {
         case OS_LONG:
-            l = x->getl();
-            if (l >= -0x80 && l <= 0x7F)
-            {
-                itype = OS_CHAR;
-                ibytes = sizeof(os_schar);
-                c = (os_schar)l;
-                iptr = &c;
-            }
-            else if (l >= -0x8000 && l <= 0x7FFF)
-            {
-                itype = OS_SHORT;
-                ibytes = sizeof(os_short);
-                s = (os_short)l;
-                iptr = &s;
-            }
-            else if (l >= -2147483647 && l <= 0x7FFFFFFF) 
-            {
-                itype = OS_INT;
-                ibytes = sizeof(os_int);
-                i = (os_int)l;
-                iptr = &i;
-            }
-            else 
-            {
-                itype = OS_LONG;
-                ibytes = sizeof(os_long);
-                iptr = &l;
-            }
-            break;
+            setitem_l(id, x->getl());
+            return;
 
         case OS_DOUBLE:
-            d = x->getd();
-            itype = OS_DOUBLE;
-            ibytes = sizeof(os_double);
-            iptr = &d;
-            if (d >= -128.0 && d <= 127.0)
-            {
-                if (d == (os_double)x->getl())
-                {
-                    ibytes = sizeof(os_char);
-                    if (d >= 0) c = (os_char)(d+0.5);
-                    else c = -(os_char)(-d+0.5);
-                    iptr = &c;
-                }   
-            }
-            break;
+            setitem_d(id, x->getd());
+            return;
 
         case OS_OBJECT:
             itype = OS_OBJECT;
@@ -774,66 +743,424 @@ void eSet::set(
             break;
     }
 
-    /* Prepare to go trough items.
+    setitem(id, itype, ibytes, iptr, isz);
+    return;
+
+store_as_var:
+    v = new (this) eVariable(this, id);
+    v->setv(x);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store integer value into set.
+
+  The eSet::setl function stores integer value without going trough temporary eVariable.
+  
+  @param  id Identification number (for example property number) for value to store.
+  @param  x Value to store.
+
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setl(
+    os_int id, 
+    os_long x)
+{
+    eVariable v;
+
+    if ((os_uint)id > 255 || firstv(id))
+    {
+        v.setl(x);
+        set(id, &v);
+        return;
+    }
+
+    setitem_l(id, x);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store double value into set.
+
+  The eSet::setd function stores floating point value without going trough temporary eVariable.
+  
+  @param  id Identification number (for example property number) for value to store.
+  @param  x Value to store.
+
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setd(
+    os_int id, 
+    os_double x)
+{
+    eVariable v;
+
+    if ((os_uint)id > 255 || firstv(id))
+    {
+        v.setd(x);
+        set(id, &v);
+        return;
+    }
+
+    setitem_d(id, x);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value from set.
+
+  The eSet::get function 
+  
+  @param  id Identification number (for example property number) for value to store.
+  @param  x Variable containing value to store.
+          - x = OS_NULL -> delete value
+          - x = empty var -> store empty mark;
+  @param  flags Reserved for future, set 0 for now.
+
+  @return Return value can be used between empty value and unset value. This is needed for 
+          properties. OS_TRUE if value was found, even empty one. OS_FALSE if no value for 
+          the ID was found.
+
+****************************************************************************************************
+*/
+os_boolean eSet::get(
+    os_int id,
+    eVariable *x)
+{
+    eVariable *v;
+    eObject *objptr;
+    os_char *p, *strptr;
+    os_uchar ibytes;
+    os_schar itype;
+
+    /* Try first if this value is stored in separate variable.
      */
-    p = m_items;
-    e = p + m_used;
+    v = firstv(id);
+    if (v)
+    {
+        x->setv(v);
+        return OS_TRUE;
+    }
 
-    /* Search id from items until match found.
+    /* Find the item by index. 
      */
-    while (p < e)
+    p = finditem(id);
+    if (p == OS_NULL) goto getout;
+
+    p++;
+    ibytes = *(os_uchar*)(p++);
+    if (ibytes == 0)
+    {
+        x->clear();
+        return OS_TRUE;
+    }
+    itype = *(os_schar*)(p++);
+
+    switch (itype)
+    {
+        case OS_CHAR:
+            x->setl(*(os_schar*)p);
+            break;
+
+        case OS_SHORT:
+            x->setl(*(os_short*)p);
+            break;
+
+        case OS_INT:
+            x->setl(*(os_int*)p);
+            break;
+
+        case OS_LONG:
+            x->setl(*(os_long*)p);
+            break;
+
+        case OS_DOUBLE:
+            if (ibytes == 1)
+                x->setd(*(os_schar*)p);
+            else
+                x->setd(*(os_double*)p);
+            break;
+
+        case OS_STR:
+            x->sets(p, ibytes);
+            break;
+
+        case -OS_STR:
+            strptr = *(os_char**)p;
+            x->sets(strptr);
+            break;
+
+        case OS_OBJECT:
+            objptr = *(eObject**)p;
+            x->seto(objptr);
+            break;
+
+        default:
+            x->clear();
+            break;
+    }
+    return OS_TRUE;
+
+getout:
+    x->clear();
+    return OS_FALSE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value from set as integer.
+
+  The eSet::getl function reads integer value without going trough temporary eVariable. 
+  Double value is rounded like eVariable::getl() does. Strings and objects are converted
+  by eVariable.
+  
+  @param  id Identification number (for example property number) of the value.
+  @return Integer value, 0 if value is not set or is empty.
+
+****************************************************************************************************
+*/
+os_long eSet::getl(
+    os_int id)
+{
+    eVariable v;
+    os_double d;
+    os_char *p;
+    os_uchar ibytes;
+
+    p = finditem(id);
+    if (p == OS_NULL) goto slowpath;
+
+    ibytes = *(os_uchar*)(p + 1);
+    if (ibytes == 0) return 0;
+    p += 3;
+
+    switch (*(os_schar*)(p - 1))
+    {
+        case OS_CHAR:   return *(os_schar*)p;
+        case OS_SHORT:  return *(os_short*)p;
+        case OS_INT:    return *(os_int*)p;
+        case OS_LONG:   return *(os_long*)p;
+
+        case OS_DOUBLE:
+            if (ibytes == 1) return *(os_schar*)p;
+            d = *(os_double*)p;
+            return (os_long)(d >= 0 ? d + 0.5 : d - 0.5);
+
+        default:
+            break;
+    }
+
+    /* Separate variable with this id, string or object.
+     */
+slowpath:
+    get(id, &v);
+    return v.getl();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value from set as double.
+
+  The eSet::getd function reads floating point value without going trough temporary 
+  eVariable. Strings and objects are converted by eVariable.
+  
+  @param  id Identification number (for example property number) of the value.
+  @return Floating point value, 0.0 if value is not set or is empty.
+
+****************************************************************************************************
+*/
+os_double eSet::getd(
+    os_int id)
+{
+    eVariable v;
+    os_char *p;
+    os_uchar ibytes;
+
+    p = finditem(id);
+    if (p == OS_NULL) goto slowpath;
+
+    ibytes = *(os_uchar*)(p + 1);
+    if (ibytes == 0) return 0.0;
+    p += 3;
+
+    switch (*(os_schar*)(p - 1))
+    {
+        case OS_CHAR:   return *(os_schar*)p;
+        case OS_SHORT:  return *(os_short*)p;
+        case OS_INT:    return *(os_int*)p;
+        case OS_LONG:   return (os_double)*(os_long*)p;
+
+        case OS_DOUBLE:
+            if (ibytes == 1) return *(os_schar*)p;
+            return *(os_double*)p;
+
+        default:
+            break;
+    }
+
+    /* Separate variable with this id, string or object.
+     */
+slowpath:
+    get(id, &v);
+    return v.getd();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store integer value as packed item.
+
+  The eSet::setitem_l function selects smallest integer type which can hold the value and
+  stores it. 
+  
+  @param  id Identification number 0 - 255.
+  @param  x Value to store.
+
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setitem_l(
+    os_int id, 
+    os_long x)
+{
+    os_int i;
+    os_short s;
+    os_schar c;
+
+    if (x >= -0x80 && x <= 0x7F)
     {
-        start = p;
-        jid = *(os_uchar*)(p++);
-        jbytes = *(os_uchar*)(p++);
-        if (jbytes) jtype = *(os_uchar*)(p++);
-        else jtype = OS_UNDEFINED_TYPE;
-        if (jid == (os_uchar)id)
+        c = (os_schar)x;
+        setitem(id, OS_CHAR, sizeof(os_schar), &c);
+    }
+    else if (x >= -0x8000 && x <= 0x7FFF)
+    {
+        s = (os_short)x;
+        setitem(id, OS_SHORT, sizeof(os_short), &s);
+    }
+    else if (x >= -2147483647 && x <= 0x7FFFFFFF) 
+    {
+        i = (os_int)x;
+        setitem(id, OS_INT, sizeof(os_int), &i);
+    }
+    else 
+    {
+        setitem(id, OS_LONG, sizeof(os_long), &x);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store double value as packed item.
+
+  The eSet::setitem_d function stores floating point value. Small integral values are
+  stored as one byte.
+  
+  @param  id Identification number 0 - 255.
+  @param  x Value to store.
+
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setitem_d(
+    os_int id, 
+    os_double x)
+{
+    os_schar c;
+
+    if (x >= -128.0 && x <= 127.0 && x == (os_double)(os_schar)x)
+    {
+        c = (os_schar)x;
+        setitem(id, OS_DOUBLE, sizeof(os_schar), &c);
+    }
+    else
+    {
+        setitem(id, OS_DOUBLE, sizeof(os_double), &x);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store packed item.
+
+  The eSet::setitem function overwrites existing item with same id in place, if size 
+  matches. Otherwise existing item is removed and new one is appended to the items buffer.
+  
+  @param  id Identification number 0 - 255.
+  @param  itype Item type, OS_CHAR, OS_SHORT... -OS_STR for allocated string.
+  @param  ibytes Number of value bytes, 0 for empty value.
+  @param  iptr Pointer to value bytes. For -OS_STR pointer to string pointer.
+  @param  isz Allocated string size for -OS_STR, otherwise ignored.
+
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setitem(
+    os_int id,
+    os_schar itype,
+    os_uchar ibytes,
+    void *iptr,
+    os_int isz)
+{
+    os_char *p, *start;
+    os_uchar jbytes;
+    os_memsz sz;
+    const os_int slack = 10;
+
+    /* If there is item with this id already.
+     */
+    start = finditem(id);
+    if (start)
+    {
+        jbytes = *(os_uchar*)(start + 1);
+
+        /* If it is same length, release memory allocated for previous value and 
+           overwrite.
+         */
+        if (ibytes == jbytes)
         {
-            /* Release memory allocated for previous value.
-             */
-            if (jtype == OS_OBJECT) 
-            {
-                delete *(eObject**)p;
-            }
-            else if (jtype == -OS_STR) 
-            {
-                os_free(*(void**)p, *(os_int*)(p + sizeof(os_char*)));
-            }
+            if (ibytes == 0) return;
+            releaseitem(start);
 
-            /* If it is same length
-             */
-            if (ibytes == jbytes)
+            p = start + 2;
+            *(os_schar*)(p++) = itype;
+            if (itype == -OS_STR)
             {
-                /* p = start + 1;
-                *(os_uchar*)(p++) = ibytes; */
-                p = start + 2;
-                if (ibytes == 0) return;
-                *(os_schar*)(p++) = itype;
-
-                os_memcpy(p, iptr, ibytes);
-                if (itype == -OS_STR)
-                {
-                    p += ibytes;
-                    *(os_int*)p = isz;
-                }
-                return;
+                *(os_char**)p = *(os_char**)iptr;
+                *(os_int*)(p + sizeof(os_char*)) = isz;
             }
-
-            /* Different length, remove this entry form m_items buffer.
-             */
-            p += jbytes;
-            if (e != p) 
+            else
             {
-                os_memmove(start, p, e - p); 
+                os_memcpy(p, iptr, ibytes);
             }
-            m_used -= (os_int)(p - start);
-            break;
+            return;
         }
-        p += jbytes;
-    }
 
-    if (x == OS_NULL) return;
+        /* Different length, remove this entry form m_items buffer.
+         */
+        removeitem(id);
+    }
 
     /* If we need to allocate more memory?
      */
@@ -853,8 +1180,9 @@ void eSet::set(
     /* Append new value.
      */
     p = m_items + m_used;
+    setindex(id, m_used);
     *(os_uchar*)(p++) = (os_uchar)id;
-    *(os_uchar*)(p++) = (os_uchar)ibytes;
+    *(os_uchar*)(p++) = ibytes;
     if (ibytes)
     {
         *(os_schar*)(p++) = itype;
@@ -865,140 +1193,168 @@ void eSet::set(
         }
         else
         {
-            ibytes = sizeof(os_char*);
-            os_memcpy(p, iptr, ibytes);
-            p += ibytes;
+            *(os_char**)p = *(os_char**)iptr;
+            p += sizeof(os_char*);
             *(os_int*)p = isz;
             p += sizeof(os_int);
         }
     }
     m_used = (os_int)(p - m_items);
-   return;
-
-store_as_var:
-    v = new eVariable(this, id);
-    v->setv(x);
 }
 
 
 /**
 ****************************************************************************************************
 
-  @brief Get value from set.
+  @brief Remove packed item.
 
-  The eSet::get function 
+  The eSet::removeitem function releases memory allocated for item's value, removes the
+  item from items buffer and adjusts index offsets of items which were after it.
   
-  @param  id Identification number (for example property number) for value to store.
-  @param  x Variable containing value to store.
-          - x = OS_NULL -> delete value
-          - x = empty var -> store empty mark;
-  @param  flags Reserved for future, set 0 for now.
-
-  @return Return value can be used between empty value and unset value. This is needed for 
-          properties. OS_TRUE if value was found, even empty one. OS_FALSE if no value for 
-          the ID was found.
+  @param  id Identification number of the item.
+  @return None.
 
 ****************************************************************************************************
 */
-os_boolean eSet::get(
-    os_int id,
-    eVariable *x)
+void eSet::removeitem(
+    os_int id)
 {
-    eVariable *v;
-    eObject *objptr;
-    os_char *p, *e, *strptr;
-    os_uchar iid, ibytes;
-    os_schar itype;
+    os_char *start, *p, *e;
+    os_int offset, n, i;
+    os_uchar jbytes;
+
+    start = finditem(id);
+    if (start == OS_NULL) return;
+
+    releaseitem(start);
+    jbytes = *(os_uchar*)(start + 1);
+    p = start + 2;
+    if (jbytes) p += jbytes + 1;
+    e = m_items + m_used;
+    if (e != p) 
+    {
+        os_memmove(start, p, e - p); 
+    }
 
-    /* Try first if this value is stored in separate variable.
+    n = (os_int)(p - start);
+    m_used -= n;
+
+    /* Index holds offset + 1. Items after the removed one moved down by n bytes.
      */
-    v = firstv(id);
-    if (v)
+    offset = (os_int)(start - m_items) + 1;
+    m_index[id] = 0;
+    for (i = 0; i < m_index_n; i++)
     {
-        x->setv(v);
-        return OS_TRUE;
+        if (m_index[i] > offset) m_index[i] -= n;
     }
+}
 
-    /* If this ID cannot be presented as unsigned char.
-     */
-    if (id < 0 || id > 255) goto getout;
 
-    /* Prepare to go trough items.
-     */
-    p = m_items;
-    if (p == OS_NULL) goto getout;
-    e = p + m_used;
+/**
+****************************************************************************************************
 
-    /* Search id from items untim match found.
-     */
-    while (p < e)
+  @brief Release memory allocated for item's value.
+
+  The eSet::releaseitem function deletes object or frees long string stored in the item.
+  Item itself is not removed from items buffer.
+  
+  @param  start Pointer to beginning of the item within items buffer.
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::releaseitem(
+    os_char *start)
+{
+    os_char *p;
+
+    if (*(os_uchar*)(start + 1) == 0) return;
+    p = start + 3;
+
+    switch (*(os_schar*)(start + 2))
     {
-        iid = *(os_uchar*)(p++);
-        ibytes = *(os_uchar*)(p++);
-        if (iid == (os_uchar)id)
+        case OS_OBJECT:
+            delete *(eObject**)p;
+            break;
+
+        case -OS_STR:
+            os_free(*(void**)p, *(os_int*)(p + sizeof(os_char*)));
+            break;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set item offset in index.
+
+  The eSet::setindex function stores item's offset within items buffer into direct mapped 
+  index. The index is allocated to cover ids up to highest id used, and grown as needed.
+  
+  @param  id Identification number of the item, 0 - 255.
+  @param  offset Offset of the item within m_items.
+  @return None.
+
+****************************************************************************************************
+*/
+void eSet::setindex(
+    os_int id,
+    os_int offset)
+{
+    os_int *newindex, n;
+
+    if (id >= m_index_n)
+    {
+        n = (id | 15) + 1;
+        newindex = (os_int*)os_malloc(n * sizeof(os_int), OS_NULL);
+        os_memclear(newindex, n * sizeof(os_int));
+        if (m_index)
         {
-            if (ibytes == 0)
-            {
-                x->clear();
-                return OS_TRUE;
-            }
-            itype = *(os_schar*)(p++);
+            os_memcpy(newindex, m_index, m_index_n * sizeof(os_int));
+            os_free(m_index, m_index_n * sizeof(os_int));
+        }
+        m_index = newindex;
+        m_index_n = n;
+    }
 
-            switch (itype)
-            {
-                case OS_CHAR:
-                    x->setl(*(os_schar*)p);
-                    break;
+    m_index[id] = offset + 1;
+}
 
-                case OS_SHORT:
-                    x->setl(*(os_short*)p);
-                    break;
 
-                case OS_INT:
-                    x->setl(*(os_int*)p);
-                    break;
+/**
+****************************************************************************************************
 
-                case OS_LONG:
-                    x->setl(*(os_long*)p);
-                    break;
+  @brief Rebuild index from items buffer.
 
-                case OS_DOUBLE:
-                    if (ibytes == 1)
-                        x->setd(*(os_schar*)p);
-                    else
-                        x->setd(*(os_double*)p);
-                    break;
+  The eSet::buildindex function clears the index and sets it up by walking trough items. 
+  This is used after items buffer has been read from stream.
 
-                case OS_STR:
-                    x->sets(p, ibytes);
-                    break;
+  @return None.
 
-                case -OS_STR:
-                    strptr = *(os_char**)p;
-                    x->sets(strptr);
-                    break;
+****************************************************************************************************
+*/
+void eSet::buildindex()
+{
+    os_char *p, *e;
+    os_uchar ibytes;
 
-                case OS_OBJECT:
-                    objptr = *(eObject**)p;
-                    x->seto(objptr);
-                    break;
+    if (m_index)
+    {
+        os_memclear(m_index, m_index_n * sizeof(os_int));
+    }
 
-                default:
-                    x->clear();
-                    break;
-            }
-                
-            return OS_TRUE;
-        }
+    p = m_items;
+    if (p == OS_NULL) return;
+    e = p + m_used;
 
+    while (p < e)
+    {
+        setindex(*(os_uchar*)p, (os_int)(p - m_items));
+        ibytes = *(os_uchar*)(p + 1);
+        p += 2;
         if (ibytes) p += ibytes + 1;
-    }        
-
-    /* comtinues ...
-     */
-getout:
-    x->clear();
-    return OS_FALSE;
+    }
 }
 
 /**
@@ -1057,4 +1413,8 @@ void eSet::clear()
     }        
 
     m_used = 0;
+    if (m_index)
+    {
+        os_memclear(m_index, m_index_n * sizeof(os_int));
+    }
 }
@@ -88,7 +88,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eSet(parent, id, flags);
+        return new (parent) eSet(parent, id, flags);
     }
 
     /* Write set content to stream.
@@ -133,27 +133,17 @@ public:
         eVariable *x,
         os_int sflags = 0);
 
-    /* Store value into set.
+    /* Store integer value into set.
      */
-    inline void setl(
+    void setl(
         os_int id, 
-        os_long x)
-    {
-        eVariable v;
-        v.setl(x);
-        set(id, &v); // ??????????? CHECK SHOULD FLAGS BE ADDED
-    }
+        os_long x);
 
-    /* Store value into set.
+    /* Store double value into set.
      */
-    inline void setd(
+    void setd(
         os_int id, 
-        os_double x)
-    {
-        eVariable v;
-        v.setd(x);
-        set(id, &v);
-    }
+        os_double x);
 
     /* Store value into set.
      */
@@ -174,23 +164,13 @@ public:
 
     /* Get value as integer.
      */
-    inline os_long getl(
-        os_int id)
-    {
-        eVariable v;
-        get(id, &v);
-        return v.getl();
-    }
+    os_long getl(
+        os_int id);
 
     /* Get value as double.
      */
-    inline os_double getd(
-        os_int id)
-    {
-        eVariable v;
-        get(id, &v);
-        return v.getd();
-    }
+    os_double getd(
+        os_int id);
 
     /* Clear the set.
      */
@@ -199,6 +179,50 @@ public:
     /*@}*/
 
 protected:
+    /* Find item by index, returns pointer to beginning of item or OS_NULL if none.
+     */
+    inline os_char *finditem(
+        os_int id)
+    {
+        if ((os_uint)id >= (os_uint)m_index_n || m_index[id] == 0) return OS_NULL;
+        return m_items + m_index[id] - 1;
+    }
+
+    /* Store integer or double value as packed item.
+     */
+    void setitem_l(
+        os_int id, 
+        os_long x);
+
+    void setitem_d(
+        os_int id, 
+        os_double x);
+
+    /* Store packed item.
+     */
+    void setitem(
+        os_int id,
+        os_schar itype,
+        os_uchar ibytes,
+        void *iptr,
+        os_int isz = 0);
+
+    /* Remove packed item, release memory allocated for item's value.
+     */
+    void removeitem(
+        os_int id);
+
+    void releaseitem(
+        os_char *start);
+
+    /* Maintain index.
+     */
+    void setindex(
+        os_int id,
+        os_int offset);
+
+    void buildindex();
+
     /* Buffer containing items
      */
     os_char *m_items;
@@ -210,6 +234,15 @@ protected:
     /* Buffer allocated, bytes.
      */
     os_int m_alloc;
+
+    /* Direct mapped index by item id, offset of item in m_items + 1. Zero if there is no
+       item with the id. Allocated to cover highest id used, up to 255.
+     */
+    os_int *m_index;
+
+    /* Number of entries in m_index.
+     */
+    os_int m_index_n;
 };
 
 #endif
@@ -80,7 +80,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eTable(parent, id, flags);
+        return new (parent) eTable(parent, id, flags);
     }
 
     /*@}*/
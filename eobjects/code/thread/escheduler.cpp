@@ -0,0 +1,582 @@
+/**
+
+  @file    escheduler.cpp
+  @brief   Worker thread pool running eThread objects as actors.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Threads started with ETHREAD_SCHEDULED flag do not get an operating system thread of their
+  own. Instead messages to such thread are processed by a fixed pool of worker threads: When
+  a message is queued to idle thread, the thread is placed in injection queue, from where a
+  worker takes it to it's own deque and calls alive() to process the messages. Idle workers
+  steal threads from other worker's deques. A thread is never run by two workers at the same
+  time. Scheduler state is stored in eScheduler structure within eglobals.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+
+/* Forward referred static functions. Functions which access eThread's scheduler state are
+   not static, since these are eThread's friends.
+ */
+static void escheduler_worker_func(
+    void *prm,
+    osalEvent done);
+
+eThread *escheduler_next(
+    eSchedulerWorker *w);
+
+void escheduler_run(
+    eSchedulerWorker *w,
+    eThread *thread);
+
+void escheduler_inject(
+    eThread *thread);
+
+static os_boolean escheduler_push(
+    eSchedulerWorker *w,
+    eThread *thread);
+
+static eThread *escheduler_pop(
+    eSchedulerWorker *w);
+
+static eThread *escheduler_steal(
+    eSchedulerWorker *w);
+
+
+/**
+****************************************************************************************************
+
+  @brief Start worker threads.
+
+  The escheduler_start function allocates worker structures and starts worker threads. After
+  this threads can be started with ETHREAD_SCHEDULED flag. Does nothing if the scheduler is
+  already running.
+
+  @param   nro_workers Number of worker threads, 1 ... ESCHEDULER_MAX_WORKERS.
+  @return  None.
+
+****************************************************************************************************
+*/
+void escheduler_start(
+    os_int nro_workers)
+{
+    eScheduler
+        *sched;
+
+    eSchedulerWorker
+        *w;
+
+    os_memsz
+        sz;
+
+    os_int
+        i;
+
+    sched = &eglobal->sched;
+    if (sched->running) return;
+
+    if (nro_workers < 1) nro_workers = 1;
+    if (nro_workers > ESCHEDULER_MAX_WORKERS) nro_workers = ESCHEDULER_MAX_WORKERS;
+
+    os_memclear(sched, sizeof(eScheduler));
+    sz = nro_workers * sizeof(eSchedulerWorker);
+    sched->worker = (eSchedulerWorker*)os_malloc(sz, &sched->worker_alloc);
+    if (sched->worker == OS_NULL) return;
+    os_memclear(sched->worker, sched->worker_alloc);
+    sched->nro_workers = nro_workers;
+    sched->wakeup = osal_event_create();
+
+    for (i = 0; i < nro_workers; i++)
+    {
+        w = sched->worker + i;
+        w->nr = i;
+        w->steal_pos = i + 1;
+        w->handle = osal_thread_create(escheduler_worker_func, w, OSAL_THREAD_ATTACHED,
+            0, "eworker");
+    }
+
+    eatomic_store_int(&sched->running, OS_TRUE);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Stop worker threads.
+
+  The escheduler_stop function requests worker threads to exit, waits for them to exit and
+  releases worker structures. All scheduled threads should have been terminated and joined
+  before calling this function: Threads still waiting in queues are not run anymore.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void escheduler_stop()
+{
+    eScheduler
+        *sched;
+
+    os_int
+        i;
+
+    sched = &eglobal->sched;
+    if (!sched->running) return;
+
+#if OSAL_DEBUG
+    if (eatomic_load_int(&sched->nro_threads))
+    {
+        osal_debug_error("escheduler_stop: scheduled threads still running");
+    }
+#endif
+
+    eatomic_store_int(&sched->running, OS_FALSE);
+    eatomic_store_int(&sched->stop, OS_TRUE);
+
+    for (i = 0; i < sched->nro_workers; i++)
+    {
+        osal_event_set(sched->wakeup);
+    }
+    for (i = 0; i < sched->nro_workers; i++)
+    {
+        /* Set event again, it wakes up only one worker at a time.
+         */
+        osal_event_set(sched->wakeup);
+        osal_thread_join(sched->worker[i].handle);
+    }
+
+    osal_event_delete(sched->wakeup);
+    os_free(sched->worker, sched->worker_alloc);
+    os_memclear(sched, sizeof(eScheduler));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if worker threads are running.
+
+  The escheduler_running function checks if threads can be started with ETHREAD_SCHEDULED flag.
+
+  @return  OS_TRUE if scheduler is running.
+
+****************************************************************************************************
+*/
+os_boolean escheduler_running()
+{
+    return (os_boolean)eatomic_load_int(&eglobal->sched.running);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Mark thread runnable.
+
+  The escheduler_notify function is called when a message is queued to empty mailbox of
+  scheduled thread. If the thread is idle, it is placed in injection queue. If the thread is
+  being run by a worker, the worker is told to run it again once done. If the thread is
+  already queued, nothing needs to be done.
+
+  @param   thread Pointer to scheduled thread.
+  @return  None.
+
+****************************************************************************************************
+*/
+void escheduler_notify(
+    eThread *thread)
+{
+    os_int
+        state;
+
+    while (OS_TRUE)
+    {
+        state = eatomic_load_int(&thread->m_sched_state);
+        switch (state)
+        {
+            case ESCHED_IDLE:
+                if (eatomic_cas_int(&thread->m_sched_state, ESCHED_IDLE, ESCHED_QUEUED))
+                {
+                    escheduler_inject(thread);
+                    return;
+                }
+                break;
+
+            case ESCHED_RUNNING:
+                if (eatomic_cas_int(&thread->m_sched_state, ESCHED_RUNNING,
+                    ESCHED_RUNNING_AGAIN))
+                {
+                    return;
+                }
+                break;
+
+            default:
+                return;
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Worker thread entry point.
+
+  The escheduler_worker_func function runs threads until the scheduler is stopped. When there
+  is nothing to run, the worker sleeps until woken up or ESCHEDULER_IDLE_WAIT_MS has elapsed.
+
+  @param   prm Pointer to worker structure.
+  @param   done Event to set when worker has started.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void escheduler_worker_func(
+    void *prm,
+    osalEvent done)
+{
+    eScheduler
+        *sched;
+
+    eSchedulerWorker
+        *w;
+
+    eThread
+        *thread;
+
+    /* Worker structure stays in place until worker has been joined.
+     */
+    w = (eSchedulerWorker*)prm;
+    sched = &eglobal->sched;
+    osal_event_set(done);
+
+    while (!eatomic_load_int(&sched->stop))
+    {
+        thread = escheduler_next(w);
+        if (thread)
+        {
+            escheduler_run(w, thread);
+            continue;
+        }
+
+        /* Nothing to do. Count this worker idle before checking injection queue once
+           more, so that escheduler_inject() either sees this worker idle or this worker
+           sees the injected thread.
+         */
+        eatomic_add_int(&sched->nro_idle, 1);
+        if (eatomic_load_ptr((void*volatile*)&sched->inject) == OS_NULL &&
+            !eatomic_load_int(&sched->stop))
+        {
+            osal_event_wait(sched->wakeup, ESCHEDULER_IDLE_WAIT_MS);
+        }
+        eatomic_add_int(&sched->nro_idle, -1);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get next thread to run.
+
+  The escheduler_next function pops thread from worker's own deque. If the deque is empty,
+  it takes all threads from injection queue: The first one is run and the rest are pushed to
+  own deque for this or other workers to run. If injection queue is empty too, the worker tries
+  to steal from other workers.
+
+  @param   w Pointer to worker structure.
+  @return  Thread to run, OS_NULL if none.
+
+****************************************************************************************************
+*/
+eThread *escheduler_next(
+    eSchedulerWorker *w)
+{
+    eScheduler
+        *sched;
+
+    eThread
+        *thread,
+        *list,
+        *next;
+
+    os_boolean
+        pushed;
+
+    thread = escheduler_pop(w);
+    if (thread) return thread;
+
+    sched = &eglobal->sched;
+    thread = (eThread*)eatomic_exchange_ptr((void*volatile*)&sched->inject, OS_NULL);
+    if (thread)
+    {
+        /* Reverse the list, so that threads are run in order they became runnable.
+         */
+        list = OS_NULL;
+        while (thread)
+        {
+            next = thread->m_sched_next;
+            thread->m_sched_next = list;
+            list = thread;
+            thread = next;
+        }
+
+        thread = list;
+        list = thread->m_sched_next;
+        thread->m_sched_next = OS_NULL;
+
+        pushed = OS_FALSE;
+        while (list)
+        {
+            next = list->m_sched_next;
+            list->m_sched_next = OS_NULL;
+            if (escheduler_push(w, list))
+            {
+                pushed = OS_TRUE;
+            }
+            else
+            {
+                escheduler_inject(list);
+            }
+            list = next;
+        }
+
+        /* Wake up sleeping worker to steal from this deque.
+         */
+        if (pushed && eatomic_load_int(&sched->nro_idle))
+        {
+            osal_event_set(sched->wakeup);
+        }
+
+        return thread;
+    }
+
+    return escheduler_steal(w);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Run a thread.
+
+  The escheduler_run function processes messages queued to thread by calling it's run()
+  function, which for scheduled thread processes queued messages and returns. Scheduled thread
+  may not override run(), this is checked by debug assert. If exit has been requested,
+  the thread is finished and deleted like thread with dedicated operating system thread would
+  be. Otherwise the thread is marked idle, or pushed back to worker's deque if more messages
+  were queued while it was running.
+
+  @param   w Pointer to worker structure.
+  @param   thread Pointer to thread to run, state ESCHED_QUEUED.
+  @return  None.
+
+****************************************************************************************************
+*/
+void escheduler_run(
+    eSchedulerWorker *w,
+    eThread *thread)
+{
+    osalEvent
+        done;
+
+    eatomic_store_int(&thread->m_sched_state, ESCHED_RUNNING);
+
+    thread->m_sched_default_run = OS_FALSE;
+    thread->run();
+    osal_debug_assert(thread->m_sched_default_run);
+
+    if (thread->exitnow())
+    {
+        done = thread->m_sched_done;
+        thread->finish();
+        delete thread;
+        eatomic_add_int(&eglobal->sched.nro_threads, -1);
+        if (done) osal_event_set(done);
+        return;
+    }
+
+    if (eatomic_cas_int(&thread->m_sched_state, ESCHED_RUNNING, ESCHED_IDLE)) return;
+
+    /* Messages were queued while running, state is ESCHED_RUNNING_AGAIN.
+     */
+    eatomic_store_int(&thread->m_sched_state, ESCHED_QUEUED);
+    if (!escheduler_push(w, thread))
+    {
+        escheduler_inject(thread);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add thread to injection queue.
+
+  The escheduler_inject function adds a thread to injection queue with atomic compare and swap
+  and wakes up a sleeping worker, if any.
+
+  @param   thread Pointer to thread, state ESCHED_QUEUED.
+  @return  None.
+
+****************************************************************************************************
+*/
+void escheduler_inject(
+    eThread *thread)
+{
+    eScheduler
+        *sched;
+
+    eThread
+        *head;
+
+    sched = &eglobal->sched;
+    do
+    {
+        head = (eThread*)eatomic_load_ptr((void*volatile*)&sched->inject);
+        thread->m_sched_next = head;
+    }
+    while (!eatomic_cas_ptr((void*volatile*)&sched->inject, head, thread));
+
+    if (eatomic_load_int(&sched->nro_idle))
+    {
+        osal_event_set(sched->wakeup);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Push thread to bottom of worker's deque.
+
+  The escheduler_push function can be called only by the owner worker.
+
+  @param   w Pointer to worker structure.
+  @param   thread Pointer to thread.
+  @return  OS_TRUE if successfull, OS_FALSE if the deque is full.
+
+****************************************************************************************************
+*/
+static os_boolean escheduler_push(
+    eSchedulerWorker *w,
+    eThread *thread)
+{
+    os_int
+        b,
+        t;
+
+    b = eatomic_load_int(&w->bottom);
+    t = eatomic_load_int(&w->top);
+    if (b - t >= ESCHEDULER_DEQUE_SZ) return OS_FALSE;
+
+    eatomic_store_ptr((void*volatile*)&w->slot[b & (ESCHEDULER_DEQUE_SZ - 1)], thread);
+    eatomic_store_int(&w->bottom, b + 1);
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Pop thread from bottom of worker's deque.
+
+  The escheduler_pop function can be called only by the owner worker. Bottom is decremented
+  by atomic add to get full memory barrier before reading top. If only one thread is left in
+  the deque, the owner competes with stealers for it by compare and swap on top.
+
+  @param   w Pointer to worker structure.
+  @return  Pointer to thread, OS_NULL if the deque is empty.
+
+****************************************************************************************************
+*/
+static eThread *escheduler_pop(
+    eSchedulerWorker *w)
+{
+    eThread
+        *thread;
+
+    os_int
+        b,
+        t;
+
+    b = eatomic_add_int(&w->bottom, -1);
+    t = eatomic_load_int(&w->top);
+
+    if (t > b)
+    {
+        eatomic_store_int(&w->bottom, b + 1);
+        return OS_NULL;
+    }
+
+    thread = (eThread*)eatomic_load_ptr((void*volatile*)&w->slot[b & (ESCHEDULER_DEQUE_SZ - 1)]);
+    if (t == b)
+    {
+        if (!eatomic_cas_int(&w->top, t, t + 1))
+        {
+            thread = OS_NULL;
+        }
+        eatomic_store_int(&w->bottom, b + 1);
+    }
+
+    return thread;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Steal a thread from other worker.
+
+  The escheduler_steal function tries to take one thread from top of other workers' deques,
+  starting from the worker after the one last tried.
+
+  @param   w Pointer to worker structure of stealing worker.
+  @return  Pointer to thread, OS_NULL if nothing was stolen.
+
+****************************************************************************************************
+*/
+static eThread *escheduler_steal(
+    eSchedulerWorker *w)
+{
+    eScheduler
+        *sched;
+
+    eSchedulerWorker
+        *victim;
+
+    eThread
+        *thread;
+
+    os_int
+        i,
+        b,
+        t;
+
+    sched = &eglobal->sched;
+    for (i = 0; i < sched->nro_workers; i++)
+    {
+        victim = sched->worker + (w->steal_pos++ % sched->nro_workers);
+        if (victim == w) continue;
+
+        t = eatomic_load_int(&victim->top);
+        b = eatomic_load_int(&victim->bottom);
+        if (t >= b) continue;
+
+        thread = (eThread*)eatomic_load_ptr(
+            (void*volatile*)&victim->slot[t & (ESCHEDULER_DEQUE_SZ - 1)]);
+        if (eatomic_cas_int(&victim->top, t, t + 1))
+        {
+            return thread;
+        }
+    }
+
+    return OS_NULL;
+}
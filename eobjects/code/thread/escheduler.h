@@ -0,0 +1,165 @@
+/**
+
+  @file    escheduler.h
+  @brief   Worker thread pool running eThread objects as actors.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Threads started with ETHREAD_SCHEDULED flag do not get an operating system thread of their
+  own. Instead messages to such thread are processed by a fixed pool of worker threads: When
+  a message is queued to idle thread, the thread is placed in injection queue, from where a
+  worker takes it to it's own deque and calls alive() to process the messages. Idle workers
+  steal threads from other worker's deques. A thread is never run by two workers at the same
+  time. Scheduler state is stored in eScheduler structure within eglobals.
+
+  Only threads which use default eThread::run() loop can be scheduled. Threads which block
+  in their own run() function, like eEndPoint and eConnection, need dedicated thread. This
+  is checked by debug asserts in escheduler_run() and eThread::alive().
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef ESCHEDULER_INCLUDED
+#define ESCHEDULER_INCLUDED
+
+class eThread;
+
+/** Number of thread slots in each worker's deque, must be power of two.
+ */
+#define ESCHEDULER_DEQUE_SZ 256
+
+/** Maximum and default number of worker threads.
+ */
+#define ESCHEDULER_MAX_WORKERS 64
+#define ESCHEDULER_DEFAULT_WORKERS 4
+
+/** Maximum time for idle worker to sleep before checking other worker's deques, ms.
+ */
+#define ESCHEDULER_IDLE_WAIT_MS 20
+
+/** Scheduling states of a thread, see eThread::m_sched_state.
+ */
+#define ESCHED_IDLE 0
+#define ESCHED_QUEUED 1
+#define ESCHED_RUNNING 2
+#define ESCHED_RUNNING_AGAIN 3
+
+
+/**
+****************************************************************************************************
+
+  @name Scheduler structures.
+
+  Workers are allocated as one array when the scheduler is started.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/** Worker thread state. The deque is Chase-Lev work stealing deque: Owner worker pushes and
+    pops threads at bottom, other workers steal from top.
+ */
+typedef struct eSchedulerWorker
+{
+    /** Deque top (steal end) and bottom (owner end) positions.
+     */
+    volatile os_int top;
+    volatile os_int bottom;
+
+    /** Thread slots, position & (ESCHEDULER_DEQUE_SZ - 1).
+     */
+    eThread *volatile slot[ESCHEDULER_DEQUE_SZ];
+
+    /** Worker number, 0 ... nro_workers - 1.
+     */
+    os_int nr;
+
+    /** Next worker to try to steal from.
+     */
+    os_int steal_pos;
+
+    /** Operating system thread handle.
+     */
+    osalThreadHandle *handle;
+
+    /** Padding to keep workers in separate cache lines.
+     */
+    os_char pad[32];
+}
+eSchedulerWorker;
+
+/** Scheduler.
+ */
+typedef struct eScheduler
+{
+    /** OS_TRUE when worker threads are running and threads can be scheduled.
+     */
+    volatile os_int running;
+
+    /** Set to request worker threads to exit.
+     */
+    volatile os_int stop;
+
+    /** Number of worker threads and array of workers.
+     */
+    os_int nro_workers;
+    eSchedulerWorker *worker;
+    os_memsz worker_alloc;
+
+    /** Threads which became runnable, linked trough eThread::m_sched_next, the most recently
+        added first. Workers take whole list at once.
+     */
+    eThread *volatile inject;
+
+    /** Number of workers sleeping, and event to wake up one of those.
+     */
+    volatile os_int nro_idle;
+    osalEvent wakeup;
+
+    /** Number of scheduled threads which have not exited.
+     */
+    volatile os_int nro_threads;
+}
+eScheduler;
+
+/*@}*/
+
+
+/**
+****************************************************************************************************
+
+  @name Scheduler functions.
+
+  The application starts the scheduler after eobjects_initialize() and stops it after all
+  scheduled threads have been terminated and joined.
+
+****************************************************************************************************
+*/
+/*@{*/
+
+/* Start worker threads.
+ */
+void escheduler_start(
+    os_int nro_workers = ESCHEDULER_DEFAULT_WORKERS);
+
+/* Stop worker threads.
+ */
+void escheduler_stop();
+
+/* Check if worker threads are running.
+ */
+os_boolean escheduler_running();
+
+/* Mark thread runnable, called when message is queued to scheduled thread.
+ */
+void escheduler_notify(
+    eThread *thread);
+
+/*@}*/
+
+#endif
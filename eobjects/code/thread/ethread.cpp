@@ -17,6 +17,15 @@
 */
 #include "eobjects/eobjects.h"
 
+/* Thread property names.
+ */
+os_char
+    ethreadp_queue_limit[] = "queuelimit",
+    ethreadp_queue_policy[] = "queuepolicy",
+    ethreadp_queue_depth[] = "queuedepth",
+    ethreadp_queue_peak[] = "queuepeak",
+    ethreadp_queue_rate[] = "queuerate";
+
 /** Parameter structure for creating thread.
  */
 typedef struct
@@ -61,12 +70,36 @@ eThread::eThread(
      */
     m_trigger = osal_event_create();
 
-    /* Create message queue for incoming messages. This is not child of the thread object.
+    /* Mailbox for incoming messages is initially empty.
      */
-    m_message_queue = new eContainer(OS_NULL, EOID_INTERNAL,
-        EOBJ_IS_ATTACHMENT|EOBJ_NOT_CLONABLE|EOBJ_NOT_SERIALIZABLE);
+    m_mailbox[ETHREAD_LANE_HIGH] = m_mailbox[ETHREAD_LANE_NORMAL] = OS_NULL;
+    m_pending = OS_NULL;
+    m_lane_depth[ETHREAD_LANE_HIGH] = m_lane_depth[ETHREAD_LANE_NORMAL] = 0;
+
+    /* Message queue is unlimited by default.
+     */
+    m_queue_limit = 0;
+    m_queue_policy = ETHREAD_OVERFLOW_BLOCK;
+    m_drop_oldest = 0;
+    m_space_event = osal_event_create();
+    m_queue_waiters = 0;
+    m_closing = OS_FALSE;
+    m_queue_peak = 0;
+    m_enqueued = 0;
+    m_rate_count = 0;
+    m_rate = 0.0;
+    os_get_timer(&m_rate_timer);
 
     m_exit_requested = OS_FALSE;
+    m_bindingmux = OS_NULL;
+
+    /* Not scheduled until started with ETHREAD_SCHEDULED flag.
+     */
+    m_scheduled = OS_FALSE;
+    m_sched_state = ESCHED_IDLE;
+    m_sched_next = OS_NULL;
+    m_sched_done = OS_NULL;
+    m_sched_default_run = OS_FALSE;
 }
 
 
@@ -85,9 +118,64 @@ eThread::eThread(
 */
 eThread::~eThread()
 {
-    /*Detete the message queue. Not child of the tread, so this needs to be deleted explicitely.
+    eEnvelope
+        *envelope,
+        *next;
+
+    os_int
+        lane;
+
+    /* Detach names of this thread's objects from process name space and wait until no other
+       thread can be queuing messages trough pointer found from the process name space index.
+     */
+    map(E_DETACH_FROM_NAMESPACES_ABOVE);
+    ensindex_synchronize();
+
+    /* Delete envelopes left in mailbox. These are not children of the thread, adopt
+       each to the thread first so that handles are released to this thread's root.
+     */
+    for (lane = 0; lane <= ETHREAD_NRO_LANES; lane++)
+    {
+        if (lane < ETHREAD_NRO_LANES)
+        {
+            envelope = mailbox_take(lane);
+        }
+        else
+        {
+            envelope = m_pending;
+            m_pending = OS_NULL;
+        }
+
+        while (envelope)
+        {
+            next = envelope->m_mailbox_next;
+            adopt(envelope, EOID_CHILD, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+            delete envelope;
+            envelope = next;
+        }
+    }
+
+    /* Release values which binding multiplexer has not sent.
+     */
+    delete m_bindingmux;
+    m_bindingmux = OS_NULL;
+
+    /* Release senders waiting for space in queue. Closing flag set under process mutex 
+       keeps new senders from starting to wait. Waiters remove themselves with process mutex
+       locked, so once the count is zero no sender accesses this thread.
      */
-    delete m_message_queue;
+    os_lock();
+    m_closing = OS_TRUE;
+    eatomic_store_int(&m_queue_limit, 0);
+    while (eatomic_load_int(&m_queue_waiters) > 0)
+    {
+        osal_event_set(m_space_event);
+        os_unlock();
+        os_sleep(1);
+        os_lock();
+    }
+    os_unlock();
+    osal_event_delete(m_space_event);
 
     /* Release thread triggger.
      */
@@ -110,14 +198,149 @@ void eThread::setupclass()
 {
     const os_int cls = ECLASSID_THREAD;
 
-    /* Add the class to class list.
+    /* Add the class to class list and properties to property set.
      */
     os_lock();
     eclasslist_add(cls, (eNewObjFunc)newobj, "eThread");
+    addqueueproperties(cls);
     os_unlock();
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Add message queue properties to property set.
+
+  The eThread::addqueueproperties function adds high water mark, overflow policy and queue
+  depth, peak depth and rate monitoring properties to property set of a thread class.
+  Classes derived from eThread call this from their setupclass() function.
+  Process mutex must be locked when calling this function.
+
+  @param   cls Class identifier.
+  @return  None.
+
+****************************************************************************************************
+*/
+void eThread::addqueueproperties(
+    os_int cls)
+{
+    eVariable *p;
+
+    addpropertyl(cls, ETHREADP_QUEUE_LIMIT, ethreadp_queue_limit,
+        EPRO_PERSISTENT|EPRO_SIMPLE, "queue limit", 0);
+    addpropertyl(cls, ETHREADP_QUEUE_POLICY, ethreadp_queue_policy,
+        EPRO_PERSISTENT|EPRO_SIMPLE, "overflow policy", ETHREAD_OVERFLOW_BLOCK);
+    p = addpropertyl(cls, ETHREADP_QUEUE_DEPTH, ethreadp_queue_depth,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "queue depth", 0);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+    p = addpropertyl(cls, ETHREADP_QUEUE_PEAK, ethreadp_queue_peak,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "queue peak", 0);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+    p = addpropertyd(cls, ETHREADP_QUEUE_RATE, ethreadp_queue_rate,
+        EPRO_SIMPLE|EPRO_NOONPRCH, "queue rate msg/s", 0.0, 1);
+    p->setpropertys(EVARP_ATTR, "rdonly");
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Called to inform the class about property value change (override).
+
+  The onpropertychange() function is called when class'es property changes, unless the
+  property is flagged with EPRO_NOONPRCH.
+
+  @param   propertynr Property number of changed property.
+  @param   x Variable containing the new value.
+  @param   flags
+  @return  None.
+
+****************************************************************************************************
+*/
+void eThread::onpropertychange(
+    os_int propertynr, 
+    eVariable *x, 
+    os_int flags)
+{
+    switch (propertynr)
+    {
+        case ETHREADP_QUEUE_LIMIT:
+            eatomic_store_int(&m_queue_limit, (os_int)x->getl());
+            break;
+
+        case ETHREADP_QUEUE_POLICY:
+            eatomic_store_int(&m_queue_policy, (os_int)x->getl());
+            break;
+
+        default:
+            eObject::onpropertychange(propertynr, x, flags);
+            break;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value of simple property (override).
+
+  The simpleproperty() function stores current value of simple property into variable x.
+  Queue rate is recalculated if at least a second has elapsed since it was last calculated.
+
+  @param   propertynr Property number to get.
+  @param   x Variable into which to store the property value.
+  @return  If property with property number was stored in x, the function returns 
+           ESTATUS_SUCCESS (0). Nonzero return value indicates that the property was not stored.
+
+****************************************************************************************************
+*/
+eStatus eThread::simpleproperty(
+    os_int propertynr, 
+    eVariable *x)
+{
+    os_timer now;
+    os_long us;
+    os_int count;
+
+    switch (propertynr)
+    {
+        case ETHREADP_QUEUE_LIMIT:
+            x->setl(eatomic_load_int(&m_queue_limit));
+            break;
+
+        case ETHREADP_QUEUE_POLICY:
+            x->setl(eatomic_load_int(&m_queue_policy));
+            break;
+
+        case ETHREADP_QUEUE_DEPTH:
+            x->setl(queuedepth(ETHREAD_LANE_HIGH) + queuedepth(ETHREAD_LANE_NORMAL));
+            break;
+
+        case ETHREADP_QUEUE_PEAK:
+            x->setl(eatomic_load_int(&m_queue_peak));
+            break;
+
+        case ETHREADP_QUEUE_RATE:
+            os_get_timer(&now);
+            us = (os_long)(now - m_rate_timer);
+            if (us >= 1000000)
+            {
+                count = eatomic_load_int(&m_enqueued);
+                m_rate = (os_double)(count - m_rate_count) * 1000000.0 / (os_double)us;
+                m_rate_count = count;
+                m_rate_timer = now;
+            }
+            x->setd(m_rate);
+            break;
+
+        default:
+            return eObject::simpleproperty(propertynr, x);
+    }
+    return ESTATUS_SUCCESS;
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -146,6 +369,21 @@ void eThread::onmessage(
             case ECMD_EXIT_THREAD:
                 m_exit_requested = OS_TRUE;
                 return;
+
+            case ECMD_ACK_MUX:
+                ePropertyBinding::ack_mux(this, envelope);
+                return;
+
+            /* Binding multiplexer's envelope was not delivered, values are returned 
+               as context.
+             */
+            case ECMD_NO_TARGET:
+                if (envelope->context())
+                {
+                    ePropertyBinding::resend_mux(this, envelope);
+                    return;
+                }
+                break;
         }
     }
 
@@ -160,13 +398,21 @@ void eThread::onmessage(
 
   After calling this funcion, eThread pointer thiso cannot be used from calling thread.
 
+  If ETHREAD_SCHEDULED flag is given and scheduler is running, no operating system thread is
+  created. The thread is initialized by calling thread and then messages to it are processed
+  by scheduler's worker threads. This is allowed only for threads which do not override run().
+
+  @param   thandle Thread handle for terminating and joining the thread, OS_NULL if not needed.
+  @param   params Parameters for initialize(), cloned. OS_NULL if none.
+  @param   flags ETHREAD_DEDICATED or ETHREAD_SCHEDULED.
   @return  None.
 
 ****************************************************************************************************
 */
 void eThread::start(
     eThreadHandle *thandle,
-    eContainer *params)
+    eContainer *params,
+    os_int flags)
 {
     eThreadParameters 
 		prmstruct;
@@ -187,6 +433,27 @@ void eThread::start(
     {
         prmstruct.params = eContainer::cast(params->clone(this, EOID_INTERNAL));
     }
+
+    /* Run as actor on scheduler's worker threads.
+     */
+    if ((flags & ETHREAD_SCHEDULED) && escheduler_running())
+    {
+        initialize(prmstruct.params);
+
+        if (thandle)
+        {
+            thandle->m_done = osal_event_create();
+            m_sched_done = thandle->m_done;
+        }
+
+        eatomic_add_int(&eglobal->sched.nro_threads, 1);
+        m_scheduled = OS_TRUE;
+
+        /* Schedule once to process messages queued before this point.
+         */
+        escheduler_notify(this);
+        return;
+    }
     
     handle = osal_thread_create(ethread_func, &prmstruct, OSAL_THREAD_ATTACHED, 0, "threadnamehere");
     if (thandle)
@@ -251,6 +518,15 @@ static void ethread_func(
 
 void eThread::run()
 {
+    /* Scheduled thread: Called by scheduler's worker, process queued messages and return.
+     */
+    if (m_scheduled)
+    {
+        m_sched_default_run = OS_TRUE;
+        alive(EALIVE_RETURN_IMMEDIATELY);
+        return;
+    }
+
     while (!exitnow())
     {
         alive();
@@ -280,28 +556,382 @@ void eThread::run()
 
   @brief Place an envelope to thread's message queue
 
-  The eThread::queue function...
+  The eThread::queue function places an envelope to thread's mailbox. The envelope is
+  detached from the sender's tree structure, it is adopted into this thread's tree only by
+  alive() function within the receiving thread. The calling thread must own the tree structure
+  containing the envelope.
+
+  If normal lane is at high water mark, the overflow policy is applied. Sender may be holding
+  process mutex, so this function never blocks: With ETHREAD_OVERFLOW_BLOCK policy the envelope
+  is queued and OS_TRUE is returned, and the sender calls waitqueue() once it has released
+  the mutex. Sender never waits for it's own thread, nor when sending thread is run by
+  scheduler, since waiting would stop a scheduler worker which may be needed to empty the
+  queue. Then the envelope is handled as with ETHREAD_OVERFLOW_NO_TARGET policy.
 
-  Process mutex must be locked when calling this function!!!
+  The ECMD_NO_TARGET reply is not sent here, since the sender may be holding process mutex.
+  Instead the envelope is flagged with EMSG_OVERFLOW_REPLY and queued to sender's own thread,
+  which sends the reply when it processes the envelope, see dispatch().
+
+  Envelope allocated from memory arena can not be queued, since the arena may be released
+  before the receiving thread is done with it. Such envelope is rejected.
+
+  The function doesn't need process mutex to be locked.
 
   @param  envelope Pointer to envelope. Envelope will be adopted by this function.
-  @return None.
+  @param  delete_envelope If OS_TRUE, the envelope is moved to this thread and it can no longer
+          be used by caller. If OS_FALSE, a clone of the envelope is queued.
+  @return OS_TRUE if sender should wait for space in queue, OS_FALSE otherwise.
 
 ****************************************************************************************************
 */
-void eThread::queue(
+os_boolean eThread::queue(
     eEnvelope *envelope,
     os_boolean delete_envelope)
 {
-    if (delete_envelope)
+    eThread
+        *sender;
+
+    os_int
+        lane,
+        policy;
+
+    os_boolean
+        wait;
+
+#if E_SLAB_ALLOCATOR
+    if (eslab_isarena(envelope))
     {
-        m_message_queue->adopt(envelope, EOID_ITEM, EOBJ_NO_MAP);
+        osal_debug_error("eThread::queue: envelope from arena rejected");
+        if (delete_envelope) delete envelope;
+        return OS_FALSE;
     }
-    else
+#endif
+
+    lane = envelopelane(envelope);
+    wait = OS_FALSE;
+
+    /* Apply overflow policy if normal lane is at high water mark.
+     */
+    if (lane == ETHREAD_LANE_NORMAL && queuefull())
+    {
+        policy = eatomic_load_int(&m_queue_policy);
+        sender = envelope->thread();
+        if (policy == ETHREAD_OVERFLOW_BLOCK && (sender == OS_NULL || sender == this ||
+            sender->m_scheduled))
+        {
+            policy = ETHREAD_OVERFLOW_NO_TARGET;
+        }
+
+        switch (policy)
+        {
+            case ETHREAD_OVERFLOW_NO_TARGET:
+                if ((envelope->mflags() & EMSG_NO_REPLIES) == 0 && sender)
+                {
+                    if (!delete_envelope)
+                    {
+                        envelope = eEnvelope::cast(envelope->clone(envelope->mm_parent, 
+                            EOID_ITEM, EOBJ_NO_MAP));
+                    }
+                    envelope->addmflags(EMSG_OVERFLOW_REPLY);
+                    sender->detach_envelope(envelope);
+                    sender->mailbox_push(envelope, envelope, ETHREAD_LANE_HIGH);
+                    return OS_FALSE;
+                }
+                /* continues... */
+
+            case ETHREAD_OVERFLOW_DROP_NEWEST:
+                if (delete_envelope) delete envelope;
+                return OS_FALSE;
+
+            case ETHREAD_OVERFLOW_DROP_OLDEST:
+                eatomic_add_int(&m_drop_oldest, 1);
+                break;
+
+            default:
+                wait = OS_TRUE;
+                break;
+        }
+    }
+
+    if (!delete_envelope)
+    {
+        osal_debug_assert(envelope->mm_parent);
+        envelope = eEnvelope::cast(envelope->clone(envelope->mm_parent, EOID_ITEM, EOBJ_NO_MAP));
+    }
+
+    detach_envelope(envelope);
+    mailbox_push(envelope, envelope, lane);
+    queuestats(1);
+
+    return wait;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Detach envelope from sender's tree structure.
+
+  The eThread::detach_envelope function detaches the envelope and it's names from sender's
+  tree structure. This is sender's own tree, so no synchronization is needed. If envelope
+  moves to another thread, content and context are moved to envelope's detached payload tree,
+  so that receiving thread can adopt the envelope without walking trough them. Envelope
+  queued to this thread's own mailbox keeps content and context as it's children.
+
+  @param  envelope Pointer to envelope.
+  @return None.
+
+****************************************************************************************************
+*/
+void eThread::detach_envelope(
+    eEnvelope *envelope)
+{
+    if (envelope->thread() != this)
+    {
+        envelope->detach_payload();
+    }
+
+    if (envelope->mm_parent)
+    {
+        envelope->map(E_DETACH_FROM_NAMESPACES_ABOVE);
+        envelope->mm_parent->mm_handle->removechild(envelope->mm_handle);
+        envelope->mm_parent = OS_NULL;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Update queue monitoring counters.
+
+  The eThread::queuestats function counts queued messages for queue rate and updates peak
+  queue depth. Called after envelopes have been pushed to mailbox.
+
+  @param  count Number of envelopes queued.
+  @return None.
+
+****************************************************************************************************
+*/
+void eThread::queuestats(
+    os_int count)
+{
+    os_int
+        depth,
+        peak;
+
+    eatomic_add_int(&m_enqueued, count);
+    depth = queuedepth(ETHREAD_LANE_HIGH) + queuedepth(ETHREAD_LANE_NORMAL);
+    do
+    {
+        peak = eatomic_load_int(&m_queue_peak);
+        if (depth <= peak) break;
+    }
+    while (!eatomic_cas_int(&m_queue_peak, peak, depth));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Wait until there is space in thread's message queue.
+
+  The eThread::waitqueue function is called by sender after queue() has returned OS_TRUE and
+  the sender has released process mutex. It waits until normal lane of the thread is below
+  high water mark, or the thread has been deleted. Thread is identified by object index and use
+  counter, since the thread pointer is not valid without the process mutex. Sender sleeps on
+  thread's space event, which the thread sets when it takes messages from a full queue.
+  Sender registers as waiter and removes itself with process mutex locked, and the thread is
+  accessed only while the mutex is locked. Destructor waits until there are no waiters, so
+  thread object and event stay valid while registered. Closing thread is not waited for.
+
+  Two threads sending to each other with ETHREAD_OVERFLOW_BLOCK policy can block each other,
+  the policy should be used only for one way data flow.
+
+  @param  oix Object index of the thread.
+  @param  ucnt Use counter of the thread.
+  @return None.
+
+****************************************************************************************************
+*/
+void eThread::waitqueue(
+    e_oix oix,
+    os_int ucnt)
+{
+    eHandle
+        *handle;
+
+    eThread
+        *t;
+
+    osalEvent
+        space_event;
+
+    os_boolean
+        full;
+
+    while (osal_go())
+    {
+        os_lock();
+        handle = eget_handle(oix);
+        if (handle->m_ucnt != ucnt || handle->m_object == OS_NULL)
+        {
+            os_unlock();
+            return;
+        }
+        t = eThread::cast(handle->m_object);
+        if (t->m_closing)
+        {
+            os_unlock();
+            return;
+        }
+
+        /* Count as waiter before checking the queue, so that the thread either sees the
+           waiter or this sees space.
+         */
+        eatomic_add_int(&t->m_queue_waiters, 1);
+        full = t->queuefull();
+        space_event = t->m_space_event;
+        os_unlock();
+
+        if (full) osal_event_wait(space_event, ETHREAD_SPACE_WAIT_MS);
+
+        /* Thread is valid until this is removed from waiters, with mutex locked. If there 
+           is space, pass wake up to next waiter.
+         */
+        os_lock();
+        if (!t->m_closing && eatomic_load_int(&t->m_queue_waiters) > 1 && !t->queuefull())
+        {
+            osal_event_set(space_event);
+        }
+        eatomic_add_int(&t->m_queue_waiters, -1);
+        os_unlock();
+        if (!full) return;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Select message queue lane for an envelope.
+
+  The eThread::envelopelane function selects high priority lane for envelopes with EMSG_HIGH_PRIORITY
+  flag and for control commands, which should not wait behind bulk data.
+
+  @param  envelope Pointer to envelope.
+  @return ETHREAD_LANE_HIGH or ETHREAD_LANE_NORMAL.
+
+****************************************************************************************************
+*/
+os_int eThread::envelopelane(
+    eEnvelope *envelope)
+{
+    if (envelope->mflags() & EMSG_HIGH_PRIORITY) return ETHREAD_LANE_HIGH;
+
+    switch (envelope->command())
+    {
+        case ECMD_EXIT_THREAD:
+        case ECMD_TIMER:
+        case ECMD_ACK:
+        case ECMD_ACK_MUX:
+        case ECMD_BIND_REPLY:
+            return ETHREAD_LANE_HIGH;
+    }
+
+    return ETHREAD_LANE_NORMAL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Push linked list of envelopes to mailbox.
+
+  The eThread::mailbox_push function adds a list of envelopes, linked from last to first
+  trough m_mailbox_next, to a mailbox lane with one atomic compare and swap. Thread is triggered
+  only if the lane was empty: If mailbox was not empty, thread has already been triggered and
+  has not yet taken the messages. Scheduled thread is triggered by marking it runnable for
+  scheduler's worker threads.
+
+  @param  first The first envelope to process (oldest).
+  @param  last The last envelope to process (newest). m_mailbox_next of the last envelope
+          points to the previous envelope and so on, the first envelope's m_mailbox_next
+          is overwritten.
+  @param  lane ETHREAD_LANE_HIGH or ETHREAD_LANE_NORMAL.
+  @param  count Number of envelopes in the list.
+  @return None.
+
+****************************************************************************************************
+*/
+void eThread::mailbox_push(
+    eEnvelope *first,
+    eEnvelope *last,
+    os_int lane,
+    os_int count)
+{
+    eEnvelope *head;
+
+    /* Count before pushing, so that depth never goes negative.
+     */
+    eatomic_add_int(&m_lane_depth[lane], count);
+
+    do
     {
-        envelope->clone(m_message_queue, EOID_ITEM, EOBJ_NO_MAP);
+        head = (eEnvelope*)eatomic_load_ptr((void*volatile*)&m_mailbox[lane]);
+        first->m_mailbox_next = head;
+    }
+    while (!eatomic_cas_ptr((void*volatile*)&m_mailbox[lane], head, last));
+
+    if (head == OS_NULL)
+    {
+        if (m_scheduled)
+        {
+            escheduler_notify(this);
+        }
+        else
+        {
+            osal_event_set(m_trigger);
+        }
     }
-    osal_event_set(m_trigger);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take all envelopes from mailbox lane.
+
+  The eThread::mailbox_take function empties the mailbox lane with one atomic exchange and
+  reverses the list, so that envelopes are returned in order they were queued.
+  Only the thread owning the mailbox may call this function.
+
+  @param  lane ETHREAD_LANE_HIGH or ETHREAD_LANE_NORMAL.
+  @return Pointer to the first envelope, others linked trough m_mailbox_next. OS_NULL if
+          the mailbox is empty.
+
+****************************************************************************************************
+*/
+eEnvelope *eThread::mailbox_take(
+    os_int lane)
+{
+    eEnvelope
+        *envelope,
+        *next,
+        *list;
+
+    envelope = (eEnvelope*)eatomic_exchange_ptr((void*volatile*)&m_mailbox[lane], OS_NULL);
+
+    list = OS_NULL;
+    while (envelope)
+    {
+        next = envelope->m_mailbox_next;
+        envelope->m_mailbox_next = list;
+        list = envelope;
+        envelope = next;
+    }
+
+    return list;
 }
 
 
@@ -310,8 +940,11 @@ void eThread::queue(
 
   @brief Process messages.
 
-  The alive function processed messages incoming to thread. It takes a message
-  item at a time and and forwards those.
+  The alive function processed messages incoming to thread. High priority lane is always
+  processed first: It is checked again after each normal lane message, and if messages have
+  arrived, rest of taken normal lane messages wait in m_pending. Process mutex is not locked.
+  Values collected by binding multiplexer are sent when all queued messages have been 
+  processed, and before waiting for trigger.
 
   @return None.
 
@@ -321,7 +954,17 @@ void eThread::alive(
     os_int flags)
 {
     eEnvelope
-        *envelope;
+        *envelope,
+        *next;
+
+    /* Scheduled thread may not wait for trigger, it would block scheduler's worker. This
+       happens if scheduled thread overrides run() with it's own loop.
+     */
+    osal_debug_assert(!m_scheduled || (flags & EALIVE_WAIT_FOR_EVENT) == 0);
+
+    /* Send binding updates collected since last call before waiting.
+     */
+    if (m_bindingmux) m_bindingmux->flush();
 
     /* Wait for thread to be trigged. Always clear the event, even we would not be writing.
      */
@@ -330,30 +973,136 @@ void eThread::alive(
 
     while (osal_go())
     {
-        /* Synchronize and get message (envelope) from queue.
+        /* Process all high priority messages.
          */
-	    os_lock();
-        envelope = eEnvelope::cast(m_message_queue->first());
-        if (envelope) 
+        envelope = mailbox_take(ETHREAD_LANE_HIGH);
+        if (envelope)
         {
-            adopt(envelope, EOID_CHILD, EOBJ_NO_MAP);
-
-            /* Flag that envelope has been moved from thread to another.
-             */
-            envelope->addmflags(EMSG_INTERTHREAD);
+            while (envelope)
+            {
+                next = envelope->m_mailbox_next;
+                dispatch(envelope, ETHREAD_LANE_HIGH);
+                envelope = next;
+            }
+            continue;
         }
-	    os_unlock();
 
-        /* If no message, do nothing more.
+        /* Get normal lane messages from mailbox, unless some are pending already.
+           If no messages, do nothing more.
          */
-        if (envelope == OS_NULL) return;
+        if (m_pending == OS_NULL)
+        {
+            m_pending = mailbox_take(ETHREAD_LANE_NORMAL);
+            if (m_pending == OS_NULL) 
+            {
+                /* All queued messages processed, send binding updates as one 
+                   envelope per peer.
+                 */
+                if (m_bindingmux) m_bindingmux->flush();
+                return;
+            }
+        }
 
-        /* Call message processing.
+        /* Process normal lane messages until high priority message arrives.
          */
-        onmessage(envelope);
+        while (m_pending)
+        {
+            envelope = m_pending;
+            m_pending = envelope->m_mailbox_next;
+            dispatch(envelope, ETHREAD_LANE_NORMAL);
 
-        /* Finished with envelope.
-         */
-        delete envelope;
+            if (eatomic_load_ptr((void*volatile*)&m_mailbox[ETHREAD_LANE_HIGH])) break;
+        }
     }           
-} 
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Process one message.
+
+  The eThread::dispatch function moves envelope taken from mailbox to this thread,
+  calls onmessage() and recycles the envelope.
+
+  @param  envelope Pointer to envelope.
+  @param  lane Lane from which the envelope was taken, for depth counter.
+  @return None.
+
+****************************************************************************************************
+*/
+void eThread::dispatch(
+    eEnvelope *envelope,
+    os_int lane)
+{
+    envelope->m_mailbox_next = OS_NULL;
+    eatomic_add_int(&m_lane_depth[lane], -1);
+
+    /* Wake up a sender waiting for space in queue.
+     */
+    if (eatomic_load_int(&m_queue_waiters) > 0 && !queuefull())
+    {
+        osal_event_set(m_space_event);
+    }
+
+    /* Envelope which could not be queued to another thread, reply ECMD_NO_TARGET now that
+       process mutex is not held. Reply is addressed to envelope's source path and it's 
+       source is the target path as is, no oix of this thread or envelope is added.
+     */
+    if (envelope->mflags() & EMSG_OVERFLOW_REPLY)
+    {
+        adopt(envelope, EOID_CHILD, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+        message(ECMD_NO_TARGET, envelope->source(), envelope->target(), OS_NULL,
+            EMSG_DEL_CONTEXT|EMSG_NO_NEW_SOURCE_OIX, envelope->context());
+        mm_handle->m_root->envelope_recycle(envelope);
+        return;
+    }
+
+    /* Drop instead of processing, if senders have requested to drop oldest messages.
+       Only this thread decrements the drop count, so it cannot go negative.
+     */
+    if (lane == ETHREAD_LANE_NORMAL && eatomic_load_int(&m_drop_oldest) > 0)
+    {
+        eatomic_add_int(&m_drop_oldest, -1);
+        adopt(envelope, EOID_CHILD, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+        mm_handle->m_root->envelope_recycle(envelope);
+        return;
+    }
+
+    /* Move the envelope to this thread. Flag that envelope has been moved
+       from thread to another.
+     */
+    adopt(envelope, EOID_CHILD, EOBJ_NO_MAP|EOBJ_NO_SYNC);
+    envelope->addmflags(EMSG_INTERTHREAD);
+
+    /* Call message processing.
+     */
+    onmessage(envelope);
+
+    /* Finished with envelope. Keep envelope's memory and path buffers in
+       this thread's pools for reuse.
+     */
+    mm_handle->m_root->envelope_recycle(envelope);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get binding multiplexer.
+
+  The eThread::bindingmux function returns thread's binding multiplexer, and creates it if
+  it doesn't exist yet. Used only by the thread itself.
+
+  @return Pointer to binding multiplexer.
+
+****************************************************************************************************
+*/
+eBindingMux *eThread::bindingmux()
+{
+    if (m_bindingmux == OS_NULL)
+    {
+        m_bindingmux = new eBindingMux(this);
+    }
+    return m_bindingmux;
+}
@@ -23,6 +23,52 @@
 #define EALIVE_WAIT_FOR_EVENT 1
 #define EALIVE_RETURN_IMMEDIATELY 0
 
+/* Flags for start() function. ETHREAD_SCHEDULED runs the thread on scheduler's worker
+   threads, if scheduler is running. Otherwise dedicated operating system thread is created.
+ */
+#define ETHREAD_DEDICATED 0
+#define ETHREAD_SCHEDULED 1
+
+/* Message queue lanes. High priority lane is always processed first. Messages with
+   EMSG_HIGH_PRIORITY flag and control commands like ECMD_EXIT_THREAD, ECMD_TIMER,
+   ECMD_ACK, ECMD_ACK_MUX and ECMD_BIND_REPLY are queued to high priority lane.
+ */
+#define ETHREAD_LANE_HIGH 0
+#define ETHREAD_LANE_NORMAL 1
+#define ETHREAD_NRO_LANES 2
+
+/* What to do when message is queued to thread whose normal lane is at high water mark
+   (ETHREADP_QUEUE_LIMIT). High priority lane is never limited.
+ */
+#define ETHREAD_OVERFLOW_BLOCK 0       /* Sender waits until there is space, see queue() */
+#define ETHREAD_OVERFLOW_DROP_OLDEST 1 /* Oldest queued message is dropped */
+#define ETHREAD_OVERFLOW_DROP_NEWEST 2 /* New message is dropped */
+#define ETHREAD_OVERFLOW_NO_TARGET 3   /* New message is dropped and ECMD_NO_TARGET replied */
+
+/* Maximum time sender waits for space event before checking the queue again, ms.
+ */
+#define ETHREAD_SPACE_WAIT_MS 100
+
+/* Enumeration of thread's properties. Numbers are above properties of derived
+   classes eConnection and eEndPoint.
+ */
+#define ETHREADP_QUEUE_LIMIT 20
+#define ETHREADP_QUEUE_POLICY 22
+#define ETHREADP_QUEUE_DEPTH 24
+#define ETHREADP_QUEUE_PEAK 26
+#define ETHREADP_QUEUE_RATE 28
+
+/* Thread property names.
+ */
+extern os_char
+    ethreadp_queue_limit[],
+    ethreadp_queue_policy[],
+    ethreadp_queue_depth[],
+    ethreadp_queue_peak[],
+    ethreadp_queue_rate[];
+
+struct eSchedulerWorker;
+
 
 /**
 ****************************************************************************************************
@@ -37,6 +83,15 @@
 */
 class eThread : public eObject
 {
+    friend class eMessageBatch;
+
+    /* Scheduler functions, which access scheduler state, see escheduler.cpp.
+     */
+    friend void escheduler_notify(eThread *thread);
+    friend eThread *escheduler_next(eSchedulerWorker *w);
+    friend void escheduler_run(eSchedulerWorker *w, eThread *thread);
+    friend void escheduler_inject(eThread *thread);
+
 public:
     /**
     ************************************************************************************************
@@ -84,6 +139,10 @@ public:
      */
     static void setupclass();
 
+    /* Add message queue properties to property set of thread class.
+     */
+    static void addqueueproperties(
+        os_int cls);
 
     /* Return OS_TRUE if object is thread (derived). 
      */
@@ -102,6 +161,19 @@ public:
         return new eThread(parent, id, flags);
     } 
 
+    /* Called when property value changes.
+     */
+    virtual void onpropertychange(
+        os_int propertynr, 
+        eVariable *x, 
+        os_int flags);
+
+    /* Get value of simple property.
+     */
+    virtual eStatus simpleproperty(
+        os_int propertynr, 
+        eVariable *x);
+
     virtual void onmessage(
         eEnvelope *envelope);
 
@@ -124,11 +196,14 @@ public:
      */
     void start(
         eThreadHandle *thandle = OS_NULL,
-        eContainer *params = OS_NULL);
+        eContainer *params = OS_NULL,
+        os_int flags = ETHREAD_DEDICATED);
 
     virtual void initialize(
         eContainer *params = OS_NULL) {};
 
+    /* Default message loop. Scheduled thread may not override run(), see escheduler.h.
+     */
     virtual void run();
 
     virtual void finish() {};
@@ -140,31 +215,187 @@ public:
         return m_exit_requested;
     }
 
-    /* Get next message to thread to process.
+    /* Place an envelope to thread's message queue. Returns OS_TRUE if sender should call
+       waitqueue() once it has released process mutex.
      */
-    void queue(
+    os_boolean queue(
         eEnvelope *envelope,
         os_boolean delete_envelope = OS_TRUE);
 
+    /* Select message queue lane for an envelope.
+     */
+    static os_int envelopelane(
+        eEnvelope *envelope);
+
+    /* Wait until normal lane of thread is below high water mark.
+     */
+    static void waitqueue(
+        e_oix oix,
+        os_int ucnt);
+
+    /* Check if normal lane is at high water mark.
+     */
+    inline os_boolean queuefull()
+    {
+        os_int limit;
+        limit = eatomic_load_int(&m_queue_limit);
+        return (os_boolean)(limit > 0 && eatomic_load_int(&m_lane_depth[ETHREAD_LANE_NORMAL])
+            - eatomic_load_int(&m_drop_oldest) >= limit);
+    }
+
     /* Get next message to thread to process.
      */
     void alive(
         os_int flags = EALIVE_WAIT_FOR_EVENT);
 
+    /* Check if there are no queued messages.
+     */
+    inline os_boolean mailbox_empty()
+    {
+        return (os_boolean)(
+            eatomic_load_ptr((void*volatile*)&m_mailbox[ETHREAD_LANE_HIGH]) == OS_NULL &&
+            eatomic_load_ptr((void*volatile*)&m_mailbox[ETHREAD_LANE_NORMAL]) == OS_NULL);
+    }
+
+    /* Get number of messages queued to lane and not yet processed.
+     */
+    inline os_int queuedepth(
+        os_int lane = ETHREAD_LANE_NORMAL)
+    {
+        return eatomic_load_int(&m_lane_depth[lane]);
+    }
+
+    /* Get binding multiplexer of the thread, created when needed.
+     */
+    eBindingMux *bindingmux();
+
     /*@}*/
 
 protected:
+    /* Push linked list of envelopes to mailbox.
+     */
+    void mailbox_push(
+        eEnvelope *first,
+        eEnvelope *last,
+        os_int lane = ETHREAD_LANE_NORMAL,
+        os_int count = 1);
+
+    /* Take all envelopes from mailbox lane.
+     */
+    eEnvelope *mailbox_take(
+        os_int lane);
+
+    /* Detach envelope from sender's tree structure.
+     */
+    void detach_envelope(
+        eEnvelope *envelope);
+
+    /* Update queue monitoring counters after envelopes have been pushed.
+     */
+    void queuestats(
+        os_int count);
+
+    /* Process one envelope taken from mailbox lane.
+     */
+    void dispatch(
+        eEnvelope *envelope,
+        os_int lane);
+
     /* Thread triggger. 
      */
     osalEvent m_trigger;
 
-    /* Message queue for incoming messages.
+    /* Lock free mailbox for incoming messages, one for each lane. Intrusive list of envelopes
+       linked trough eEnvelope::m_mailbox_next, the most recently queued envelope first.
+     */
+    eEnvelope *volatile m_mailbox[ETHREAD_NRO_LANES];
+
+    /* Normal lane envelopes taken from mailbox but not yet processed, because high priority
+       messages arrived meanwhile. Accessed only by the thread itself.
+     */
+    eEnvelope *m_pending;
+
+    /* Number of queued and not yet processed messages in each lane.
+     */
+    volatile os_int m_lane_depth[ETHREAD_NRO_LANES];
+
+    /* High water mark of normal lane, 0 = unlimited, and overflow policy, like
+       ETHREAD_OVERFLOW_BLOCK.
+     */
+    volatile os_int m_queue_limit;
+    volatile os_int m_queue_policy;
+
+    /* Number of normal lane messages to drop instead of processing, by 
+       ETHREAD_OVERFLOW_DROP_OLDEST policy.
+     */
+    volatile os_int m_drop_oldest;
+
+    /* Event set by the thread when normal lane gets below high water mark and there are 
+       senders waiting for space, and number of waiting senders. Waiters are added and
+       removed with process mutex locked.
+     */
+    osalEvent m_space_event;
+    volatile os_int m_queue_waiters;
+
+    /* Set by destructor with process mutex locked, senders may no longer start waiting.
+     */
+    os_boolean m_closing;
+
+    /* Peak depth of both lanes together and number of messages queued in total.
+     */
+    volatile os_int m_queue_peak;
+    volatile os_int m_enqueued;
+
+    /* Message count and timer when queue rate was last calculated.
+     */
+    os_int m_rate_count;
+    os_timer m_rate_timer;
+
+    /* Last calculated queue rate, messages per second.
      */
-    eContainer *m_message_queue;
+    os_double m_rate;
+
+    /* Binding multiplexer, OS_NULL if not created.
+     */
+    eBindingMux *m_bindingmux;
 
     /* Exit requested
      */
     os_boolean m_exit_requested;
+
+private:
+	/** 
+	************************************************************************************************
+
+	  @name Scheduler state
+
+	  These are accessed only by the thread itself and by the scheduler, see escheduler.cpp.
+
+	************************************************************************************************
+	*/
+	/*@{*/
+
+    /* OS_TRUE if thread is run by scheduler's worker threads.
+     */
+    os_boolean m_scheduled;
+
+    /* Scheduling state: ESCHED_IDLE, ESCHED_QUEUED, ESCHED_RUNNING or ESCHED_RUNNING_AGAIN.
+     */
+    volatile os_int m_sched_state;
+
+    /* Next thread in scheduler's injection list.
+     */
+    eThread *volatile m_sched_next;
+
+    /* Event to set when scheduled thread has exited, OS_NULL if none.
+     */
+    osalEvent m_sched_done;
+
+    /* Set by default run() when called by scheduler, to detect threads which override run().
+     */
+    os_boolean m_sched_default_run;
+
+    /*@}*/
 };
 
 #endif
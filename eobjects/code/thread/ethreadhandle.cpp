@@ -36,6 +36,7 @@ eThreadHandle::eThreadHandle(
     : eObject(parent, id, flags)
 {
     m_osal_handle = OS_NULL;
+    m_done = OS_NULL;
     m_unique_thread_name[0] = '\0';
 }
 
@@ -53,11 +54,10 @@ eThreadHandle::eThreadHandle(
 */
 eThreadHandle::~eThreadHandle()
 {
-    if (m_osal_handle)
+    if (m_osal_handle || m_done)
     {
         terminate();
-	    osal_thread_join(m_osal_handle);
-        m_osal_handle = OS_NULL;
+        join();
     } 
 }
 
@@ -119,4 +119,14 @@ void eThreadHandle::join()
 	    osal_thread_join(m_osal_handle);
         m_osal_handle = OS_NULL;
     }
+
+    /* Scheduled thread has no operating system thread, wait for scheduler to signal
+       that the thread has exited.
+     */
+    if (m_done)
+    {
+        osal_event_wait(m_done, OSAL_EVENT_INFINITE);
+        osal_event_delete(m_done);
+        m_done = OS_NULL;
+    }
 }
@@ -119,6 +119,10 @@ private:
 
 	osalThreadHandle *m_osal_handle;
 
+    /* Event set by scheduler when scheduled thread has exited.
+     */
+    osalEvent m_done;
+
     os_char m_unique_thread_name[E_OIXSTR_BUF_SZ];
 };
 
@@ -80,6 +80,37 @@ eVariable::~eVariable()
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Check if variable has nothing to release in destructor.
+
+  The trivialdestructor() function returns OS_TRUE if the variable has no separately allocated
+  string buffer, temporary string or object to release. Derived classes are not assumed to
+  have trivial destructor.
+
+  @return  OS_TRUE if destructor call can be skipped when deleted with arena.
+
+****************************************************************************************************
+*/
+os_boolean eVariable::trivialdestructor()
+{
+    if (classid() != ECLASSID_VARIABLE) return OS_FALSE;
+
+    switch (type())
+    {
+        case OS_STR:
+            return (os_boolean)((m_vflags & EVAR_STRBUF_ALLOCATED) == 0);
+
+        case OS_OBJECT:
+            return OS_FALSE;
+
+        default:
+            return (os_boolean)(m_value.valbuf.tmpstr == OS_NULL);
+    }
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -101,7 +132,7 @@ eObject *eVariable::clone(
     os_int aflags)
 {
     eVariable *clonedobj;
-    clonedobj = new eVariable(parent, id == EOID_CHILD ? oid() : id, flags());
+    clonedobj = new (parent) eVariable(parent, id == EOID_CHILD ? oid() : id, flags());
   
     /** Copy variable value. 
      */
@@ -160,6 +160,10 @@ public:
         return ECLASSID_VARIABLE;
     }
 
+    /* Check if variable has nothing to release in destructor.
+     */
+    virtual os_boolean trivialdestructor();
+
     /* Static function to add class to propertysets and class list.
      */
     static void setupclass();
@@ -176,7 +180,7 @@ public:
         e_oid id = EOID_ITEM,
 		os_int flags = EOBJ_DEFAULT)
     {
-        return new eVariable(parent, id, flags);
+        return new (parent) eVariable(parent, id, flags);
     }
 
 	/* Get next object identified by oid.
@@ -39,11 +39,16 @@ void eobjects_shutdown();
 #include "eobjects/code/defs/eoid.h"
 #include "eobjects/code/defs/eclassid.h"
 #include "eobjects/code/defs/emacros.h"
+#include "eobjects/code/defs/eatomic.h"
+#include "eobjects/code/name/eatom.h"
+#include "eobjects/code/object/eslab.h"
 #include "eobjects/code/object/ehandle.h"
 #include "eobjects/code/object/eobject.h"
+#include "eobjects/code/object/earena.h"
 #include "eobjects/code/object/ehandletable.h"
 #include "eobjects/code/object/ehandleroot.h"
 #include "eobjects/code/object/eclasslist.h"
+#include "eobjects/code/object/eproptable.h"
 #include "eobjects/code/root/eroot.h"
 #include "eobjects/code/variable/evariable.h"
 #include "eobjects/code/set/eset.h"
@@ -51,14 +56,19 @@ void eobjects_shutdown();
 #include "eobjects/code/pointer/epointer.h"
 #include "eobjects/code/name/ename.h"
 #include "eobjects/code/name/enamespace.h"
+#include "eobjects/code/name/ensindex.h"
 #include "eobjects/code/binding/ebinding.h"
 #include "eobjects/code/binding/epropertybinding.h"
+#include "eobjects/code/binding/ebindingmux.h"
 #include "eobjects/code/envelope/eenvelope.h"
+#include "eobjects/code/request/erequest.h"
 #include "eobjects/code/table/ewhere.h"
 #include "eobjects/code/table/etable.h"
 #include "eobjects/code/matrix/ematrix.h"
 #include "eobjects/code/thread/ethreadhandle.h"
 #include "eobjects/code/thread/ethread.h"
+#include "eobjects/code/thread/escheduler.h"
+#include "eobjects/code/envelope/emessagebatch.h"
 #include "eobjects/code/timer/etimer.h"
 #include "eobjects/code/global/eprocess.h"
 #include "eobjects/code/global/eglobal.h"
@@ -0,0 +1 @@
+git clean -d -f -x C:\coderoot\borromean\eobjects\examples\ebenchmark
\ No newline at end of file
@@ -0,0 +1 @@
+cmake . -G "Visual Studio 14 Win64"
\ No newline at end of file
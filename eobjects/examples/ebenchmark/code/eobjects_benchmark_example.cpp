@@ -0,0 +1,153 @@
+/**
+
+  @file    eobjects_benchmark_example.cpp
+  @brief   Performance measurements for eobjects library.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  This example runs benchmarks and writes results to console.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Generate entry code for console application.
+ */
+EMAIN_CONSOLE_ENTRY
+
+/**
+****************************************************************************************************
+
+  @brief Application entry point.
+
+  The emain() function is eobjects application's entry point.
+
+  @param   argc Number of command line arguments.
+  @param   argv Array of string pointers, one for each command line argument. UTF8 encoded.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+os_int emain(
+    os_int argc,
+    os_char *argv[])
+{
+    benchmark_process_ns();
+    benchmark_scheduler();
+    benchmark_oix();
+    benchmark_slab();
+    benchmark_property();
+
+    return 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Write benchmark result to console.
+
+  The benchmark_report() function writes number of threads, number of messages, elapsed time
+  and messages per second to console.
+
+  @param   text Benchmark name.
+  @param   nro_threads Number of threads used.
+  @param   nro_messages Number of messages processed.
+  @param   start Timer value when the benchmark was started.
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_report(
+    const os_char *text,
+    os_int nro_threads,
+    os_long nro_messages,
+    os_timer *start)
+{
+    eVariable
+        v,
+        n;
+
+    os_timer
+        now;
+
+    os_long
+        us;
+
+    os_get_timer(&now);
+    us = (os_long)(now - *start);
+    if (us <= 0) us = 1;
+
+    v.sets(text);
+    v.appends(": threads=");
+    n.setl(nro_threads);
+    v.appendv(&n);
+    v.appends(", messages=");
+    n.setl(nro_messages);
+    v.appendv(&n);
+    v.appends(", ms=");
+    n.setl(us / 1000);
+    v.appendv(&n);
+    v.appends(", msg/s=");
+    n.setl(nro_messages * 1000000 / us);
+    v.appendv(&n);
+    v.appends("\n");
+    osal_console_write(v.gets());
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Write pool counters to console.
+
+  The benchmark_report_pools() function writes envelope and path buffer pool hit and miss
+  counts and handle reserve counters of a thread to console.
+
+  @param   text Thread name.
+  @param   stats Pool counters, see eRoot::poolstats().
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_report_pools(
+    const os_char *text,
+    eRootPoolStats *stats)
+{
+    eVariable
+        v,
+        n;
+
+    v.sets(text);
+    v.appends(": envelope pool hits=");
+    n.setl(stats->envelope_hits);
+    v.appendv(&n);
+    v.appends(", misses=");
+    n.setl(stats->envelope_misses);
+    v.appendv(&n);
+    v.appends(", path buffer pool hits=");
+    n.setl(stats->pathbuf_hits);
+    v.appendv(&n);
+    v.appends(", misses=");
+    n.setl(stats->pathbuf_misses);
+    v.appendv(&n);
+    v.appends(", free handles=");
+    n.setl(stats->handles_free);
+    v.appendv(&n);
+    v.appends(", handle refills=");
+    n.setl(stats->handle_refills);
+    v.appendv(&n);
+    v.appends(", releases=");
+    n.setl(stats->handle_releases);
+    v.appendv(&n);
+    v.appends("\n");
+    osal_console_write(v.gets());
+}
@@ -0,0 +1,53 @@
+/**
+
+  @file    eobjects_benchmark_example.h
+  @brief   Performance measurements for eobjects library.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Each benchmark is in it's own file. Results are written to console.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+
+void benchmark_process_ns();
+void benchmark_scheduler();
+void benchmark_oix();
+void benchmark_slab();
+void benchmark_property();
+
+/* Write benchmark result line to console.
+ */
+void benchmark_report(
+    const os_char *text,
+    os_int nro_threads,
+    os_long nro_messages,
+    os_timer *start);
+
+/* Write envelope, path buffer and handle pool counters to console.
+ */
+void benchmark_report_pools(
+    const os_char *text,
+    eRootPoolStats *stats);
+
+/* Purpose of a message is specified by 32 bit command. Negative command identifiers are
+   reserved for the eobject library related, but positive ones can be used freely.
+ */
+#define BMCMD_PING 10
+
+/* Class identifiers starting from ECLASSID_APP_BASE are reserved for the application.
+ */
+#define BM_CLASS_ID_SENDER (ECLASSID_APP_BASE + 1)
+#define BM_CLASS_ID_RECEIVER (ECLASSID_APP_BASE + 2)
+#define BM_CLASS_ID_ACTOR (ECLASSID_APP_BASE + 3)
+#define BM_CLASS_ID_OIX_RECEIVER (ECLASSID_APP_BASE + 4)
+#define BM_CLASS_ID_OIX_SENDER (ECLASSID_APP_BASE + 5)
+#define BM_CLASS_ID_OIX_TARGET (ECLASSID_APP_BASE + 6)
+#define BM_CLASS_ID_PROP_OBJECT (ECLASSID_APP_BASE + 7)
+#define BM_CLASS_ID_PROP_WORKER (ECLASSID_APP_BASE + 8)
@@ -0,0 +1,257 @@
+/**
+
+  @file    eobjects_benchmark_oix.cpp
+  @brief   Message throughput when addressing by object index.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Sender threads send messages using object index strings, like "@11_2", as target path.
+  Number of sender threads is increased from 1 to BM_OIX_MAX_SENDERS. This is done first so
+  that all senders send to the same receiver thread, and then so that each sender sends to
+  an object in it's own object tree. Handle lookup by object index is lock free, so the later
+  should scale with number of threads.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Maximum number of sender threads and number of messages sent by each sender thread.
+ */
+#define BM_OIX_MAX_SENDERS 16
+#define BM_OIX_MESSAGES_PER_SENDER 100000
+
+/* Number of messages received.
+ */
+static volatile os_int bm_oix_received;
+
+/* Receiver thread's object index string, OS_NULL to send to object in sender's own tree.
+ */
+static os_char *bm_oix_target;
+
+
+/**
+****************************************************************************************************
+
+  @brief Target object class.
+
+  The target object just counts received messages. It doesn't need synchronization, since
+  it is called only by thread which owns it.
+
+****************************************************************************************************
+*/
+class eBmOixTarget : public eObject
+{
+public:
+    /* Constructor.
+     */
+    eBmOixTarget(
+		eObject *parent = OS_NULL,
+        e_oid id = EOID_ITEM,
+		os_int flags = EOBJ_DEFAULT)
+        : eObject(parent, id, flags)
+    {
+        m_count = 0;
+    }
+
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_OIX_TARGET;
+    }
+
+    virtual void onmessage(
+        eEnvelope *envelope)
+    {
+        if (*envelope->target()=='\0' && envelope->command() == BMCMD_PING)
+        {
+            m_count++;
+            return;
+        }
+
+        eObject::onmessage(envelope);
+    }
+
+    /* Number of received messages.
+     */
+    os_int m_count;
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Receiver thread class.
+
+  The receiver thread just counts received messages.
+
+****************************************************************************************************
+*/
+class eBmOixReceiver : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_OIX_RECEIVER;
+    }
+
+    virtual void onmessage(
+        eEnvelope *envelope)
+    {
+        if (*envelope->target()=='\0' && envelope->command() == BMCMD_PING)
+        {
+            eatomic_add_int(&bm_oix_received, 1);
+            return;
+        }
+
+        eThread::onmessage(envelope);
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Sender thread class.
+
+  The sender thread sends BM_OIX_MESSAGES_PER_SENDER messages to receiver thread, or to
+  target object within it's own object tree, and exits.
+
+****************************************************************************************************
+*/
+class eBmOixSender : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_OIX_SENDER;
+    }
+
+    virtual void run()
+    {
+        eBmOixTarget
+            *target;
+
+        os_char
+            buf[E_OIXSTR_BUF_SZ];
+
+        os_int
+            i;
+
+        if (bm_oix_target)
+        {
+            for (i = 0; i < BM_OIX_MESSAGES_PER_SENDER; i++)
+            {
+                message (BMCMD_PING, bm_oix_target, OS_NULL, OS_NULL,
+                    EMSG_NO_REPLIES|EMSG_NO_ERRORS);
+            }
+            return;
+        }
+
+        target = new eBmOixTarget(this);
+        target->oixstr(buf, sizeof(buf));
+        for (i = 0; i < BM_OIX_MESSAGES_PER_SENDER; i++)
+        {
+            message (BMCMD_PING, buf, OS_NULL, OS_NULL,
+                EMSG_NO_REPLIES|EMSG_NO_ERRORS);
+        }
+        eatomic_add_int(&bm_oix_received, target->m_count);
+        delete target;
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Run object index benchmark with 1, 2, 4 ... BM_OIX_MAX_SENDERS sender threads.
+
+  @param   text Benchmark name.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void benchmark_oix_round(
+    const os_char *text)
+{
+    eThread
+        *t;
+
+    eThreadHandle
+        sender[BM_OIX_MAX_SENDERS];
+
+    os_timer
+        start;
+
+    os_int
+        nro_senders,
+        total,
+        i;
+
+    for (nro_senders = 1; nro_senders <= BM_OIX_MAX_SENDERS; nro_senders *= 2)
+    {
+        total = nro_senders * BM_OIX_MESSAGES_PER_SENDER;
+        eatomic_store_int(&bm_oix_received, 0);
+        os_get_timer(&start);
+
+        for (i = 0; i < nro_senders; i++)
+        {
+            t = new eBmOixSender();
+            t->start(sender + i);
+        }
+
+        for (i = 0; i < nro_senders; i++)
+        {
+            sender[i].join();
+        }
+        while (eatomic_load_int(&bm_oix_received) < total)
+        {
+            os_sleep(1);
+        }
+
+        benchmark_report(text, nro_senders, total, &start);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Object index addressing benchmark.
+
+  The benchmark_oix() function measures how many "@oix_ucnt" addressed messages per second
+  can be sent to other thread and to object in the same thread.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_oix()
+{
+    eThread
+        *t;
+
+    eThreadHandle
+        receiver;
+
+    t = new eBmOixReceiver();
+    t->start(&receiver); /* After this t pointer is useless */
+
+    bm_oix_target = receiver.uniquename();
+    benchmark_oix_round("@oix send to other thread");
+
+    bm_oix_target = OS_NULL;
+    benchmark_oix_round("@oix send within thread");
+
+    receiver.terminate();
+    receiver.join();
+}
@@ -0,0 +1,168 @@
+/**
+
+  @file    eobjects_benchmark_process_ns.cpp
+  @brief   Message throughput trough process name space.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Sender threads send messages to receiver thread by name "//bmreceiver". Number of sender
+  threads is increased from 1 to BM_MAX_SENDERS, to show how sending trough process name space
+  scales when many threads send at the same time.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Maximum number of sender threads and number of messages sent by each sender thread.
+ */
+#define BM_MAX_SENDERS 16
+#define BM_MESSAGES_PER_SENDER 100000
+
+/* Number of messages received by receiver thread.
+ */
+static volatile os_int bm_received;
+
+
+/**
+****************************************************************************************************
+
+  @brief Receiver thread class.
+
+  The receiver thread just counts received messages.
+
+****************************************************************************************************
+*/
+class eBmReceiver : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_RECEIVER;
+    }
+
+    virtual void onmessage(
+        eEnvelope *envelope)
+    {
+        if (*envelope->target()=='\0' && envelope->command() == BMCMD_PING)
+        {
+            eatomic_add_int(&bm_received, 1);
+            return;
+        }
+
+        eThread::onmessage(envelope);
+    }
+
+    virtual void finish()
+    {
+        benchmark_report_pools("receiver", mm_handle->root()->poolstats());
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Sender thread class.
+
+  The sender thread sends BM_MESSAGES_PER_SENDER messages to receiver and exits.
+
+****************************************************************************************************
+*/
+class eBmSender : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_SENDER;
+    }
+
+    virtual void run()
+    {
+        os_int i;
+
+        for (i = 0; i < BM_MESSAGES_PER_SENDER; i++)
+        {
+            message (BMCMD_PING, "//bmreceiver", OS_NULL, OS_NULL,
+                EMSG_NO_REPLIES|EMSG_NO_ERRORS);
+        }
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Process name space throughput benchmark.
+
+  The benchmark_process_ns() function measures how many messages per second can be sent
+  trough process name space with 1, 2, 4 ... BM_MAX_SENDERS sender threads.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_process_ns()
+{
+    eThread
+        *t;
+
+    eThreadHandle
+        receiver,
+        sender[BM_MAX_SENDERS];
+
+    os_timer
+        start;
+
+    os_int
+        nro_senders,
+        total,
+        i;
+
+    /* Create and start receiver thread.
+     */
+    t = new eBmReceiver();
+    t->addname("bmreceiver", ENAME_PROCESS_NS);
+    t->start(&receiver); /* After this t pointer is useless */
+
+    for (nro_senders = 1; nro_senders <= BM_MAX_SENDERS; nro_senders *= 2)
+    {
+        total = nro_senders * BM_MESSAGES_PER_SENDER;
+        eatomic_store_int(&bm_received, 0);
+        os_get_timer(&start);
+
+        /* Start sender threads.
+         */
+        for (i = 0; i < nro_senders; i++)
+        {
+            t = new eBmSender();
+            t->start(sender + i);
+        }
+
+        /* Wait for sender threads to finish and receiver to process all messages.
+         */
+        for (i = 0; i < nro_senders; i++)
+        {
+            sender[i].join();
+        }
+        while (eatomic_load_int(&bm_received) < total)
+        {
+            os_sleep(1);
+        }
+
+        benchmark_report("process NS send", nro_senders, total, &start);
+    }
+
+    /* Wait for receiver thread to terminate.
+     */
+    receiver.terminate();
+    receiver.join();
+}
@@ -0,0 +1,196 @@
+/**
+
+  @file    eobjects_benchmark_property.cpp
+  @brief   Property set and get throughput.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Each worker thread creates an object with one stored property and one simple property, and
+  calls setpropertyl() and propertyl() for both BM_PROPERTY_ROUNDS times. Number of worker
+  threads is increased from 1 to BM_PROPERTY_MAX_THREADS. Property metadata is read from flat
+  property tables without locking, so this should scale with number of threads.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Maximum number of worker threads and number of set/get rounds per thread.
+ */
+#define BM_PROPERTY_MAX_THREADS 8
+#define BM_PROPERTY_ROUNDS 200000
+
+/* Enumeration of eBmPropObject properties.
+ */
+#define BM_PROPP_STORED 2
+#define BM_PROPP_SIMPLE 4
+
+static os_char bm_propp_stored[] = "stored";
+static os_char bm_propp_simple[] = "simple";
+
+
+/**
+****************************************************************************************************
+
+  @brief Object with properties.
+
+  Value of stored property is kept in object's property eSet, simple property in member
+  variable.
+
+****************************************************************************************************
+*/
+class eBmPropObject : public eObject
+{
+public:
+    /* Constructor.
+     */
+    eBmPropObject(
+		eObject *parent = OS_NULL,
+        e_oid id = EOID_ITEM,
+		os_int flags = EOBJ_DEFAULT)
+        : eObject(parent, id, flags)
+    {
+        m_simple = 0;
+    }
+
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_PROP_OBJECT;
+    }
+
+    /* Add properties to class'es property set.
+     */
+    static void setupclass()
+    {
+        const os_int cls = BM_CLASS_ID_PROP_OBJECT;
+
+        os_lock();
+        addpropertyl(cls, BM_PROPP_STORED, bm_propp_stored, EPRO_DEFAULT, "stored", 0);
+        addpropertyl(cls, BM_PROPP_SIMPLE, bm_propp_simple, EPRO_SIMPLE, "simple", 0);
+        propertysetdone(cls);
+        os_unlock();
+    }
+
+    virtual void onpropertychange(
+        os_int propertynr,
+        eVariable *x,
+        os_int flags)
+    {
+        if (propertynr == BM_PROPP_SIMPLE) m_simple = x->getl();
+    }
+
+    virtual eStatus simpleproperty(
+        os_int propertynr,
+        eVariable *x)
+    {
+        if (propertynr != BM_PROPP_SIMPLE) return ESTATUS_NO_SIMPLE_PROPERTY_NR;
+        x->setl(m_simple);
+        return ESTATUS_SUCCESS;
+    }
+
+    /* Simple property value.
+     */
+    os_long m_simple;
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Worker thread class.
+
+  The worker thread sets and gets properties of it's own object and exits.
+
+****************************************************************************************************
+*/
+class eBmPropWorker : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_PROP_WORKER;
+    }
+
+    virtual void run()
+    {
+        eBmPropObject
+            *obj;
+
+        os_long
+            sum;
+
+        os_int
+            i;
+
+        obj = new eBmPropObject(this);
+        sum = 0;
+        for (i = 1; i <= BM_PROPERTY_ROUNDS; i++)
+        {
+            obj->setpropertyl(BM_PROPP_STORED, i);
+            sum += obj->propertyl(BM_PROPP_STORED);
+            obj->setpropertyl(BM_PROPP_SIMPLE, i);
+            sum += obj->propertyl(BM_PROPP_SIMPLE);
+        }
+        if (sum == 0) osal_debug_error("benchmark_property: no values");
+        delete obj;
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Property set/get benchmark.
+
+  The benchmark_property() function measures how many setpropertyl() and propertyl() calls
+  per second can be done with 1, 2, 4 ... BM_PROPERTY_MAX_THREADS threads.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_property()
+{
+    eThread
+        *t;
+
+    eThreadHandle
+        worker[BM_PROPERTY_MAX_THREADS];
+
+    os_timer
+        start;
+
+    os_int
+        nro_threads,
+        i;
+
+    eBmPropObject::setupclass();
+
+    for (nro_threads = 1; nro_threads <= BM_PROPERTY_MAX_THREADS; nro_threads *= 2)
+    {
+        os_get_timer(&start);
+
+        for (i = 0; i < nro_threads; i++)
+        {
+            t = new eBmPropWorker();
+            t->start(worker + i);
+        }
+
+        for (i = 0; i < nro_threads; i++)
+        {
+            worker[i].join();
+        }
+
+        benchmark_report("setpropertyl/propertyl", nro_threads,
+            (os_long)nro_threads * BM_PROPERTY_ROUNDS * 4, &start);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+
+  @file    eobjects_benchmark_scheduler.cpp
+  @brief   Many threads with dedicated operating system threads vs. scheduled threads.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  BM_SCHED_THREADS threads are started and messages are sent to them round robin. This is
+  done first so that each thread has it's own operating system thread, and then so that
+  threads are run by scheduler's BM_SCHED_WORKERS worker threads.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Number of threads, number of messages sent to each thread and number of worker threads.
+ */
+#define BM_SCHED_THREADS 256
+#define BM_SCHED_MESSAGES_PER_THREAD 1000
+#define BM_SCHED_WORKERS 4
+
+/* Number of messages received by all actor threads.
+ */
+static volatile os_int bm_actor_received;
+
+
+/**
+****************************************************************************************************
+
+  @brief Actor thread class.
+
+  The actor thread just counts received messages. It uses default eThread::run(), so it can
+  be scheduled.
+
+****************************************************************************************************
+*/
+class eBmActor : public eThread
+{
+    /* Get class identifier.
+     */
+    virtual os_int classid()
+    {
+        return BM_CLASS_ID_ACTOR;
+    }
+
+    virtual void onmessage(
+        eEnvelope *envelope)
+    {
+        if (*envelope->target()=='\0' && envelope->command() == BMCMD_PING)
+        {
+            eatomic_add_int(&bm_actor_received, 1);
+            return;
+        }
+
+        eThread::onmessage(envelope);
+    }
+};
+
+
+/**
+****************************************************************************************************
+
+  @brief Run message round with many threads.
+
+  The benchmark_scheduler_round() function starts BM_SCHED_THREADS actor threads, sends
+  messages to them, waits until all messages have been processed and terminates the threads.
+
+  @param   text Benchmark name.
+  @param   flags ETHREAD_DEDICATED or ETHREAD_SCHEDULED.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void benchmark_scheduler_round(
+    const os_char *text,
+    os_int flags)
+{
+    eThread
+        *t;
+
+    eThreadHandle
+        actor[BM_SCHED_THREADS];
+
+    os_timer
+        start;
+
+    os_int
+        total,
+        i,
+        j;
+
+    total = BM_SCHED_THREADS * BM_SCHED_MESSAGES_PER_THREAD;
+    eatomic_store_int(&bm_actor_received, 0);
+    os_get_timer(&start);
+
+    for (i = 0; i < BM_SCHED_THREADS; i++)
+    {
+        t = new eBmActor();
+        t->start(actor + i, OS_NULL, flags); /* After this t pointer is useless */
+    }
+
+    for (j = 0; j < BM_SCHED_MESSAGES_PER_THREAD; j++)
+    {
+        for (i = 0; i < BM_SCHED_THREADS; i++)
+        {
+            actor[i].message(BMCMD_PING, actor[i].uniquename(), OS_NULL, OS_NULL,
+                EMSG_NO_REPLIES|EMSG_NO_ERRORS);
+        }
+    }
+
+    while (eatomic_load_int(&bm_actor_received) < total)
+    {
+        os_sleep(1);
+    }
+
+    for (i = 0; i < BM_SCHED_THREADS; i++)
+    {
+        actor[i].terminate();
+    }
+    for (i = 0; i < BM_SCHED_THREADS; i++)
+    {
+        actor[i].join();
+    }
+
+    benchmark_report(text, BM_SCHED_THREADS, total, &start);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Scheduler benchmark.
+
+  The benchmark_scheduler() function measures time to start, message and terminate
+  BM_SCHED_THREADS threads with dedicated operating system threads and with scheduler.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_scheduler()
+{
+    benchmark_scheduler_round("dedicated threads", ETHREAD_DEDICATED);
+
+    escheduler_start(BM_SCHED_WORKERS);
+    benchmark_scheduler_round("scheduled threads", ETHREAD_SCHEDULED);
+    escheduler_stop();
+}
@@ -0,0 +1,199 @@
+/**
+
+  @file    eobjects_benchmark_slab.cpp
+  @brief   Object memory allocation, slab allocator vs. os_malloc().
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    28.12.2016
+
+  Memory for BM_SLAB_BATCH objects of eVariable size is allocated and freed BM_SLAB_ROUNDS
+  times, first with size prefixed os_malloc() as eObject's new operator did without slab
+  allocator, and then with eslab_alloc(). Then eVariable objects are created and deleted,
+  which goes trough eObject's new and delete operators. Finally containers with 
+  BM_SLAB_NRO_CHILDREN child variables are created and deleted, which measures also handle
+  child array allocation. Object rounds use slab allocator only if eobjects library is built
+  with E_SLAB_ALLOCATOR 1, so build it both ways to compare.
+
+  Copyright 2012 Pekka Lehtikoski. This file is part of the eobjects project and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "eobjects/eobjects.h"
+#include "eobjects_benchmark_example.h"
+
+/* Number of objects allocated at once and number of rounds.
+ */
+#define BM_SLAB_BATCH 1000
+#define BM_SLAB_ROUNDS 1000
+
+/* Number of child variables per container.
+ */
+#define BM_SLAB_NRO_CHILDREN 4
+
+/* Allocation method.
+ */
+#define BM_SLAB_OS_MALLOC 0
+#define BM_SLAB_ESLAB 1
+#define BM_SLAB_EVARIABLE 2
+#define BM_SLAB_CHILDREN 3
+
+
+/**
+****************************************************************************************************
+
+  @brief Run one allocation benchmark.
+
+  The benchmark_slab_round() function allocates and frees memory with given method.
+
+  @param   text Benchmark name.
+  @param   method BM_SLAB_OS_MALLOC, BM_SLAB_ESLAB, BM_SLAB_EVARIABLE or BM_SLAB_CHILDREN.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void benchmark_slab_round(
+    const os_char *text,
+    os_int method)
+{
+    static void
+        *buf[BM_SLAB_BATCH];
+
+    os_char
+        *p;
+
+    os_memsz
+        sz;
+
+    os_timer
+        start;
+
+    os_int
+        i,
+        j,
+        k;
+
+    sz = sizeof(eVariable);
+    os_get_timer(&start);
+
+    for (j = 0; j < BM_SLAB_ROUNDS; j++)
+    {
+        for (i = 0; i < BM_SLAB_BATCH; i++)
+        {
+            switch (method)
+            {
+                case BM_SLAB_OS_MALLOC:
+                    p = os_malloc(sz + sizeof(os_memsz), OS_NULL);
+                    *(os_memsz*)p = sz + sizeof(os_memsz);
+                    buf[i] = p + sizeof(os_memsz);
+                    break;
+
+                case BM_SLAB_ESLAB:
+                    buf[i] = eslab_alloc(sz);
+                    break;
+
+                case BM_SLAB_CHILDREN:
+                    buf[i] = new eContainer;
+                    for (k = 0; k < BM_SLAB_NRO_CHILDREN; k++)
+                    {
+                        new eVariable((eContainer*)buf[i]);
+                    }
+                    break;
+
+                default:
+                    buf[i] = new eVariable;
+                    break;
+            }
+        }
+
+        for (i = 0; i < BM_SLAB_BATCH; i++)
+        {
+            switch (method)
+            {
+                case BM_SLAB_OS_MALLOC:
+                    p = (os_char*)buf[i] - sizeof(os_memsz);
+                    os_free(p, *(os_memsz*)p);
+                    break;
+
+                case BM_SLAB_ESLAB:
+                    eslab_free(buf[i]);
+                    break;
+
+                case BM_SLAB_CHILDREN:
+                    delete (eContainer*)buf[i];
+                    break;
+
+                default:
+                    delete (eVariable*)buf[i];
+                    break;
+            }
+        }
+    }
+
+    benchmark_report(text, 1, (os_long)BM_SLAB_ROUNDS * BM_SLAB_BATCH, &start);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Slab allocator benchmark.
+
+  The benchmark_slab() function measures allocations per second with os_malloc(), with slab
+  allocator and by creating eVariable objects, and writes slab allocator counters to console.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void benchmark_slab()
+{
+    eSlabStats
+        stats;
+
+    eVariable
+        v,
+        n;
+
+    os_long
+        allocs,
+        frees,
+        remote_frees;
+
+    os_int
+        i;
+
+    benchmark_slab_round("os_malloc alloc/free", BM_SLAB_OS_MALLOC);
+    benchmark_slab_round("eslab alloc/free", BM_SLAB_ESLAB);
+    benchmark_slab_round("eVariable new/delete", BM_SLAB_EVARIABLE);
+    benchmark_slab_round("eContainer with children new/delete", BM_SLAB_CHILDREN);
+
+    eslab_stats(&stats);
+    allocs = frees = remote_frees = 0;
+    for (i = 0; i < ESLAB_NRO_CLASSES; i++)
+    {
+        allocs += stats.cls[i].allocs;
+        frees += stats.cls[i].frees;
+        remote_frees += stats.cls[i].remote_frees;
+    }
+
+    v.sets("slab: caches=");
+    n.setl(stats.nro_caches);
+    v.appendv(&n);
+    v.appends(", allocs=");
+    n.setl(allocs);
+    v.appendv(&n);
+    v.appends(", frees=");
+    n.setl(frees);
+    v.appendv(&n);
+    v.appends(", remote frees=");
+    n.setl(remote_frees);
+    v.appendv(&n);
+    v.appends(", large allocs=");
+    n.setl(stats.large_allocs);
+    v.appendv(&n);
+    v.appends("\n");
+    osal_console_write(v.gets());
+}